@@ -34,25 +34,24 @@ void setup()
     //radio.setBand(RADIO_BAND_FMWORLD);
     radio.setVolume(1);
     Serial.println("Radio ok");
-    radio.seekUp();
-    //radio.setFrequency(10210);
 } // setup
 
 
 void loop()
 {
-    RADIO_INFO info;
+    RADIO_STATION stations[32];
 
-    if(!radio.seekUp())
+    // scan the whole band within 60 seconds and list the stations found.
+    byte count=radio.scan(stations, 32, 60000);
+    for(byte i=0;i<count;i++)
     {
-        Serial.println("false");
-        return;
+        String strFreq = String(stations[i].freq);
+        String strOutput = "Frequency :"+ strFreq.substring(0, strFreq.length()-2) \
+                + "." + strFreq.substring(strFreq.length()-2)+"MHz RSSI:"+ stations[i].rssi \
+                + (stations[i].stereo ? " stereo" : "") + (stations[i].rdsSync ? " RDS" : "");
+        Serial.println(strOutput);
     }
-    radio.getRadioInfo(&info);
-    String strFreq = String(radio.getFrequency());
-    String strOutput = "Frequency :"+ strFreq.substring(0, strFreq.length()-2) \
-            + "." + strFreq.substring(strFreq.length()-2)+"MHz RSSI:"+ info.rssi;
-    Serial.println(strOutput);
-    delay(2000);
+    Serial.println(String(count) + " stations in " + radio.getScanDuration() + "ms");
+    delay(10000);
 } // loop
 
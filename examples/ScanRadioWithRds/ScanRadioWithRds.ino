@@ -17,8 +17,10 @@ RadioInterfaceI2c radi2c;
 //SI4703   radio(&radi2c, 2, 14);//Nucleo
 SI4703   radio(&radi2c, 3, A4);//protrinket
 RDSParser rdsParse;
+RADIO_STATION stations[32];
+byte stationCount=0;
+byte station=0;
 unsigned long ulStartTime;
-bool bNew=true;
 
 void setup()
 {
@@ -38,35 +40,36 @@ void setup()
     rdsParse.attachServicenNameCallback(printServiceName);
     rdsParse.attachTimeCallback(printTime);
     Serial.println("Radio ok");
-    radio.seekUp();
 
-//    radio.setFrequency(9040);
-    ulStartTime=millis();
+    // find the stations with RDS once, then only listen to those.
+    stationCount=radio.scan(stations, 32, 60000, false, 500);
+    Serial.println(String(stationCount) + " stations in " + radio.getScanDuration() + "ms");
+    ulStartTime=millis()-5000;
 } // setup
 
 
 void loop()
 {
-    RADIO_INFO info;
-
     delay(50);
     radio.checkRDS();
-    if(radio.getRadioInfo(&info) && info.tuned && bNew)
+    if(stationCount && millis()-ulStartTime>=5000)
     {
-        delay(500);
-        radio.getRadioInfo(&info);
-        String strFreq = String(radio.getFrequency());
+        // next station with RDS
+        for(byte i=0;i<stationCount;i++)
+        {
+            station=(station+1)%stationCount;
+            if(stations[station].rdsSync)
+            {
+                break;
+            }
+        }
+        radio.setFrequency(stations[station].freq);
+        radio.clearRDS();
+        String strFreq = String(stations[station].freq);
         String strOutput = "Frequency :"+ strFreq.substring(0, strFreq.length()-2) \
-                + "." + strFreq.substring(strFreq.length()-2)+"MHz RSSI:"+ info.rssi;
+                + "." + strFreq.substring(strFreq.length()-2)+"MHz RSSI:"+ stations[station].rssi;
         Serial.println(strOutput);
-        bNew=false;
-    }
-    if(millis()>ulStartTime+30000)
-    {
-        Serial.println("next channel...");
-        radio.seekUp();
         ulStartTime=millis();
-        bNew=true;
     }
 } // loop
 
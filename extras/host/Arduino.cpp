@@ -0,0 +1,163 @@
+/// \file Arduino.cpp
+/// \brief Minimal Arduino API for building the radio library on a Linux host.
+///
+/// \details
+/// See Arduino.h.
+
+#include "Arduino.h"
+#include <time.h>
+
+HostSerial Serial;
+
+static bool _virtualClock = false;
+static unsigned long long _virtualMicros = 0;
+static void (*_isr[32])(void);
+static int  _isrMode[32];
+static bool _pinDriven[32];
+static bool _pinLevel[32];
+static bool _interruptsOn = true;
+static unsigned long _isrPending;
+static HostClockListener *_listeners[4];
+
+
+static unsigned long long _realMicros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+} // _realMicros()
+
+
+void hostUseVirtualClock(bool enable) {
+    _virtualClock = enable;
+    _virtualMicros = 0;
+} // hostUseVirtualClock()
+
+
+unsigned long micros() {
+    static unsigned long long start = _realMicros();
+    return (unsigned long)(_virtualClock ? _virtualMicros : _realMicros() - start);
+} // micros()
+
+
+unsigned long millis() {
+    return micros() / 1000;
+} // millis()
+
+
+void hostAttachClockListener(HostClockListener *listener) {
+    for (int i = 0; i < 4; i++) {
+        if (!_listeners[i] || _listeners[i] == listener) {
+            _listeners[i] = listener;
+            return;
+        } // if
+    } // for
+} // hostAttachClockListener()
+
+
+/// Find the listener with the earliest event not later than limit.
+static HostClockListener *_nextListener(unsigned long now, unsigned long long limit, unsigned long long *at) {
+    HostClockListener *next = NULL;
+    *at = limit;
+    for (int i = 0; i < 4 && _listeners[i]; i++) {
+        unsigned long t;
+        if (_listeners[i]->nextEvent(&t)) {
+            long ahead = (long)(t - now);
+            unsigned long long eventAt = (unsigned long long)now + (ahead > 0 ? ahead : 0);
+            if (eventAt <= *at) {
+                *at = eventAt;
+                next = _listeners[i];
+            } // if
+        } // if
+    } // for
+    return next;
+} // _nextListener()
+
+
+/// Advance the clock by us microseconds and stop at every event of the listeners.
+static void _advance(unsigned long long us) {
+    if (_virtualClock) {
+        unsigned long long target = _virtualMicros + us;
+        unsigned long long at;
+        HostClockListener *next;
+        while ((next = _nextListener((unsigned long)_virtualMicros, target, &at)) != NULL) {
+            _virtualMicros = at;
+            next->clockEvent();
+        } // while
+        _virtualMicros = target;
+    } else {
+        struct timespec ts = { (time_t)(us / 1000000), (long)(us % 1000000) * 1000 };
+        nanosleep(&ts, NULL);
+        unsigned long now = micros();
+        unsigned long long at;
+        HostClockListener *next;
+        while ((next = _nextListener(now, now, &at)) != NULL)
+            next->clockEvent();
+    } // if
+} // _advance()
+
+
+void delayMicroseconds(unsigned int us) {
+    _advance(us);
+} // delayMicroseconds()
+
+
+void delay(unsigned long ms) {
+    _advance((unsigned long long)ms * 1000);
+} // delay()
+
+
+// ----- GPIO driven by simulated devices -----
+
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+
+/// Pins that are not driven read LOW.
+int  digitalRead(uint8_t pin) { return (pin < 32 && _pinDriven[pin] && _pinLevel[pin]) ? HIGH : LOW; }
+
+int  digitalPinToInterrupt(uint8_t pin) { return pin < 32 ? pin : -1; }
+
+void attachInterrupt(uint8_t num, void (*userFunc)(void), int mode) {
+    if (num < 32) {
+        _isr[num] = userFunc;
+        _isrMode[num] = mode;
+    } // if
+} // attachInterrupt()
+
+void detachInterrupt(uint8_t num) { if (num < 32) _isr[num] = NULL; }
+
+
+/// Interrupts raised while they are disabled run when they are enabled again.
+void noInterrupts() { _interruptsOn = false; }
+
+void interrupts() {
+    _interruptsOn = true;
+    while (_isrPending) {
+        int num = __builtin_ctzl(_isrPending);
+        _isrPending &= ~(1UL << num);
+        if (_isr[num])
+            _isr[num]();
+    } // while
+} // interrupts()
+
+
+/// A pin that was not driven before is treated as pulled up.
+void hostSetPin(uint8_t pin, int level) {
+    if (pin >= 32)
+        return;
+    bool old = _pinDriven[pin] ? _pinLevel[pin] : true;
+    bool high = (level != LOW);
+    _pinDriven[pin] = true;
+    _pinLevel[pin] = high;
+
+    if (!_isr[pin] || old == high)
+        return;
+    int mode = _isrMode[pin];
+    if ((mode == CHANGE) || (mode == FALLING && !high) || (mode == RISING && high)) {
+        if (_interruptsOn)
+            _isr[pin]();
+        else
+            _isrPending |= 1UL << pin;
+    } // if
+} // hostSetPin()
+
+// End.
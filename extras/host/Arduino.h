@@ -0,0 +1,119 @@
+///
+/// \file Arduino.h
+/// \brief Minimal Arduino API for building the radio library on a Linux host.
+///
+/// \details
+/// Only the functions and macros used by the library in src/ are provided.
+/// The clock can run in real time or as a virtual clock that is only advanced by delay(),
+/// the latter is used by the simulated chips to run tune and seek timing faster than real time.
+/// Input pins can be driven by a simulated device with hostSetPin(), which runs the attached interrupt routines.
+///
+/// Build a host program by adding this directory and src/ to the include path, e.g.
+///   g++ -O2 -Iextras/host -Isrc extras/host/*.cpp src/*.cpp yourprogram.cpp
+
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint8_t byte;
+typedef uint16_t word;
+typedef bool boolean;
+
+#define HEX 16
+#define DEC 10
+
+#define LOW  0
+#define HIGH 1
+
+#define INPUT        0
+#define OUTPUT       1
+#define INPUT_PULLUP 2
+
+#define CHANGE  1
+#define FALLING 2
+#define RISING  3
+
+#define A4 18
+#define A5 19
+
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+#define bit(b) (1UL << (b))
+#define lowByte(w) ((uint8_t) ((w) & 0xff))
+#define highByte(w) ((uint8_t) ((w) >> 8))
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int  digitalRead(uint8_t pin);
+
+int  digitalPinToInterrupt(uint8_t pin);
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode);
+void detachInterrupt(uint8_t interruptNum);
+void noInterrupts();
+void interrupts();
+
+/// Switch between the real time clock (default) and a virtual clock that only advances in delay().
+void hostUseVirtualClock(bool enable);
+
+/// Drive an input pin from a simulated device.
+/// An interrupt routine attached to the pin runs when the level change matches its mode.
+void hostSetPin(uint8_t pin, int level);
+
+/// A simulated device that has to act at a given time, e.g. to drive an interrupt line.
+/// The virtual clock stops at every event, the real time clock handles due events in delay().
+class HostClockListener {
+public:
+    virtual bool nextEvent(unsigned long *at) = 0; ///< micros() of the next event, false when there is none.
+    virtual void clockEvent() = 0;                 ///< Called when the time of the event is reached.
+};
+
+void hostAttachClockListener(HostClockListener *listener); ///< Register a device, up to 4.
+
+/// Serial port printing to stdout.
+/// setOutput(NULL) silences the debug output of the library.
+class HostSerial {
+public:
+    HostSerial() : _out(stdout) {}
+    void setOutput(FILE *out) { _out = out; }
+
+    void begin(unsigned long) {}
+    int  available() { return 0; }
+    int  read() { return -1; }
+    operator bool() { return true; }
+
+    void print(const char *s)                  { if (_out) fputs(s, _out); }
+    void print(char c)                         { if (_out) fputc(c, _out); }
+    void print(unsigned long n, int base = DEC) { if (_out) fprintf(_out, base == HEX ? "%lX" : "%lu", n); }
+    void print(long n, int base = DEC)         { if (base == HEX) print((unsigned long)n, base); else if (_out) fprintf(_out, "%ld", n); }
+    void print(unsigned int n, int base = DEC) { print((unsigned long)n, base); }
+    void print(int n, int base = DEC)          { print((long)n, base); }
+    void print(unsigned char n, int base = DEC) { print((unsigned long)n, base); }
+    void print(double d)                       { if (_out) fprintf(_out, "%.2f", d); }
+
+    void println()                             { print('\n'); }
+    template <typename T> void println(T v)    { print(v); println(); }
+    template <typename T> void println(T v, int base) { print(v, base); println(); }
+
+private:
+    FILE *_out;
+};
+
+extern HostSerial Serial;
+
+// End.
@@ -0,0 +1,127 @@
+///
+/// \file hostdsp.h
+/// \brief Signal processing kernels of the host tools.
+///
+/// \details
+/// The kernels use GCC vector extensions of 4 floats, so they run on SSE, AVX or NEON
+/// and fall back to scalar code elsewhere.
+/// Samples are kept in separate arrays for I and Q, the arrays passed to dspDot2()
+/// need 8 readable floats behind the end, see dspFloats().
+
+#pragma once
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef float v4sf __attribute__((vector_size(16)));
+typedef int v4si __attribute__((vector_size(16)));
+
+
+/// Allocate zeroed floats, padded for the 8 wide loads behind the end.
+inline float *dspFloats(int count)
+{
+    return ((float *)calloc(count + 8, sizeof(float)));
+} // dspFloats()
+
+
+/// Dot product of the taps with the samples of I and Q, n is a multiple of 8.
+inline void dspDot2(const float *taps, const float *sampleI, const float *sampleQ, int n, float *resultI, float *resultQ)
+{
+    v4sf i0 = { 0, 0, 0, 0 }, i1 = i0, q0 = i0, q1 = i0;
+
+    for (int k = 0; k < n; k += 8) {
+        v4sf t0, t1, a0, a1, b0, b1;
+        memcpy(&t0, taps + k, sizeof(v4sf));
+        memcpy(&t1, taps + k + 4, sizeof(v4sf));
+        memcpy(&a0, sampleI + k, sizeof(v4sf));
+        memcpy(&a1, sampleI + k + 4, sizeof(v4sf));
+        memcpy(&b0, sampleQ + k, sizeof(v4sf));
+        memcpy(&b1, sampleQ + k + 4, sizeof(v4sf));
+        i0 += t0 * a0;
+        i1 += t1 * a1;
+        q0 += t0 * b0;
+        q1 += t1 * b1;
+    }
+    i0 += i1;
+    q0 += q1;
+    *resultI = i0[0] + i0[1] + i0[2] + i0[3];
+    *resultQ = q0[0] + q0[1] + q0[2] + q0[3];
+} // dspDot2()
+
+
+/// Oscillator table of length + extra samples of exp(j 2 pi freq n / rate).
+/// The table repeats after length samples, extra samples let loops run over the end without a wrap.
+/// Returns the length, freq is rounded to a multiple of rate / length when the exact period exceeds maxLength.
+inline int dspOscillator(double freq, unsigned long rate, int maxLength, int extra, float **cosTable, float **sinTable)
+{
+    long f = lround(freq);
+    unsigned long a = rate, b = (unsigned long)labs(f);
+    while (b) {
+        unsigned long r = a % b;
+        a = b;
+        b = r;
+    }
+    int length = (int)(rate / a);
+    double cycles = (double)f * length / rate;
+    if (length > maxLength) {
+        length = maxLength;
+        cycles = round(freq * length / rate);
+    }
+    *cosTable = dspFloats(length + extra);
+    *sinTable = dspFloats(length + extra);
+    for (int n = 0; n < length + extra; n++) {
+        double phase = 2 * M_PI * fmod(cycles * (n % length), (double)length) / length;
+        (*cosTable)[n] = (float)cos(phase);
+        (*sinTable)[n] = (float)sin(phase);
+    }
+    return (length);
+} // dspOscillator()
+
+
+/// Phase of 4 complex values, the error is below 1e-5 rad.
+inline v4sf dspAtan2(v4sf y, v4sf x)
+{
+    const v4si absMask = { 0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF };
+    const v4sf zero = { 0, 0, 0, 0 };
+    const v4sf tiny = { 1e-30f, 1e-30f, 1e-30f, 1e-30f };
+    const v4sf halfPi = { (float)M_PI_2, (float)M_PI_2, (float)M_PI_2, (float)M_PI_2 };
+    const v4sf pi = { (float)M_PI, (float)M_PI, (float)M_PI, (float)M_PI };
+
+    v4sf ax = (v4sf)((v4si)x & absMask);
+    v4sf ay = (v4sf)((v4si)y & absMask);
+    v4si steep = ay > ax;
+    v4sf mx = steep ? ay : ax;
+    v4sf mn = steep ? ax : ay;
+    v4sf a = mn / (mx + tiny);
+    v4sf s = a * a;
+    v4sf r = (((-0.0464964749f * s + 0.15931422f) * s - 0.327622764f) * s) * a + a;
+    r = steep ? halfPi - r : r;
+    r = (x < zero) ? pi - r : r;
+    r = (y < zero) ? -r : r;
+    return (r);
+} // dspAtan2()
+
+
+/// FM discriminator: phase difference of consecutive samples times gain.
+/// last holds the sample before i[0], q[0] and is updated, n is a multiple of 4.
+inline void dspDiscriminate(const float *i, const float *q, int n, float *lastI, float *lastQ, float gain, float *out)
+{
+    float pi0 = *lastI, pq0 = *lastQ;
+
+    for (int k = 0; k < n; k += 4) {
+        v4sf ci, cq, pi, pq;
+        memcpy(&ci, i + k, sizeof(v4sf));
+        memcpy(&cq, q + k, sizeof(v4sf));
+        pi = (v4sf){ pi0, ci[0], ci[1], ci[2] };
+        pq = (v4sf){ pq0, cq[0], cq[1], cq[2] };
+        v4sf re = ci * pi + cq * pq;
+        v4sf im = cq * pi - ci * pq;
+        v4sf d = dspAtan2(im, re) * gain;
+        memcpy(out + k, &d, sizeof(v4sf));
+        pi0 = ci[3];
+        pq0 = cq[3];
+    }
+    *lastI = pi0;
+    *lastQ = pq0;
+} // dspDiscriminate()
@@ -0,0 +1,90 @@
+/// \file i2cradio.cpp
+/// \brief Run a RDA5807M on the Linux i2c-dev driver, e.g. on a Raspberry Pi.
+///
+/// \details
+/// Build and run on a Linux host:
+///   g++ -O2 -Iextras/host -Isrc extras/host/Arduino.cpp extras/host/radiointerfacelinuxi2c.cpp extras/host/i2cradio.cpp src/*.cpp -o i2cradio
+///   ./i2cradio [-d /dev/i2c-1] [frequency in 10 kHz units]
+/// The setup writes of RDA5807M::init() are a RadioTransaction, RadioInterfaceLinuxI2c sends them
+/// with the first tune as one I2C_RDWR ioctl.
+/// The station is received for 10 s, the RSSI and the PS name and RadioText are printed when they change.
+/// The SI4703 needs GPIO pins for its reset and is not supported here.
+
+#include "Arduino.h"
+#include "radiointerfacelinuxi2c.h"
+#include "RDA5807M.h"
+#include "RDSParser.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static RDSParser rds;
+static unsigned long start;
+
+
+static void onPS(const char *name)
+{
+    printf("  %5lu ms PS '%s'\n", millis() - start, name);
+}
+
+
+static void onText(const char *text)
+{
+    printf("  %5lu ms RT '%s'\n", millis() - start, text);
+}
+
+
+static void onRDS(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4)
+{
+    rds.processData(block1, block2, block3, block4);
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char *device = "/dev/i2c-1";
+    RADIO_FREQ freq = 8930;
+    int i;
+
+    Serial.setOutput(NULL);
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-d") && (i + 1 < argc))
+            device = argv[++i];
+        else
+            freq = (RADIO_FREQ)atoi(argv[i]);
+    } // for
+
+    RadioInterfaceLinuxI2c i2c(device);
+    RDA5807M radio(&i2c);
+
+    i2c.init();
+    if (!i2c.isDetected(0x10)) {
+        fprintf(stderr, "no RDA5807M on %s\n", device);
+        return 1;
+    }
+    if (!radio.init()) {
+        fprintf(stderr, "init of the RDA5807M failed\n");
+        return 1;
+    }
+    rds.attachServicenNameCallback(onPS);
+    rds.attachTextCallback(onText);
+    radio.attachReceiveRDS(onRDS);
+    start = millis();
+    if (!radio.setFrequency(freq)) {
+        fprintf(stderr, "tuning to %u failed\n", freq);
+        return 1;
+    }
+
+    byte rssi = 0xFF;
+    printf("%s: RDA5807M tuned to %u\n", device, radio.getFrequency());
+    while (millis() - start < 10000) {
+        RADIO_INFO info;
+        radio.checkRDS();
+        if (radio.getRadioInfo(&info) && (info.rssi != rssi)) {
+            rssi = info.rssi;
+            printf("  %5lu ms RSSI %u%s%s\n", millis() - start, rssi, info.stereo ? " stereo" : "", info.rds ? " RDS" : "");
+        }
+        delay(40);
+    } // while
+    return 0;
+} // main()
@@ -0,0 +1,445 @@
+/// \file mpxrds.cpp
+/// \brief Decode RDS from recorded FM multiplex signals and test the demodulator on synthesized ones.
+///
+/// \details
+/// Build and run on a Linux host:
+///   g++ -O2 -Iextras/host -Isrc extras/host/Arduino.cpp extras/host/radiosimulator.cpp extras/host/rdsdemod.cpp extras/host/mpxsynth.cpp extras/host/mpxrds.cpp src/*.cpp -o mpxrds
+///   ./mpxrds [-g] [-c] recording.wav
+///   ./mpxrds -r 228000 -f s16 [-g] [-c] recording.raw
+///   ./mpxrds -t
+///   ./mpxrds -w test.wav
+/// The recording is the MPX signal after the FM discriminator, 192 kHz or more,
+/// as 16 bit or float WAV file or as raw 16 bit or float samples, the first channel is used.
+/// The PS, the RadioText and the block error statistics are printed, -g prints every group with its error levels.
+/// -c replays the decoded groups with the SI4703 driver on the simulated chip,
+/// like a chip receiving the recorded station.
+/// -t synthesizes MPX with stereo audio, pilot, RDS and noise at 192 kHz and 228 kHz,
+/// and reports the decoded groups, undetected errors and the speed as a multiple of real time.
+/// -w writes 30 s of the synthesized signal at 228 kHz with noise as WAV file.
+
+#include "radiosimulator.h"
+#include "rdsdemod.h"
+#include "mpxsynth.h"
+#include "SI4703.h"
+#include "RDSParser.h"
+#include "RDSBlockFilter.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static RDSParser rds;
+static RDSBlockFilter rdsFilter;
+static bool printGroups = false;
+static double groupTime;
+
+// ----- decoding a recording -----
+
+/// Print the groups of the demodulator and pass them through the block filter to the parser.
+class GroupPrinter : public RDSGroupReceiver
+{
+public:
+    RDSDemodulator *demod;
+
+    void receiveGroup(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4, byte errors)
+    {
+        groupTime = demod->getTime();
+        if (printGroups)
+            printf("%9.3f %04X %04X %04X %04X %u%u%u%u\n", groupTime, block1, block2, block3, block4,
+                   errors >> 6, (errors >> 4) & 3, (errors >> 2) & 3, errors & 3);
+        if (rdsFilter.filter(&block1, &block2, &block3, &block4, errors))
+            rds.processData(block1, block2, block3, block4);
+    }
+};
+
+/// Forward the groups to more receivers.
+class GroupSplitter : public RDSGroupReceiver
+{
+public:
+    RDSGroupReceiver *first, *second;
+
+    void receiveGroup(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4, byte errors)
+    {
+        first->receiveGroup(block1, block2, block3, block4, errors);
+        second->receiveGroup(block1, block2, block3, block4, errors);
+    }
+};
+
+static void printServiceName(const char *name)
+{
+    if (name[0] != ' ')
+        printf("%9.3f PS '%s'\n", groupTime, name);
+}
+
+static void printText(const char *text)
+{
+    if (text[0])
+        printf("%9.3f RT '%s'\n", groupTime, text);
+}
+
+static void printTime(unsigned long utcSeconds, char halfHoursOffset)
+{
+    printf("%9.3f CT %lu UTC %+d min\n", groupTime, utcSeconds, halfHoursOffset * 30);
+}
+
+
+/// Read little endian values of a WAV header.
+static unsigned long _le(const byte *p, int len)
+{
+    unsigned long v = 0;
+    while (len--)
+        v = (v << 8) | p[len];
+    return (v);
+}
+
+
+/// Sample formats of the input.
+enum SAMPLE_FORMAT { FORMAT_S16, FORMAT_F32 };
+
+/// Read the header of a WAV file up to the data.
+static bool readWavHeader(FILE *f, unsigned long *rate, SAMPLE_FORMAT *format, int *channels)
+{
+    byte h[12];
+    if ((fread(h, 1, 12, f) != 12) || memcmp(h, "RIFF", 4) || memcmp(h + 8, "WAVE", 4))
+        return (false);
+
+    bool fmt = false;
+    for (;;) {
+        byte c[8];
+        if (fread(c, 1, 8, f) != 8)
+            return (false);
+        unsigned long len = _le(c + 4, 4);
+        if (!memcmp(c, "data", 4))
+            return (fmt);
+        if (!memcmp(c, "fmt ", 4) && (len >= 16) && (len <= 64)) {
+            byte b[64];
+            if (fread(b, 1, len, f) != len)
+                return (false);
+            unsigned long tag = _le(b, 2);
+            if ((tag == 0xFFFE) && (len >= 26))
+                tag = _le(b + 24, 2); // WAVE_FORMAT_EXTENSIBLE, the sub format
+            *channels = _le(b + 2, 2);
+            *rate = _le(b + 4, 4);
+            unsigned long bits = _le(b + 14, 2);
+            if ((tag == 1) && (bits == 16))
+                *format = FORMAT_S16;
+            else if ((tag == 3) && (bits == 32))
+                *format = FORMAT_F32;
+            else
+                return (false);
+            fmt = true;
+            if (len & 1)
+                fgetc(f);
+        } else {
+            fseek(f, len + (len & 1), SEEK_CUR);
+        }
+    }
+} // readWavHeader()
+
+
+static void processRDS(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4)
+{
+    rds.processData(block1, block2, block3, block4);
+}
+
+
+/// Run the SI4703 driver on the simulated chip receiving the decoded groups.
+static void replay(RDSRecordedStation &recorded)
+{
+    static SimSI4703 sim;
+    static SI4703 radio(&sim, 2, A4);
+    SIM_STATION station;
+
+    if (!recorded.getCount()) {
+        printf("SI4703 replay: no groups\n");
+        return;
+    }
+    recorded.getStation(&station, 8930, 40, true);
+    sim.setStations(&station, 1);
+    hostUseVirtualClock(true);
+    Serial.setOutput(NULL);
+    radio.init();
+    rds.attachServicenNameCallback(NULL);
+    rds.attachTextCallback(NULL);
+    rds.init();
+    rds.attachServicenNameCallback(printServiceName);
+    rds.attachTextCallback(printText);
+    rdsFilter.reset();
+    rdsFilter.resetStatistics();
+    radio.attachReceiveRDS(processRDS);
+    radio.attachRDSFilter(&rdsFilter);
+    radio.setFrequency(8930);
+    radio.clearRDS();
+
+    unsigned long start = millis();
+    unsigned long duration = (unsigned long)station.rdsCount * RadioSimulator::RDS_GROUP_TIME / 1000;
+    while (millis() - start < duration) {
+        groupTime = (millis() - start) / 1000.0;
+        radio.checkRDS();
+        delay(1);
+    }
+    printf("SI4703 replay of %u groups: delivered %lu, filter dropped %lu\n", station.rdsCount,
+           sim.rdsGroupsRead(), rdsFilter.getDropCount());
+    radio.attachRDSFilter(NULL);
+    radio.attachReceiveRDS(NULL);
+} // replay()
+
+
+/// Decode a recording.
+static int decodeFile(const char *name, unsigned long rate, SAMPLE_FORMAT format, bool chip)
+{
+    FILE *f = fopen(name, "rb");
+    int channels = 1;
+
+    if (!f) {
+        perror(name);
+        return (1);
+    }
+    if (!rate && !readWavHeader(f, &rate, &format, &channels)) {
+        fprintf(stderr, "%s: not a 16 bit or float WAV file, use -r and -f for raw samples\n", name);
+        fclose(f);
+        return (1);
+    }
+    if (rate < 120000) {
+        fprintf(stderr, "%s: %lu Hz is too low for the 57 kHz subcarrier\n", name, rate);
+        fclose(f);
+        return (1);
+    }
+
+    RDSDemodulator demod(rate);
+    GroupPrinter printer;
+    RDSRecordedStation recorded;
+    GroupSplitter splitter;
+    printer.demod = &demod;
+    splitter.first = &printer;
+    splitter.second = &recorded;
+    demod.attachReceiver(&splitter);
+    rds.attachServicenNameCallback(printServiceName);
+    rds.attachTextCallback(printText);
+    rds.attachTimeCallback(printTime);
+
+    const int FRAMES = 16384;
+    int size = (format == FORMAT_S16) ? 2 : 4;
+    std::vector<byte> raw(FRAMES * channels * size);
+    std::vector<float> mpx(FRAMES);
+    size_t frames;
+    auto t0 = std::chrono::steady_clock::now();
+    while ((frames = fread(&raw[0], channels * size, FRAMES, f)) > 0) {
+        for (size_t n = 0; n < frames; n++) {
+            const byte *p = &raw[n * channels * size];
+            if (format == FORMAT_S16)
+                mpx[n] = (int16_t)_le(p, 2) / 32768.0f;
+            else
+                memcpy(&mpx[n], p, 4);
+        }
+        demod.process(&mpx[0], frames);
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    fclose(f);
+
+    printf("%.1f s at %lu Hz decoded in %.2f s, %.0f times real time\n", demod.getTime(), rate, elapsed,
+           demod.getTime() / elapsed);
+    printf("blocks %lu, corrected %lu, not correctable %lu, groups %lu, syncs %lu\n", demod.getBlocks(),
+           demod.getCorrected(), demod.getUncorrectable(), demod.getGroups(), demod.getSyncs());
+    Serial.setOutput(stdout);
+    rdsFilter.dump();
+
+    if (chip) {
+        printGroups = false;
+        rds.attachTimeCallback(NULL);
+        replay(recorded);
+    }
+    return (0);
+} // decodeFile()
+
+
+// ----- self test on synthesized MPX -----
+
+// PS "MPX TEST" in 4 groups 0A, the RadioText "Synthesized multiplex signal\r" in 8 groups 2A
+// and one group 0B with C' to check the version B offset.
+static const uint16_t testGroups[] = {
+    0xD3C2, 0x0408, 0xE309, 0x4D50,
+    0xD3C2, 0x2400, 0x5379, 0x6E74,
+    0xD3C2, 0x0409, 0x1D92, 0x5820,
+    0xD3C2, 0x2401, 0x6865, 0x7369,
+    0xD3C2, 0x040A, 0xE309, 0x5445,
+    0xD3C2, 0x2402, 0x7A65, 0x6420,
+    0xD3C2, 0x040B, 0x1D92, 0x5354,
+    0xD3C2, 0x2403, 0x6D75, 0x6C74,
+    0xD3C2, 0x2404, 0x6970, 0x6C65,
+    0xD3C2, 0x2405, 0x7820, 0x7369,
+    0xD3C2, 0x0C08, 0xD3C2, 0x4D50,
+    0xD3C2, 0x2406, 0x676E, 0x616C,
+    0xD3C2, 0x2407, 0x0D00, 0x0000
+};
+static const int TEST_COUNT = sizeof(testGroups) / sizeof(testGroups[0]) / 4;
+
+/// A channel of the self test.
+struct TEST_CASE {
+    unsigned long rate;
+    double noise;   ///< RMS of the white noise added to the MPX signal.
+    double ppm;     ///< Error of the sample clock in the recording.
+};
+
+static const TEST_CASE testCases[] = {
+    { 228000, 0.0,   0 },
+    { 228000, 0.02, 40 },
+    { 228000, 0.04, 40 },
+    { 228000, 0.06, 40 },
+    { 228000, 0.08, 40 },
+    { 192000, 0.0,   0 },
+    { 192000, 0.02, -80 },
+    { 192000, 0.04, -80 },
+    { 192000, 0.06, -80 },
+    { 192000, 0.08, -80 }
+};
+
+static const double RDS_LEVEL = 0.04;  ///< Deviation of the RDS subcarrier, the pilot has 0.09.
+
+
+/// Synthesize an MPX signal of the test groups.
+static void synthesize(std::vector<float> &mpx, const TEST_CASE &tc, double seconds)
+{
+    MpxSynthesizer synth(tc.rate);
+    synth.setGroups(testGroups, TEST_COUNT);
+    synth.setLevels(0.4f, 0.09f, RDS_LEVEL);
+    synth.setNoise(tc.noise, 88172645463325252UL);
+    synth.setClockError(tc.ppm);
+    mpx.resize((size_t)(seconds * tc.rate));
+    synth.generate(&mpx[0], mpx.size());
+} // synthesize()
+
+
+/// Count the decoded groups that match the sent stream.
+class GroupChecker : public RDSGroupReceiver
+{
+public:
+    unsigned long groups, clean, usable, wrong;
+
+    GroupChecker() : groups(0), clean(0), usable(0), wrong(0) {}
+
+    void receiveGroup(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4, byte errors)
+    {
+        groups++;
+        bool found = false;
+        for (int i = 0; i < TEST_COUNT; i++) {
+            const uint16_t *g = &testGroups[i * 4];
+            found |= (g[0] == block1) && (g[1] == block2) && (g[2] == block3) && (g[3] == block4);
+        }
+        bool levelOk = ((errors >> 6) <= 1) && (((errors >> 4) & 3) <= 1) && (((errors >> 2) & 3) <= 1) && ((errors & 3) <= 1);
+        if (!errors)
+            clean++;
+        if (levelOk && found)
+            usable++;
+        if (levelOk && !found)
+            wrong++;
+    }
+};
+
+
+/// Write the synthesized signal of a test case as 16 bit WAV file.
+static int writeTestFile(const char *name, const TEST_CASE &tc, double seconds)
+{
+    std::vector<float> mpx;
+    synthesize(mpx, tc, seconds);
+
+    FILE *f = fopen(name, "wb");
+    if (!f) {
+        perror(name);
+        return (1);
+    }
+    unsigned long bytes = mpx.size() * 2;
+    byte h[44];
+    memcpy(h, "RIFF\0\0\0\0WAVEfmt \x10\0\0\0\x01\0\x01\0\0\0\0\0\0\0\0\0\x02\0\x10\0data", 40);
+    for (int i = 0; i < 4; i++) {
+        h[4 + i] = (byte)((bytes + 36) >> (8 * i));
+        h[24 + i] = (byte)(tc.rate >> (8 * i));
+        h[28 + i] = (byte)((tc.rate * 2) >> (8 * i));
+        h[40 + i] = (byte)(bytes >> (8 * i));
+    }
+    fwrite(h, 1, 44, f);
+    for (size_t n = 0; n < mpx.size(); n++) {
+        int v = lround(mpx[n] * 32767);
+        int16_t sample = (v > 32767) ? 32767 : (v < -32768) ? -32768 : v;
+        fputc(sample & 0xFF, f);
+        fputc((sample >> 8) & 0xFF, f);
+    }
+    fclose(f);
+    printf("%s: %.0f s at %lu Hz, noise %.2f, %+.0f ppm\n", name, seconds, tc.rate, tc.noise, tc.ppm);
+    return (0);
+} // writeTestFile()
+
+
+/// Decode synthesized signals and report the groups and the speed.
+static int selfTest()
+{
+    const double SECONDS = 60;
+    RDSRecordedStation recorded;
+
+    printf("rate   noise C/N dB  ppm   sent decoded  clean usable wrong syncs  speed\n");
+    for (size_t c = 0; c < sizeof(testCases) / sizeof(testCases[0]); c++) {
+        const TEST_CASE &tc = testCases[c];
+        std::vector<float> mpx;
+        synthesize(mpx, tc, SECONDS);
+
+        RDSDemodulator demod(tc.rate);
+        GroupChecker checker;
+        demod.attachReceiver((c == 0) ? (RDSGroupReceiver *)&recorded : &checker);
+        auto t0 = std::chrono::steady_clock::now();
+        demod.process(&mpx[0], mpx.size());
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        if (c == 0) {
+            // The same signal again for the counters, the first run feeds the replay.
+            RDSDemodulator again(tc.rate);
+            again.attachReceiver(&checker);
+            again.process(&mpx[0], mpx.size());
+        }
+
+        // Carrier to noise in the 4.75 kHz wide RDS band, the biphase signal has about 1/4 of its peak power.
+        double cn = (tc.noise > 0) ? 10 * log10(RDS_LEVEL * RDS_LEVEL / 8 / (tc.noise * tc.noise * 4750 / (tc.rate / 2))) : 99;
+        unsigned long sent = (unsigned long)(SECONDS * 1187.5 / 104);
+        printf("%6lu %5.2f %6.1f %4.0f %6lu %7lu %6lu %6lu %5lu %5lu %5.0fx\n", tc.rate, tc.noise, cn, tc.ppm,
+               sent, checker.groups, checker.clean, checker.usable, checker.wrong, demod.getSyncs(), SECONDS / elapsed);
+    }
+    replay(recorded);
+    return (0);
+} // selfTest()
+
+
+int main(int argc, char *argv[])
+{
+    unsigned long rate = 0;
+    SAMPLE_FORMAT format = FORMAT_S16;
+    bool chip = false;
+    int i;
+
+    for (i = 1; (i < argc) && (argv[i][0] == '-'); i++) {
+        if (!strcmp(argv[i], "-t")) {
+            return (selfTest());
+        } else if (!strcmp(argv[i], "-w") && (i + 1 < argc)) {
+            return (writeTestFile(argv[i + 1], testCases[2], 30));
+        } else if (!strcmp(argv[i], "-g")) {
+            printGroups = true;
+        } else if (!strcmp(argv[i], "-c")) {
+            chip = true;
+        } else if (!strcmp(argv[i], "-r") && (i + 1 < argc)) {
+            rate = strtoul(argv[++i], NULL, 10);
+        } else if (!strcmp(argv[i], "-f") && (i + 1 < argc)) {
+            i++;
+            if (!strcmp(argv[i], "s16"))
+                format = FORMAT_S16;
+            else if (!strcmp(argv[i], "f32"))
+                format = FORMAT_F32;
+            else
+                break;
+        } else {
+            break;
+        }
+    }
+    if (i != argc - 1) {
+        fprintf(stderr, "usage: mpxrds [-g] [-c] [-r rate -f s16|f32] file | mpxrds -t | mpxrds -w file.wav\n");
+        return (2);
+    }
+    return (decodeFile(argv[i], rate, format, chip));
+} // main()
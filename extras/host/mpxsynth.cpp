@@ -0,0 +1,132 @@
+///
+/// \file mpxsynth.cpp
+/// \brief Implementation of the MPX synthesizer.
+
+#include "mpxsynth.h"
+#include "rdsdemod.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+static const double RDS_BITTIME = 1.0 / 1187.5;
+
+
+MpxSynthesizer::MpxSynthesizer(unsigned long rate)
+{
+    _rate = rate;
+    _groups = NULL;
+    _groupCount = 0;
+    _audio = 0.4f;
+    _pilot = 0.09f;
+    _rds = 0.04f;
+    _noise = 0;
+    _scale = 1;
+    _seed = 1;
+    _sample = 0;
+    _symbolCount = 0;
+    _level = 0;
+
+    // Biphase symbol over 2.5 bits each side with a Hann window.
+    _half = (int)(2.5 * RDS_BITTIME * rate * OVERSAMPLE);
+    _pulse = (float *)malloc((2 * _half + 1) * sizeof(float));
+    _peak = 0;
+    for (int j = -_half; j <= _half; j++) {
+        double t = (double)j / OVERSAMPLE / rate;
+        double w = 0.5 + 0.5 * cos(M_PI * j / _half);
+        _pulse[j + _half] = (float)((rdsShapingPulse(t + RDS_BITTIME / 4) - rdsShapingPulse(t - RDS_BITTIME / 4)) * w);
+        _peak = fmaxf(_peak, fabsf(_pulse[j + _half]));
+    }
+} // MpxSynthesizer()
+
+
+MpxSynthesizer::~MpxSynthesizer()
+{
+    free(_pulse);
+} // ~MpxSynthesizer()
+
+
+void MpxSynthesizer::setGroups(const uint16_t *groups, int count)
+{
+    _groups = groups;
+    _groupCount = groups ? count : 0;
+} // setGroups()
+
+
+void MpxSynthesizer::setLevels(float audio, float pilot, float rds)
+{
+    _audio = audio;
+    _pilot = pilot;
+    _rds = rds;
+} // setLevels()
+
+
+void MpxSynthesizer::setNoise(float rms, unsigned long seed)
+{
+    _noise = rms;
+    _seed = seed ? seed : 1;
+} // setNoise()
+
+
+void MpxSynthesizer::setClockError(double ppm)
+{
+    _scale = 1.0 + ppm * 1e-6;
+} // setClockError()
+
+
+signed char MpxSynthesizer::_symbol(unsigned long k)
+{
+    while (_symbolCount <= k) {
+        unsigned long b = _symbolCount;
+        unsigned long block = b / 26;
+        const uint16_t *g = &_groups[(block / 4 % _groupCount) * 4];
+        int type = block % 4;
+        byte offset = ((type == 2) && (g[1] & 0x0800)) ? RDS_OFFSET_CB : (type == 3) ? RDS_OFFSET_D : type;
+        uint32_t word = ((uint32_t)g[type] << 10) | rdsCheckword(g[type], offset);
+        _level ^= (word >> (25 - b % 26)) & 1;
+        _symbols[b % SYMBOLS] = _level ? 1 : -1;
+        _symbolCount++;
+    }
+    return (_symbols[k % SYMBOLS]);
+} // _symbol()
+
+
+void MpxSynthesizer::generate(float *mpx, size_t count)
+{
+    double bitTime = RDS_BITTIME / _scale;
+
+    for (size_t n = 0; n < count; n++, _sample++) {
+        double t = (double)_sample / _rate;
+        double ts = t * _scale;
+        double pilot = 2 * M_PI * fmod(19000 * ts, 1.0);
+        double rds = 0;
+
+        if (_groupCount) {
+            long first = (long)(t / bitTime - 2.5);
+            for (long k = (first < 0) ? 0 : first; k <= first + 5; k++) {
+                long j = lround((t - (k + 0.5) * bitTime) * _rate * OVERSAMPLE);
+                if ((j >= -_half) && (j <= _half))
+                    rds += _symbol(k) * _pulse[j + _half];
+            }
+        }
+
+        double noise = 0;
+        if (_noise > 0) {
+            // Box-Muller on a xorshift sequence.
+            double u[2];
+            for (int r = 0; r < 2; r++) {
+                _seed ^= _seed << 13;
+                _seed ^= _seed >> 7;
+                _seed ^= _seed << 17;
+                u[r] = ((_seed >> 11) & 0xFFFFFFFFFFFFFUL) * (1.0 / 4503599627370496.0);
+            }
+            noise = _noise * sqrt(-2 * log(u[0] + 1e-300)) * cos(2 * M_PI * u[1]);
+        }
+
+        double stereo = (_pilot > 0) ? sin(2 * M_PI * fmod(3500 * ts, 1.0)) * sin(2 * pilot) : 0;
+        mpx[n] = (float)(_audio * sin(2 * M_PI * fmod(1000 * ts, 1.0))
+                         + _audio * stereo
+                         + _pilot * sin(pilot)
+                         + _rds / _peak * rds * sin(3 * pilot)
+                         + noise);
+    }
+} // generate()
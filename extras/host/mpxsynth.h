@@ -0,0 +1,50 @@
+///
+/// \file mpxsynth.h
+/// \brief Synthesized FM multiplex signals for testing the demodulators on a Linux host.
+///
+/// \details
+/// The signal has a mono tone at 1 kHz, a stereo difference tone at 3.5 kHz on 38 kHz,
+/// the 19 kHz pilot and RDS with a cyclic stream of groups on 57 kHz, all locked to the pilot.
+/// The amplitudes are parts of the peak deviation, 1.0 = 75 kHz.
+/// White noise and an error of the sample clock of the recording can be added.
+/// The signal is generated in pieces of any size, so long signals need no memory.
+
+#pragma once
+
+#include "Arduino.h"
+
+/// Synthesizer of an MPX signal.
+class MpxSynthesizer
+{
+public:
+    MpxSynthesizer(unsigned long rate);  ///< create a synthesizer for rate samples per second.
+    ~MpxSynthesizer();
+
+    void setGroups(const uint16_t *groups, int count); ///< RDS groups, 4 blocks each, sent cyclically. NULL for no RDS.
+    void setLevels(float audio, float pilot, float rds); ///< Amplitudes of the audio, the pilot and RDS, pilot 0 is mono.
+    void setNoise(float rms, unsigned long seed = 1);  ///< White noise added to the signal.
+    void setClockError(double ppm);                    ///< Error of the sample clock, the signal frequencies scale by 1 + ppm / 1e6.
+    void generate(float *mpx, size_t count);          ///< The next samples of the signal.
+
+private:
+    static const int OVERSAMPLE = 16;  ///< Resolution of the pulse table per sample.
+    static const int SYMBOLS = 16;     ///< Symbols kept around the current time.
+
+    signed char _symbol(unsigned long k); ///< Differentially encoded symbol of bit k, +1 or -1.
+
+    unsigned long _rate;
+    const uint16_t *_groups;
+    int _groupCount;
+    float _audio, _pilot, _rds, _noise;
+    double _scale;             ///< 1 + ppm / 1e6.
+    unsigned long _seed;
+    unsigned long _sample;     ///< Number of the next sample.
+
+    float *_pulse;             ///< Biphase symbol, 2.5 bits each side at 1 / OVERSAMPLE of a sample.
+    int _half;                 ///< Index of the center of _pulse.
+    float _peak;               ///< Peak of _pulse, the RDS level is relative to it.
+
+    signed char _symbols[SYMBOLS]; ///< Ring of the last symbols.
+    unsigned long _symbolCount;    ///< Number of symbols computed.
+    byte _level;                   ///< Output of the differential encoder.
+}; // class MpxSynthesizer
@@ -0,0 +1,87 @@
+/// \file radiointerfacelinuxi2c.cpp
+/// \brief RadioInterface for the Linux i2c-dev driver.
+
+#include "radiointerfacelinuxi2c.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+
+RadioInterfaceLinuxI2c::RadioInterfaceLinuxI2c(const char* device):
+    _device(device),
+    _fd(-1) {}
+
+
+RadioInterfaceLinuxI2c::~RadioInterfaceLinuxI2c()
+{
+    if(_fd>=0)
+    {
+        close(_fd);
+    }
+}
+
+
+void RadioInterfaceLinuxI2c::init()
+{
+    if(_fd<0)
+    {
+        _fd=open(_device, O_RDWR);
+    }
+}
+
+
+bool RadioInterfaceLinuxI2c::isDetected(byte address)
+{
+    byte data;
+    return receive(address, &data, 1);
+}
+
+
+bool RadioInterfaceLinuxI2c::send(byte address, byte* data, byte length)
+{
+    struct i2c_msg msg = { address, 0, length, data };
+    struct i2c_rdwr_ioctl_data rdwr = { &msg, 1 };
+    return _fd>=0 && ioctl(_fd, I2C_RDWR, &rdwr)==1;
+}
+
+
+bool RadioInterfaceLinuxI2c::sendReceive(byte address, byte* wData, byte wLength, byte* rData, byte rLength)
+{
+    struct i2c_msg msgs[2] = {
+        { address, 0, wLength, wData },
+        { address, I2C_M_RD, rLength, rData }
+    };
+    struct i2c_rdwr_ioctl_data rdwr = { msgs, 2 };
+    return _fd>=0 && ioctl(_fd, I2C_RDWR, &rdwr)==2;
+}
+
+
+bool RadioInterfaceLinuxI2c::receive(byte address, byte* data, byte length)
+{
+    struct i2c_msg msg = { address, I2C_M_RD, length, data };
+    struct i2c_rdwr_ioctl_data rdwr = { &msg, 1 };
+    return _fd>=0 && ioctl(_fd, I2C_RDWR, &rdwr)==1;
+}
+
+
+/// Execute all operations of the transaction with repeated starts in one ioctl.
+bool RadioInterfaceLinuxI2c::transfer(RadioTransaction& transaction)
+{
+    struct i2c_msg msgs[RadioTransaction::MAX_OPERATIONS];
+    byte n=transaction.count();
+    for (byte i=0;i<n;i++)
+    {
+        RadioTransaction::OPERATION& op=transaction.operation(i);
+        msgs[i].addr=op.address;
+        msgs[i].flags=op.read ? I2C_M_RD : 0;
+        msgs[i].len=op.length;
+        msgs[i].buf=op.data;
+    }
+    struct i2c_rdwr_ioctl_data rdwr = { msgs, n };
+    return _fd>=0 && ioctl(_fd, I2C_RDWR, &rdwr)==n;
+}
+
+// End.
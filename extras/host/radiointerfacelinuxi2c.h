@@ -0,0 +1,29 @@
+///
+/// \file radiointerfacelinuxi2c.h
+/// \brief RadioInterface for the Linux i2c-dev driver.
+///
+/// \details
+/// Every call and every RadioTransaction is executed as one I2C_RDWR ioctl,
+/// so the operations of a transaction are combined with repeated starts.
+
+#pragma once
+
+#include "radiointerface.h"
+
+class RadioInterfaceLinuxI2c : public RadioInterface
+{
+public:
+    RadioInterfaceLinuxI2c(const char* device); ///< e.g. "/dev/i2c-1"
+    ~RadioInterfaceLinuxI2c();
+
+    void init();
+    bool isDetected(byte address);
+    bool send(byte address, byte* data, byte length);
+    bool sendReceive(byte address, byte* wData, byte wLength, byte* rData, byte rLength);
+    bool receive(byte address, byte* data, byte length);
+    bool transfer(RadioTransaction& transaction);
+
+private:
+    const char* _device;
+    int _fd;
+};
@@ -0,0 +1,795 @@
+/// \file radiosimulator.cpp
+/// \brief Simulated radio chips implementing the RadioInterface on a Linux host.
+///
+/// \details
+/// See radiosimulator.h.
+/// The chip state is advanced lazily on every bus access, so no thread or timer is needed.
+
+#include "radiosimulator.h"
+
+
+// ----- common simulator -----
+
+RadioSimulator::RadioSimulator():
+    _stations(NULL),
+    _stationCount(0),
+    _noise(8),
+    _tuneTime(60000),
+    _seekStepTime(15000),
+    _rdsSyncTime(150000),
+    _busClock(100000),
+    _tunedFreq(0),
+    _tunedAt(0),
+    _rdsConsumed(-1),
+    _rdsSignaled(-1),
+    _rdsRead(0),
+    _rdsLatency(0),
+    _busy(false),
+    _busyUntil(0),
+    _targetFreq(0),
+    _targetFail(false),
+    _intPin(0xFF),
+    _intLow(false),
+    _intReleaseAt(0),
+    _intCount(0) {}
+
+
+void RadioSimulator::setStations(const SIM_STATION* stations, byte count)
+{
+    _stations=stations;
+    _stationCount=count;
+    _tuneTo(_tunedFreq);
+}
+
+
+void RadioSimulator::setNoise(byte rssi)
+{
+    _noise=rssi;
+}
+
+
+void RadioSimulator::setTiming(unsigned long tuneTime, unsigned long seekStepTime, unsigned long rdsSyncTime)
+{
+    _tuneTime=tuneTime;
+    _seekStepTime=seekStepTime;
+    _rdsSyncTime=rdsSyncTime;
+}
+
+
+void RadioSimulator::setBusClock(unsigned long hz)
+{
+    _busClock=hz;
+}
+
+
+/// Start, address byte, data bytes with acknowledge and stop.
+void RadioSimulator::_busTime(byte length)
+{
+    if(_busClock)
+    {
+        delayMicroseconds((unsigned long)(2+9*(length+1))*1000000/_busClock);
+    }
+}
+
+
+void RadioSimulator::setInterruptPin(byte pin)
+{
+    _intPin=pin;
+    _intLow=false;
+    hostSetPin(pin, HIGH);
+    hostAttachClockListener(this);
+}
+
+
+/// The chip state only changes at the end of a tune or seek and at the start of a group.
+bool RadioSimulator::nextEvent(unsigned long *at)
+{
+    bool found=false;
+    if(_intPin==0xFF)
+    {
+        return false;
+    }
+    if(_intLow && !_intLevelMode())
+    {
+        *at=_intReleaseAt;
+        found=true;
+    }
+    byte enabled=_intEnabled();
+    if(_busy && (enabled & INT_STC) && (!found || (long)(_busyUntil-*at)<0))
+    {
+        *at=_busyUntil;
+        found=true;
+    }
+    const SIM_STATION* st=_station(_tunedFreq);
+    if(!_busy && (enabled & INT_RDS) && st && st->rdsGroups && st->rdsCount)
+    {
+        unsigned long groupAt=_tunedAt+_rdsSyncTime+(_rdsSignaled+1)*RDS_GROUP_TIME;
+        if(!found || (long)(groupAt-*at)<0)
+        {
+            *at=groupAt;
+            found=true;
+        }
+    }
+    return found;
+}
+
+
+void RadioSimulator::clockEvent()
+{
+    if(_intLow && !_intLevelMode() && (long)(micros()-_intReleaseAt)>=0)
+    {
+        _release();
+    }
+    _update();
+}
+
+
+bool RadioSimulator::_intLevelMode()
+{
+    return false;
+}
+
+
+/// A new interrupt while the line is still low is not seen by an edge triggered input.
+void RadioSimulator::_signal()
+{
+    if(_intPin==0xFF)
+    {
+        return;
+    }
+    _intCount++;
+    _intLow=true;
+    _intReleaseAt=micros()+INT_PULSE_TIME;
+    hostSetPin(_intPin, LOW);
+}
+
+
+void RadioSimulator::_release()
+{
+    if(_intLow)
+    {
+        _intLow=false;
+        hostSetPin(_intPin, HIGH);
+    }
+}
+
+
+unsigned long RadioSimulator::interruptCount()
+{
+    return _intCount;
+}
+
+
+void RadioSimulator::init() {}
+
+
+bool RadioSimulator::isDetected(byte address)
+{
+    return address==0x10;
+}
+
+
+const SIM_STATION* RadioSimulator::_station(word freq)
+{
+    for (byte i=0;i<_stationCount;i++)
+    {
+        if(_stations[i].freq==freq)
+        {
+            return &_stations[i];
+        }
+    }
+    return NULL;
+}
+
+
+byte RadioSimulator::_rssi(word freq)
+{
+    const SIM_STATION* st=_station(freq);
+    return st ? st->rssi : _noise;
+}
+
+
+void RadioSimulator::_tuneTo(word freq)
+{
+    _tunedFreq=freq;
+    _tunedAt=micros();
+    _rdsConsumed=-1;
+    _rdsSignaled=-1;
+    _rdsRead=0;
+    _rdsLatency=0;
+}
+
+
+bool RadioSimulator::_rdsSync()
+{
+    const SIM_STATION* st=_station(_tunedFreq);
+    return st && st->rdsGroups && st->rdsCount && (micros()-_tunedAt >= _rdsSyncTime);
+}
+
+
+unsigned long RadioSimulator::rdsGroupsSent()
+{
+    if(!_rdsSync())
+    {
+        return 0;
+    }
+    return (micros()-_tunedAt-_rdsSyncTime)/RDS_GROUP_TIME + 1;
+}
+
+
+unsigned long RadioSimulator::rdsGroupsRead()
+{
+    return _rdsRead;
+}
+
+
+unsigned long RadioSimulator::rdsLatency()
+{
+    return _rdsRead ? _rdsLatency/_rdsRead : 0;
+}
+
+
+/// The newest group is ready until it is read out or RDSR_TIME has passed.
+bool RadioSimulator::_rdsGroup(uint16_t* blocks, byte* errors)
+{
+    if(!_rdsSync())
+    {
+        return false;
+    }
+    const SIM_STATION* st=_station(_tunedFreq);
+    unsigned long t=micros()-_tunedAt-_rdsSyncTime;
+    long n=t/RDS_GROUP_TIME;
+    word idx=n % st->rdsCount;
+    memcpy(blocks, &st->rdsGroups[idx*4], 4*sizeof(uint16_t));
+    *errors=st->rdsErrors ? st->rdsErrors[idx] : 0;
+    return (n>_rdsConsumed) && (t-n*RDS_GROUP_TIME < RDSR_TIME);
+}
+
+
+void RadioSimulator::_rdsConsume()
+{
+    if(_rdsSync())
+    {
+        unsigned long t=micros()-_tunedAt-_rdsSyncTime;
+        _rdsConsumed=t/RDS_GROUP_TIME;
+        _rdsRead++;
+        _rdsLatency+=t-_rdsConsumed*RDS_GROUP_TIME;
+    }
+}
+
+
+/// Groups whose ready time has passed unseen are skipped.
+bool RadioSimulator::_rdsNew()
+{
+    if(!_rdsSync())
+    {
+        return false;
+    }
+    unsigned long t=micros()-_tunedAt-_rdsSyncTime;
+    long n=t/RDS_GROUP_TIME;
+    if(n<=_rdsSignaled)
+    {
+        return false;
+    }
+    _rdsSignaled=n;
+    return (n>_rdsConsumed) && (t-n*RDS_GROUP_TIME < RDSR_TIME);
+}
+
+
+// ----- SI4703 -----
+
+// Register and bit definitions, see the SI4703 datasheet and AN230.
+#define SI_POWERCFG   0x02
+#define SI_CHANNEL    0x03
+#define SI_SYSCONFIG1 0x04
+#define SI_SYSCONFIG2 0x05
+#define SI_GPIO2_INT  0x0004
+#define SI_STATUSRSSI 0x0A
+#define SI_READCHAN   0x0B
+#define SI_RDSA       0x0C
+
+#define SI_MONO   13
+#define SI_RDSM   11
+#define SI_SKMODE 10
+#define SI_SEEKUP 9
+#define SI_SEEK   8
+#define SI_TUNE   15
+#define SI_RDSIEN 15
+#define SI_STCIEN 14
+#define SI_RDS    12
+
+#define SI_RDSR 15
+#define SI_STC  14
+#define SI_SFBL 13
+#define SI_RDSS 11
+#define SI_ST   8
+
+
+SimSI4703::SimSI4703()
+{
+    memset(registers, 0, sizeof(registers));
+    registers[0x00]=0x1242;
+    registers[0x01]=0x1253;
+    setTiming(60000, 15000, 150000); // Tune Time (datasheet Table 8.), seek steps are faster than a tune
+}
+
+
+byte SimSI4703::_intEnabled()
+{
+    word config=registers[SI_SYSCONFIG1];
+    byte enabled=0;
+    if((config & 0x000C)!=SI_GPIO2_INT)
+    {
+        return 0;
+    }
+    if(bitRead(config, SI_STCIEN))
+    {
+        enabled|=INT_STC;
+    }
+    if(bitRead(config, SI_RDSIEN) && bitRead(config, SI_RDS))
+    {
+        enabled|=INT_RDS;
+    }
+    return enabled;
+}
+
+
+word SimSI4703::_bandLow()
+{
+    return ((registers[SI_SYSCONFIG2]>>6) & 0x03) ? 7600 : 8750;
+}
+
+
+word SimSI4703::_bandHigh()
+{
+    return ((registers[SI_SYSCONFIG2]>>6) & 0x03)==2 ? 9000 : 10800;
+}
+
+
+word SimSI4703::_spacing()
+{
+    switch ((registers[SI_SYSCONFIG2]>>4) & 0x03)
+    {
+    case 0:
+        return 20;
+    case 1:
+        return 10;
+    default:
+        return 5;
+    }
+}
+
+
+word SimSI4703::_channelFreq(word channel)
+{
+    return _bandLow() + channel*_spacing();
+}
+
+
+bool SimSI4703::send(byte address, byte* data, byte length)
+{
+    if(address!=0x10)
+    {
+        return false;
+    }
+    _busTime(length);
+    _update();
+    word oldPower=registers[SI_POWERCFG];
+    word oldChannel=registers[SI_CHANNEL];
+    for (byte k=0;(k<<1)+1<length;k++)
+    {
+        byte reg=SI_POWERCFG+k;
+        if(reg<=0x07)
+        {
+            registers[reg]=(data[k<<1]<<8) | data[(k<<1)+1];
+        }
+    }
+
+    if(bitRead(registers[SI_CHANNEL], SI_TUNE) && !bitRead(oldChannel, SI_TUNE))
+    {
+        _targetFreq=_channelFreq(registers[SI_CHANNEL] & 0x03FF);
+        _targetFail=false;
+        _busy=true;
+        _busyUntil=micros()+_tuneTime;
+        bitClear(registers[SI_STATUSRSSI], SI_STC);
+    }
+    else if(bitRead(registers[SI_POWERCFG], SI_SEEK) && !bitRead(oldPower, SI_SEEK))
+    {
+        // step through the band until a station above the seek threshold is found.
+        bool up=bitRead(registers[SI_POWERCFG], SI_SEEKUP);
+        bool wrap=!bitRead(registers[SI_POWERCFG], SI_SKMODE);
+        byte threshold=registers[SI_SYSCONFIG2]>>8;
+        word freq=_tunedFreq;
+        word steps=0;
+        word maxSteps=(_bandHigh()-_bandLow())/_spacing()+1;
+        _targetFail=true;
+        while (steps<maxSteps)
+        {
+            steps++;
+            if(up)
+            {
+                freq=freq+_spacing()>_bandHigh() ? (wrap ? _bandLow() : _bandHigh()) : freq+_spacing();
+            }
+            else
+            {
+                freq=freq<_bandLow()+_spacing() ? (wrap ? _bandHigh() : _bandLow()) : freq-_spacing();
+            }
+            if(_station(freq) && _rssi(freq)>=threshold)
+            {
+                _targetFail=false;
+                break;
+            }
+            if(!wrap && (freq==_bandLow() || freq==_bandHigh()))
+            {
+                break;
+            }
+        }
+        _targetFreq=_targetFail && wrap ? _tunedFreq : freq;
+        _busy=true;
+        _busyUntil=micros()+steps*_seekStepTime;
+        bitClear(registers[SI_STATUSRSSI], SI_STC);
+    }
+
+    if(!bitRead(registers[SI_CHANNEL], SI_TUNE) && !bitRead(registers[SI_POWERCFG], SI_SEEK))
+    {
+        // the host acknowledged the end of the tune or seek.
+        _busy=false;
+        bitClear(registers[SI_STATUSRSSI], SI_STC);
+        bitClear(registers[SI_STATUSRSSI], SI_SFBL);
+    }
+    return true;
+}
+
+
+bool SimSI4703::receive(byte address, byte* data, byte length)
+{
+    if(address!=0x10)
+    {
+        return false;
+    }
+    _busTime(length);
+    _update();
+    for (byte k=0;(k<<1)+1<length;k++)
+    {
+        byte reg=(SI_STATUSRSSI+k) & 0x0F;
+        data[k<<1]=highByte(registers[reg]);
+        data[(k<<1)+1]=lowByte(registers[reg]);
+        if(reg==0x0F && bitRead(registers[SI_STATUSRSSI], SI_RDSR))
+        {
+            _rdsConsume();
+            bitClear(registers[SI_STATUSRSSI], SI_RDSR);
+        }
+    }
+    return true;
+}
+
+
+bool SimSI4703::sendReceive(byte address, byte* wData, byte wLength, byte* rData, byte rLength)
+{
+    return send(address, wData, wLength) && receive(address, rData, rLength);
+}
+
+
+void SimSI4703::_update()
+{
+    if(_busy && (long)(micros()-_busyUntil)>=0)
+    {
+        _busy=false;
+        _tuneTo(_targetFreq);
+        bitSet(registers[SI_STATUSRSSI], SI_STC);
+        bitWrite(registers[SI_STATUSRSSI], SI_SFBL, _targetFail);
+        registers[SI_READCHAN]=(registers[SI_READCHAN] & 0xFC00) | ((_targetFreq-_bandLow())/_spacing());
+        if(_intEnabled() & INT_STC)
+        {
+            _signal();
+        }
+    }
+
+    const SIM_STATION* st=_station(_tunedFreq);
+    word status=registers[SI_STATUSRSSI] & (bit(SI_STC) | bit(SI_SFBL) | bit(SI_RDSR));
+    status|=_busy ? _noise : _rssi(_tunedFreq);
+    if(!_busy && st && st->stereo && !bitRead(registers[SI_POWERCFG], SI_MONO))
+    {
+        bitSet(status, SI_ST);
+    }
+
+    uint16_t blocks[4];
+    byte errors;
+    bool rds=!_busy && bitRead(registers[SI_SYSCONFIG1], SI_RDS);
+    if(rds && _rdsSync())
+    {
+        bitSet(status, SI_RDSS);
+    }
+    if(rds && (_intEnabled() & INT_RDS) && _rdsNew())
+    {
+        _signal();
+    }
+    if(rds && _rdsGroup(blocks, &errors))
+    {
+        bitSet(status, SI_RDSR);
+        memcpy(&registers[SI_RDSA], blocks, sizeof(blocks));
+        if(bitRead(registers[SI_POWERCFG], SI_RDSM))
+        {
+            // verbose mode: BLERA in STATUSRSSI, BLERB..BLERD in READCHAN.
+            status|=((errors>>6) & 0x03)<<9;
+            registers[SI_READCHAN]=(registers[SI_READCHAN] & 0x03FF) | ((word)(errors & 0x3F)<<10);
+        }
+    }
+    else
+    {
+        bitClear(status, SI_RDSR);
+    }
+    registers[SI_STATUSRSSI]=status;
+}
+
+
+// ----- RDA5807M -----
+
+// Register and bit definitions, see the RDA5807M datasheet.
+#define RDA_SEEKUP 9
+#define RDA_SEEK   8
+#define RDA_SKMODE 7
+#define RDA_RDS_EN 3
+#define RDA_SOFT_RESET 1
+#define RDA_TUNE   4
+#define RDA_MONO   13
+#define RDA_RDSIEN 15
+#define RDA_STCIEN 14
+#define RDA_GPIO2_INT 0x0004
+#define RDA_INT_MODE  15
+
+#define RDA_RDSR 15
+#define RDA_STC  14
+#define RDA_SF   13
+#define RDA_RDSS 12
+#define RDA_ST   10
+#define RDA_FM_TRUE  8
+#define RDA_FM_READY 7
+
+
+SimRDA5807M::SimRDA5807M():
+    _pointer(0)
+{
+    memset(registers, 0, sizeof(registers));
+    registers[0x00]=0x5804;
+    setTiming(40000, 3000, 150000);
+}
+
+
+byte SimRDA5807M::_intEnabled()
+{
+    word config=registers[4];
+    byte enabled=0;
+    if((config & 0x000C)!=RDA_GPIO2_INT)
+    {
+        return 0;
+    }
+    if(bitRead(config, RDA_STCIEN))
+    {
+        enabled|=INT_STC;
+    }
+    if(bitRead(config, RDA_RDSIEN) && bitRead(registers[2], RDA_RDS_EN))
+    {
+        enabled|=INT_RDS;
+    }
+    return enabled;
+}
+
+
+/// INT_MODE set: the interrupt lasts until register 0x0C is read.
+bool SimRDA5807M::_intLevelMode()
+{
+    return bitRead(registers[5], RDA_INT_MODE);
+}
+
+
+word SimRDA5807M::_bandLow()
+{
+    static const word low[4]={8700, 7600, 7600, 6500};
+    return low[(registers[3]>>2) & 0x03];
+}
+
+
+word SimRDA5807M::_bandHigh()
+{
+    static const word high[4]={10800, 9100, 10800, 7600};
+    return high[(registers[3]>>2) & 0x03];
+}
+
+
+/// 25 kHz spacing can not be expressed in 10 kHz units and is simulated as 50 kHz.
+word SimRDA5807M::_spacing()
+{
+    static const word spacing[4]={10, 20, 5, 5};
+    return spacing[registers[3] & 0x03];
+}
+
+
+void SimRDA5807M::_write(byte reg, word value)
+{
+    reg&=0x0F;
+    if(reg<0x02 || reg>0x07)
+    {
+        return;
+    }
+    word old=registers[reg];
+    registers[reg]=value;
+    if(reg==2 && bitRead(value, RDA_SOFT_RESET))
+    {
+        memset(&registers[2], 0, 14*sizeof(word));
+        registers[2]=value;
+        _busy=false;
+        return;
+    }
+    if(reg==3 && bitRead(value, RDA_TUNE))
+    {
+        _targetFreq=_bandLow()+(value>>6)*_spacing();
+        _targetFail=false;
+        _busy=true;
+        _busyUntil=micros()+_tuneTime;
+        bitClear(registers[0x0A], RDA_STC);
+    }
+    else if(reg==2 && bitRead(value, RDA_SEEK) && !(bitRead(old, RDA_SEEK) && _busy))
+    {
+        bool up=bitRead(value, RDA_SEEKUP);
+        bool wrap=!bitRead(value, RDA_SKMODE);
+        byte threshold=(registers[5]>>8) & 0x0F;
+        word freq=_tunedFreq;
+        word steps=0;
+        word maxSteps=(_bandHigh()-_bandLow())/_spacing()+1;
+        _targetFail=true;
+        while (steps<maxSteps)
+        {
+            steps++;
+            if(up)
+            {
+                freq=freq+_spacing()>_bandHigh() ? (wrap ? _bandLow() : _bandHigh()) : freq+_spacing();
+            }
+            else
+            {
+                freq=freq<_bandLow()+_spacing() ? (wrap ? _bandHigh() : _bandLow()) : freq-_spacing();
+            }
+            if(_station(freq) && _rssi(freq)>=threshold)
+            {
+                _targetFail=false;
+                break;
+            }
+            if(!wrap && (freq==_bandLow() || freq==_bandHigh()))
+            {
+                break;
+            }
+        }
+        _targetFreq=_targetFail && wrap ? _tunedFreq : freq;
+        _busy=true;
+        _busyUntil=micros()+steps*_seekStepTime;
+        bitClear(registers[0x0A], RDA_STC);
+    }
+}
+
+
+word SimRDA5807M::_read(byte reg)
+{
+    reg&=0x0F;
+    if(reg==0x0C && _intLevelMode())
+    {
+        _release();
+    }
+    if(reg==0x0F && bitRead(registers[0x0A], RDA_RDSR))
+    {
+        _rdsConsume();
+        bitClear(registers[0x0A], RDA_RDSR);
+    }
+    return registers[reg];
+}
+
+
+bool SimRDA5807M::send(byte address, byte* data, byte length)
+{
+    _busTime(length);
+    _update();
+    if(address==0x10)
+    {
+        for (byte k=0;(k<<1)+1<length;k++)
+        {
+            _write(2+k, (data[k<<1]<<8) | data[(k<<1)+1]);
+        }
+        return true;
+    }
+    if(address==0x11 && length)
+    {
+        _pointer=data[0];
+        for (byte k=0;(k<<1)+2<length;k++)
+        {
+            _write(_pointer+k, (data[(k<<1)+1]<<8) | data[(k<<1)+2]);
+        }
+        return true;
+    }
+    return false;
+}
+
+
+bool SimRDA5807M::receive(byte address, byte* data, byte length)
+{
+    if(address!=0x10 && address!=0x11)
+    {
+        return false;
+    }
+    _busTime(length);
+    _update();
+    byte reg=address==0x10 ? 0x0A : _pointer;
+    for (byte k=0;(k<<1)+1<length;k++)
+    {
+        word value=_read(reg+k);
+        data[k<<1]=highByte(value);
+        data[(k<<1)+1]=lowByte(value);
+    }
+    return true;
+}
+
+
+bool SimRDA5807M::sendReceive(byte address, byte* wData, byte wLength, byte* rData, byte rLength)
+{
+    return send(address, wData, wLength) && receive(address, rData, rLength);
+}
+
+
+void SimRDA5807M::_update()
+{
+    if(_busy && (long)(micros()-_busyUntil)>=0)
+    {
+        _busy=false;
+        _tuneTo(_targetFreq);
+        bitClear(registers[3], RDA_TUNE);
+        bitClear(registers[2], RDA_SEEK);
+        bitSet(registers[0x0A], RDA_STC);
+        bitWrite(registers[0x0A], RDA_SF, _targetFail);
+        registers[0x0A]=(registers[0x0A] & 0xFC00) | ((_targetFreq-_bandLow())/_spacing());
+        if(_intEnabled() & INT_STC)
+        {
+            _signal();
+        }
+    }
+
+    const SIM_STATION* st=_station(_tunedFreq);
+    byte rssi=_busy ? _noise : _rssi(_tunedFreq);
+    word status=registers[0x0A] & (bit(RDA_STC) | bit(RDA_SF) | bit(RDA_RDSR) | 0x03FF);
+    word quality=(word)(rssi>127 ? 127 : rssi)<<9;
+    if(!_busy)
+    {
+        bitSet(quality, RDA_FM_READY);
+        if(st && rssi>=((registers[5]>>8) & 0x0F))
+        {
+            bitSet(quality, RDA_FM_TRUE);
+        }
+        if(st && st->stereo && !bitRead(registers[2], RDA_MONO))
+        {
+            bitSet(status, RDA_ST);
+        }
+    }
+
+    uint16_t blocks[4];
+    byte errors;
+    bool rds=!_busy && bitRead(registers[2], RDA_RDS_EN);
+    if(rds && _rdsSync())
+    {
+        bitSet(status, RDA_RDSS);
+    }
+    if(rds && (_intEnabled() & INT_RDS) && _rdsNew())
+    {
+        _signal();
+    }
+    if(rds && _rdsGroup(blocks, &errors))
+    {
+        bitSet(status, RDA_RDSR);
+        memcpy(&registers[0x0C], blocks, sizeof(blocks));
+        quality|=(errors>>4) & 0x0F; // BLERA and BLERB
+    }
+    else
+    {
+        bitClear(status, RDA_RDSR);
+    }
+    registers[0x0A]=status;
+    registers[0x0B]=quality;
+}
+
+// End.
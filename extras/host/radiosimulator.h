@@ -0,0 +1,155 @@
+///
+/// \file radiosimulator.h
+/// \brief Simulated radio chips implementing the RadioInterface on a Linux host.
+///
+/// \details
+/// The simulators emulate the register maps of the SI4703 and the RDA5807M,
+/// so the drivers in src/ run unmodified without hardware.
+/// A table of stations defines the band: frequency, RSSI, stereo and a cyclic stream of RDS groups.
+/// Tune and seek take the modeled time, measured with micros().
+/// Use hostUseVirtualClock(true) to run the modeled time faster than real time.
+/// With setInterruptPin() the GPIO2 interrupt output of the chips is emulated on a host pin,
+/// it is driven when the driver enabled the RDS or seek/tune complete interrupt.
+
+#pragma once
+
+#include "radiointerface.h"
+
+/// A simulated station.
+typedef struct SIM_STATION {
+    word freq;                  ///< Frequency in 10 kHz units, e.g. 8930 for 89.3 MHz.
+    byte rssi;                  ///< Received signal strength of the station.
+    bool stereo;                ///< The station transmits a stereo pilot.
+    const uint16_t* rdsGroups;  ///< RDS groups, 4 blocks per group, sent cyclically. NULL for no RDS.
+    word rdsCount;              ///< Number of groups in rdsGroups.
+    const byte* rdsErrors;      ///< Optional error levels per group, 2 bits per block with block A in bits 7:6. NULL for no errors.
+} SIM_STATION;
+
+
+/// Common part of the simulated chips: stations, timing, the RDS stream and the interrupt line.
+class RadioSimulator : public RadioInterface, public HostClockListener
+{
+public:
+    static const unsigned long RDS_GROUP_TIME = 87719;  ///< usec per RDS group, 11.4 groups per second.
+    static const unsigned long RDSR_TIME = 40000;       ///< usec the RDS ready flag stays set.
+    static const unsigned long INT_PULSE_TIME = 5000;   ///< usec the interrupt line is low.
+
+    RadioSimulator();
+
+    void setStations(const SIM_STATION* stations, byte count); ///< Define the stations of the band.
+    void setNoise(byte rssi);                                  ///< RSSI on frequencies without a station.
+    void setTiming(unsigned long tuneTime, unsigned long seekStepTime, unsigned long rdsSyncTime); ///< Modeled times in usec.
+    void setBusClock(unsigned long hz);                        ///< I2C clock used to model the time of a bus call, 0 = no bus time.
+    void setInterruptPin(byte pin);                            ///< Host pin driven by the GPIO2 interrupt output.
+
+    void init();
+    bool isDetected(byte address);
+
+    unsigned long rdsGroupsSent();  ///< Number of groups the tuned station has sent since tuning.
+    unsigned long rdsGroupsRead();  ///< Number of groups read out of the RDS registers since tuning.
+    unsigned long rdsLatency();     ///< Average time in usec from the start of a group until it was read out, since tuning.
+    unsigned long interruptCount(); ///< Number of interrupts signaled.
+
+    bool nextEvent(unsigned long *at);
+    void clockEvent();
+
+protected:
+    static const byte INT_STC = 0x01;  ///< The seek/tune complete interrupt is enabled.
+    static const byte INT_RDS = 0x02;  ///< The RDS ready interrupt is enabled and RDS is on.
+
+    const SIM_STATION* _station(word freq);   ///< Station on a frequency or NULL.
+    byte _rssi(word freq);                    ///< RSSI on a frequency.
+
+    void _tuneTo(word freq);                  ///< The chip reached a new frequency, restart the RDS stream.
+    bool _rdsSync();                          ///< RDS is synchronized on the tuned station.
+    bool _rdsGroup(uint16_t* blocks, byte* errors); ///< Fetch the newest group, returns true when it is ready and unread.
+    void _rdsConsume();                       ///< The newest group was read.
+    bool _rdsNew();                           ///< Returns true once for every group that became ready.
+
+    virtual void _update() = 0;               ///< Advance the chip state to the current time.
+    virtual byte _intEnabled() = 0;           ///< INT_STC and INT_RDS as configured in the registers.
+    virtual bool _intLevelMode();             ///< The line stays low until it is released by a register read.
+    void _busTime(byte length);               ///< Spend the time of a bus call transferring length bytes.
+    void _signal();                           ///< Pull the interrupt line low.
+    void _release();                          ///< Release the interrupt line.
+
+    const SIM_STATION* _stations;
+    byte _stationCount;
+    byte _noise;
+    unsigned long _tuneTime;
+    unsigned long _seekStepTime;
+    unsigned long _rdsSyncTime;
+    unsigned long _busClock;
+
+    word _tunedFreq;                          ///< Frequency the chip is tuned to.
+    unsigned long _tunedAt;                   ///< micros() when the frequency was reached.
+    long _rdsConsumed;                        ///< Index of the last group read out.
+    long _rdsSignaled;                        ///< Index of the last group reported by _rdsNew().
+    unsigned long _rdsRead;
+    unsigned long _rdsLatency;                ///< Sum of the read out latencies.
+
+    bool _busy;                               ///< A tune or seek is running.
+    unsigned long _busyUntil;                 ///< micros() when it completes.
+    word _targetFreq;
+    bool _targetFail;
+
+    byte _intPin;                             ///< Host pin of the interrupt line, 0xFF = none.
+    bool _intLow;                             ///< The interrupt line is pulled low.
+    unsigned long _intReleaseAt;              ///< micros() when a pulse ends.
+    unsigned long _intCount;
+};
+
+
+/// Simulated SI4703 at I2C address 0x10.
+/// Reads start at register 0x0A and wrap around after 0x0F, writes start at register 0x02.
+class SimSI4703 : public RadioSimulator
+{
+public:
+    SimSI4703();
+
+    bool send(byte address, byte* data, byte length);
+    bool sendReceive(byte address, byte* wData, byte wLength, byte* rData, byte rLength);
+    bool receive(byte address, byte* data, byte length);
+
+    word registers[16];                       ///< Current register set of the chip.
+
+protected:
+    void _update();
+    byte _intEnabled();
+
+private:
+    word _bandLow();
+    word _bandHigh();
+    word _spacing();
+    word _channelFreq(word channel);
+};
+
+
+/// Simulated RDA5807M.
+/// Address 0x10 is the sequential mode: reads start at register 0x0A, writes start at register 0x02.
+/// Address 0x11 is the random mode: the first written byte selects the register.
+class SimRDA5807M : public RadioSimulator
+{
+public:
+    SimRDA5807M();
+
+    bool send(byte address, byte* data, byte length);
+    bool sendReceive(byte address, byte* wData, byte wLength, byte* rData, byte rLength);
+    bool receive(byte address, byte* data, byte length);
+
+    word registers[16];                       ///< Current register set of the chip.
+
+protected:
+    void _update();
+    byte _intEnabled();
+    bool _intLevelMode();
+
+private:
+    void _write(byte reg, word value);
+    word _read(byte reg);
+    word _bandLow();
+    word _bandHigh();
+    word _spacing();
+
+    byte _pointer;                            ///< Register selected in random mode.
+};
@@ -0,0 +1,840 @@
+/// \file rdsbench.cpp
+/// \brief Measure the RDSParser on synthetic group streams.
+///
+/// \details
+/// Build and run on a Linux host:
+///   g++ -O2 -Iextras/host -Isrc extras/host/Arduino.cpp extras/host/rdsgen.cpp extras/host/rdsbench.cpp src/RDSParser.cpp src/RDSStationCache.cpp src/RDSTMC.cpp src/RDSRTPlus.cpp src/RDSBlockFilter.cpp src/RDSClock.cpp -o rdsbench
+///   ./rdsbench [groups.txt]
+/// Reports the number of groups until the first correct Program Service name and RadioText are received
+/// for stations sending A and B version groups, and the decoding time per group.
+/// Acquisition is measured over many receptions starting at random positions of the stream,
+/// on a clean channel and with lost groups or undetected bit errors injected.
+/// A wrong PS name fails the bench, it must not be published even when the same bit error arrives twice.
+/// "other" are group types without a decoder and measure the dispatch alone.
+///
+/// The TMC decoder is measured on a stream of 8A groups only, with single and multi group messages
+/// for more locations than the event store holds. It reports the messages that were published correctly.
+/// The RT+ decoder is measured on a stream of items, each with a RadioText "title by artist", its RT+ tags
+/// in 11A groups and the ODA announcement in 3A groups. It reports the items whose title and artist were passed on
+/// and the groups from the start of an item until both are known.
+/// The stream generator is measured in groups per second, and its stream of a station with all kinds of groups
+/// is decoded with corrected and uncorrectable block errors through a RDSBlockFilter,
+/// counting the RadioTexts and clock times passed on and the wrong ones.
+/// The AF decoder gets the method B lists of two transmitters of a station mixed, in both orders,
+/// and has to collect the list of the transmitter it is tuned to, or the first list without a frequency.
+/// The RDSClock gets a CT every minute on a board with millis() 0.3% slow, the CTs arrive up to 60 ms late
+/// and some are an hour off. It reports the measured drift, the largest error of the clock half a minute after a CT
+/// once the drift is known, and the time of a query.
+/// A recorded stream of groups as printed by mpxrds -g is decoded as well when its file is given,
+/// groups with blocks of error level 2 or more are dropped by a RDSBlockFilter.
+
+#include "Arduino.h"
+#include "RDSParser.h"
+#include "RDSTMC.h"
+#include "RDSRTPlus.h"
+#include "RDSBlockFilter.h"
+#include "RDSClock.h"
+#include "rdsgen.h"
+#include <time.h>
+
+static const uint16_t PI_CODE = 0xD3C2;
+
+/// A stream of groups like a station sends it.
+struct STREAM {
+    uint16_t groups[64][4];
+    int count;
+};
+
+/// Errors of the channel in percent of the groups.
+struct CHANNEL {
+    const char *label;
+    int lost;       ///< Groups that are not received.
+    int corrupted;  ///< Groups with one wrong bit in block 2, 3 or 4 that is not detected.
+};
+
+static const CHANNEL channels[] = {
+    { "clean",        0,  0 },
+    { "10% lost",    10,  0 },
+    { "30% lost",    30,  0 },
+    { "2% bit err",   0,  2 },
+    { "5% bit err",   0,  5 }
+};
+
+static const char *PS_NAME = "BENCH FM";
+static const char *TEXT = "Benchmark text";
+static const int TRIALS = 1000;
+static const long MAX_GROUPS = 2000;
+
+static RDSParser rds;
+static bool psReceived;
+static bool psWrong;
+static bool textReceived;
+static bool textWrong;
+static bool textShown;
+static unsigned long sink;
+static uint32_t seed = 1;
+static int failures;            ///< Checks that failed, the exit code is 1 then.
+
+
+static void add(STREAM &s, uint16_t b2, uint16_t b3, uint16_t b4)
+{
+    s.groups[s.count][0] = PI_CODE;
+    s.groups[s.count][1] = b2;
+    s.groups[s.count][2] = b3;
+    s.groups[s.count][3] = b4;
+    s.count++;
+} // add()
+
+
+/// PS in 4 groups 0A or 0B, version B repeats the PI in block 3.
+static void addPS(STREAM &s, const char *ps, bool versionB)
+{
+    for (int i = 0; i < 4; i++)
+        add(s, (versionB ? 0x0800 : 0x0000) | i, versionB ? PI_CODE : 0xE0CD, (ps[2 * i] << 8) | ps[2 * i + 1]);
+} // addPS()
+
+
+/// RadioText in groups 2A (4 characters each) or 2B (2 characters each), terminated by a carriage return.
+static void addText(STREAM &s, const char *text, bool versionB)
+{
+    char buffer[65];
+    int per = versionB ? 2 : 4;
+    int len = strlen(text);
+    memset(buffer, ' ', sizeof(buffer));
+    memcpy(buffer, text, len);
+    buffer[len++] = '\r';
+    for (int i = 0; i * per < len; i++) {
+        const char *p = &buffer[i * per];
+        if (versionB)
+            add(s, 0x2800 | i, PI_CODE, (p[0] << 8) | p[1]);
+        else
+            add(s, 0x2000 | i, (p[0] << 8) | p[1], (p[2] << 8) | p[3]);
+    } // for
+} // addText()
+
+
+static void mix(STREAM &s, bool versionB)
+{
+    s.count = 0;
+    addPS(s, "BENCH FM", versionB);
+    addText(s, TEXT, versionB);
+    addPS(s, "BENCH FM", versionB);
+    add(s, 0x4001, 0xC0A3, 0x5A40);          // 4A clock time
+    add(s, 0x8000, 0x1234, 0x5678);          // 8A TMC
+    add(s, 0xE000, 0xABCD, 0xD4A1);          // 14A EON
+    add(s, versionB ? 0x1800 : 0x1000, 0, 0); // 1A/1B
+} // mix()
+
+
+static void onPS(const char *name)
+{
+    if (name[0] == ' ')
+        return;
+    if (!strcmp(name, PS_NAME))
+        psReceived = true;
+    else
+        psWrong = true;
+} // onPS()
+/// The text is received with the terminating '\r'.
+static void onText(const char *text)
+{
+    if (!text[0])
+        return;
+    if (!strncmp(text, TEXT, strlen(TEXT)) && !strcmp(text + strlen(TEXT), "\r"))
+        textReceived = true;
+    else
+        textWrong = true;
+} // onText()
+
+
+/// The partial text shows the whole message, before it is confirmed.
+static void onTextSegment(const char *text, byte)
+{
+    if (!strncmp(text, TEXT, strlen(TEXT)) && !strcmp(text + strlen(TEXT), "\r"))
+        textShown = true;
+} // onTextSegment()
+static void onTime(unsigned long utc, char) { sink += utc; }
+
+
+static uint32_t _random(uint32_t range)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed % range;
+} // _random()
+
+
+static int _compare(const void *a, const void *b)
+{
+    return *(const long *)a - *(const long *)b;
+} // _compare()
+
+
+/// Groups until the first correct PS and RadioText, averaged over TRIALS receptions.
+/// The 95th percentile shows the slow receptions, "wrong" counts receptions that published a wrong name or text.
+/// "shown" is the time until the partial text passed per segment shows the whole message.
+static void acquire(const char *label, const STREAM &s, const CHANNEL &ch)
+{
+    long psAt[TRIALS], textAt[TRIALS], shownAt[TRIALS];
+    long psMissed = 0, textMissed = 0, wrong = 0, textWrongCount = 0;
+    double psSum = 0, textSum = 0, shownSum = 0;
+
+    for (int t = 0; t < TRIALS; t++) {
+        long start = _random(s.count);
+        rds.processData(0, 0, 0, 0);
+        psReceived = psWrong = textReceived = textWrong = textShown = false;
+        psAt[t] = textAt[t] = shownAt[t] = MAX_GROUPS;
+        for (long n = 0; n < MAX_GROUPS && (psAt[t] == MAX_GROUPS || textAt[t] == MAX_GROUPS); n++) {
+            uint16_t g[4];
+            memcpy(g, s.groups[(start + n) % s.count], sizeof(g));
+            if ((int)_random(100) < ch.lost)
+                continue;
+            if ((int)_random(100) < ch.corrupted)
+                g[1 + _random(3)] ^= 1 << _random(16);
+            rds.processData(g[0], g[1], g[2], g[3]);
+            if (psReceived && psAt[t] == MAX_GROUPS) psAt[t] = n + 1;
+            if (textReceived && textAt[t] == MAX_GROUPS) textAt[t] = n + 1;
+            if ((textShown || textReceived) && shownAt[t] == MAX_GROUPS) shownAt[t] = n + 1;
+        } // for
+        if (psWrong) wrong++;
+        if (textWrong) textWrongCount++;
+        if (psAt[t] == MAX_GROUPS) psMissed++;
+        if (textAt[t] == MAX_GROUPS) textMissed++;
+        psSum += psAt[t];
+        textSum += textAt[t];
+        shownSum += shownAt[t];
+    } // for
+    if (wrong)
+        failures++;
+    qsort(psAt, TRIALS, sizeof(long), _compare);
+    qsort(textAt, TRIALS, sizeof(long), _compare);
+    printf("  %-9s %-11s PS mean %6.1f p95 %5ld missed %4ld wrong %4ld | RT mean %6.1f p95 %5ld missed %4ld wrong %4ld shown %6.1f\n",
+           label, ch.label, psSum / TRIALS, psAt[TRIALS * 95 / 100], psMissed, wrong,
+           textSum / TRIALS, textAt[TRIALS * 95 / 100], textMissed, textWrongCount, shownSum / TRIALS);
+} // acquire()
+
+
+static double _seconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+} // _seconds()
+
+
+static void throughput(const char *label, const STREAM &s)
+{
+    const long total = 20000000;
+    double start = _seconds();
+    for (long n = 0, i = 0; n < total; n++) {
+        const uint16_t *g = s.groups[i];
+        rds.processData(g[0], g[1], g[2], g[3]);
+        if (++i == s.count) i = 0;
+    } // for
+    double ns = (_seconds() - start) * 1e9 / total;
+    printf("  %-10s %.1f ns per group\n", label, ns);
+} // throughput()
+
+
+/// Groups no decoder is registered for, this is the cost of the dispatch alone.
+static void other(STREAM &s)
+{
+    s.count = 0;
+    for (int type = 5; type < 16; type++) {
+        if (type == 8 || type == 14) continue;
+        add(s, type << 12, 0x1234, 0x5678);
+        add(s, (type << 12) | 0x0800, PI_CODE, 0x5678);
+    } // for
+} // other()
+
+
+// ----- TMC -----
+
+/// A message of the TMC stream.
+struct TMC_MESSAGE {
+    uint16_t location;
+    uint16_t event;
+    byte extent;
+    byte flags;
+    byte duration;
+};
+
+static const int TMC_MESSAGES = 60;
+static TMC_MESSAGE tmcMessages[TMC_MESSAGES];
+static uint16_t tmcGroups[1024][4];
+static int tmcCount;
+
+static RDSTMCStore tmcStore;
+static RDSTMCDecoder tmc(&tmcStore);
+static long tmcCorrect;
+static long tmcWrong;
+
+
+static void addTMC(uint16_t b2, uint16_t b3, uint16_t b4)
+{
+    tmcGroups[tmcCount][0] = PI_CODE;
+    tmcGroups[tmcCount][1] = 0x8000 | b2;
+    tmcGroups[tmcCount][2] = b3;
+    tmcGroups[tmcCount][3] = b4;
+    tmcCount++;
+} // addTMC()
+
+
+/// Single group messages are sent with each group twice.
+/// Multi group messages carry the duration, a control code for 8 more locations and up to 8 supplementary
+/// information labels as optional content in 1 to 4 groups, they are sent twice.
+/// Every second multi group message starts with an additional event (label 9, 11 bits),
+/// the duration and the control code behind it are only right when its size is.
+static void tmcStream()
+{
+    tmcCount = 0;
+    for (int m = 0; m < TMC_MESSAGES; m++) {
+        TMC_MESSAGE &msg = tmcMessages[m];
+        msg.location = 12000 + _random(4000);
+        msg.event = 1 + _random(2047);
+        msg.extent = _random(8);
+        msg.flags = _random(2) ? RDS_TMC_NEGATIVE : 0;
+        msg.duration = _random(8);
+        uint16_t b3 = ((msg.flags & RDS_TMC_NEGATIVE) ? 0x4000 : 0) | (msg.extent << 11) | msg.event;
+
+        if (m % 3) {
+            if (_random(4) == 0) msg.flags |= RDS_TMC_DIVERSION;
+            if (msg.flags & RDS_TMC_DIVERSION) b3 |= 0x8000;
+            addTMC(0x0008 | msg.duration, b3, msg.location);
+            addTMC(0x0008 | msg.duration, b3, msg.location);
+            continue;
+        }
+
+        byte content[112];
+        int bits = 0;
+        uint32_t fields[3 + 8][2];
+        int count = 0;
+        bool additional = (m % 6) == 0;
+        if (additional) {
+            fields[count][0] = 9;
+            fields[count++][1] = _random(2048);
+        }
+        fields[count][0] = 0;
+        fields[count++][1] = msg.duration;
+        fields[count][0] = 1;
+        fields[count++][1] = 6;
+        // 4 groups hold 112 bits, the additional event takes 15 of them.
+        for (int n = _random(additional ? 7 : 9); n > 0; n--) {
+            fields[count][0] = 6;
+            fields[count++][1] = _random(256);
+        }
+        static const byte sizes[] = { 3, 3, 5, 5, 5, 8, 8, 8, 8, 11 };
+        for (int f = 0; f < count; f++) {
+            for (int b = 3; b >= 0; b--) content[bits++] = (fields[f][0] >> b) & 1;
+            for (int b = sizes[fields[f][0]] - 1; b >= 0; b--) content[bits++] = (fields[f][1] >> b) & 1;
+        }
+        int groups = (bits + 27) / 28;
+        memset(content + bits, 0, sizeof(content) - bits);
+        msg.extent += 8;
+        msg.flags |= RDS_TMC_MULTIGROUP;
+
+        byte ci = 1 + m % 6;
+        for (int r = 0; r < 2; r++) {
+            addTMC(ci, 0x8000 | b3, msg.location);
+            for (int g = 0; g < groups; g++) {
+                uint32_t data = 0;
+                for (int b = 0; b < 28; b++) data = (data << 1) | content[g * 28 + b];
+                addTMC(ci, (g == 0 ? 0x4000 : 0) | ((groups - 1 - g) << 12) | (data >> 16), data & 0xFFFF);
+            }
+        }
+    } // for
+} // tmcStream()
+
+
+static void onTMC(const RDS_TMC_EVENT *event)
+{
+    for (int m = 0; m < TMC_MESSAGES; m++) {
+        const TMC_MESSAGE &msg = tmcMessages[m];
+        if ((msg.location == event->location) && (msg.event == event->event) && (msg.extent == event->extent)
+            && (msg.flags == event->flags) && (msg.duration == event->duration)) {
+            tmcCorrect++;
+            return;
+        }
+    } // for
+    tmcWrong++;
+} // onTMC()
+
+
+/// Messages published on a pass through the stream with lost groups.
+static void tmcAcquire(const CHANNEL &ch)
+{
+    tmcStore.clear();
+    tmc.reset();
+    tmcCorrect = tmcWrong = 0;
+    unsigned long drops = tmc.getDropCount();
+    for (int n = 0; n < tmcCount; n++) {
+        if ((int)_random(100) < ch.lost)
+            continue;
+        const uint16_t *g = tmcGroups[n];
+        rds.processData(g[0], g[1], g[2], g[3]);
+    } // for
+    printf("  %-11s published %3ld of %d correct, %ld wrong, %lu multi group messages dropped, %u stored\n",
+           ch.label, tmcCorrect, TMC_MESSAGES, tmcWrong, tmc.getDropCount() - drops, tmcStore.getCount());
+    if (tmcWrong || (!ch.lost && (tmcCorrect != TMC_MESSAGES)))
+        failures++;
+} // tmcAcquire()
+
+
+/// Time per group of the TMC stream.
+static void tmcThroughput()
+{
+    const long total = 2000000;
+    double start = _seconds();
+    for (long n = 0, i = 0; n < total; n++) {
+        const uint16_t *g = tmcGroups[i];
+        rds.processData(g[0], g[1], g[2], g[3]);
+        if (++i == tmcCount) i = 0;
+    } // for
+    double ns = (_seconds() - start) * 1e9 / total;
+    printf("  8A groups  %.1f ns per group, %d of %d events stored\n", ns, tmcStore.getCount(), RDS_TMC_EVENTS);
+} // tmcThroughput()
+
+
+// ----- RT+ -----
+
+/// An item of the RT+ stream.
+struct RTP_ITEM {
+    const char *title;
+    const char *artist;
+};
+
+static const RTP_ITEM rtpItems[] = {
+    { "Blue Monday", "New Order" },
+    { "Heroes", "David Bowie" },
+    { "Enjoy the Silence", "Depeche Mode" },
+    { "Teardrop", "Massive Attack" },
+    { "Once in a Lifetime", "Talking Heads" },
+    { "Windowlicker", "Aphex Twin" },
+    { "Karma Police", "Radiohead" },
+    { "Hyperballad", "Bjork" }
+};
+
+static const int RTP_ITEMS = sizeof(rtpItems) / sizeof(rtpItems[0]);
+static const byte RTP_GROUP = RDS_GROUP_A(11);
+static uint16_t rtpGroups[1024][4];
+static int rtpStart[RTP_ITEMS + 1];
+static int rtpCount;
+
+static RDSRTPlusDecoder rtplus(&rds);
+static RDSODARegistry oda;
+static int rtpItem;
+static bool rtpTitle;
+static bool rtpArtist;
+static long rtpWrong;
+
+
+static void addRTP(uint16_t b2, uint16_t b3, uint16_t b4)
+{
+    rtpGroups[rtpCount][0] = PI_CODE;
+    rtpGroups[rtpCount][1] = b2;
+    rtpGroups[rtpCount][2] = b3;
+    rtpGroups[rtpCount][3] = b4;
+    rtpCount++;
+} // addRTP()
+
+
+/// Every item sends its text 4 times with the A/B flag of the item, between the text groups come
+/// an RT+ group with the title and the artist, the ODA announcement and the PS.
+static void rtpStream()
+{
+    rtpCount = 0;
+    for (int i = 0; i < RTP_ITEMS; i++) {
+        char text[65];
+        int len = snprintf(text, sizeof(text), "%s by %s\r", rtpItems[i].title, rtpItems[i].artist);
+        int segments = (len + 3) / 4;
+        byte titleLength = strlen(rtpItems[i].title);
+        byte artistStart = titleLength + 4;
+        byte artistLength = strlen(rtpItems[i].artist);
+        uint16_t ab = (i & 1) ? 0x0010 : 0;
+        memset(text + len, ' ', sizeof(text) - len);
+
+        rtpStart[i] = rtpCount;
+        for (int r = 0; r < 4; r++) {
+            for (int seg = 0; seg < segments; seg++) {
+                addRTP(0x2000 | ab | seg, (text[4 * seg] << 8) | text[4 * seg + 1], (text[4 * seg + 2] << 8) | text[4 * seg + 3]);
+                if (seg % 4 == 1)
+                    addRTP((RTP_GROUP << 11) | ab | 0x0008 | (RDS_RTP_ITEM_TITLE >> 3),
+                           ((RDS_RTP_ITEM_TITLE & 0x07) << 13) | ((uint16_t)0 << 7) | ((titleLength - 1) << 1) | (RDS_RTP_ITEM_ARTIST >> 5),
+                           ((RDS_RTP_ITEM_ARTIST & 0x1F) << 11) | (artistStart << 5) | (artistLength - 1));
+                else if (seg % 4 == 3)
+                    addRTP((RDS_GROUP_A(3) << 11) | RTP_GROUP, 0x0000, RDS_RTP_AID);
+                else
+                    addRTP(seg & 3, 0xE0CD, (PS_NAME[2 * (seg & 3)] << 8) | PS_NAME[2 * (seg & 3) + 1]);
+            } // for
+        } // for
+    } // for
+    rtpStart[RTP_ITEMS] = rtpCount;
+} // rtpStream()
+
+
+static void onTag(byte contentType, const char *text, byte start, byte length)
+{
+    const char *expected = (contentType == RDS_RTP_ITEM_TITLE) ? rtpItems[rtpItem].title
+                           : (contentType == RDS_RTP_ITEM_ARTIST) ? rtpItems[rtpItem].artist : NULL;
+    if (expected && (strlen(expected) == length) && !memcmp(text + start, expected, length)) {
+        if (contentType == RDS_RTP_ITEM_TITLE) rtpTitle = true;
+        else rtpArtist = true;
+    } else {
+        rtpWrong++;
+    }
+} // onTag()
+
+
+/// Items with title and artist on a pass through the stream with lost groups.
+static void rtpAcquire(const CHANNEL &ch)
+{
+    int complete = 0;
+    long groups = 0;
+
+    rds.processData(0, 0, 0, 0);
+    rtpWrong = 0;
+    for (rtpItem = 0; rtpItem < RTP_ITEMS; rtpItem++) {
+        rtpTitle = rtpArtist = false;
+        for (int n = rtpStart[rtpItem]; n < rtpStart[rtpItem + 1]; n++) {
+            if ((int)_random(100) < ch.lost)
+                continue;
+            const uint16_t *g = rtpGroups[n];
+            rds.processData(g[0], g[1], g[2], g[3]);
+            if (rtpTitle && rtpArtist) {
+                complete++;
+                groups += n + 1 - rtpStart[rtpItem];
+                break;
+            }
+        } // for
+    } // for
+    printf("  %-11s %d of %d items with title and artist after %.1f groups, %ld wrong tags\n",
+           ch.label, complete, RTP_ITEMS, complete ? (double)groups / complete : 0.0, rtpWrong);
+} // rtpAcquire()
+
+
+/// Time per group of the RT+ stream.
+static void rtpThroughput()
+{
+    const long total = 5000000;
+    double start = _seconds();
+    for (long n = 0, i = 0; n < total; n++) {
+        const uint16_t *g = rtpGroups[i];
+        rds.processData(g[0], g[1], g[2], g[3]);
+        if (++i == rtpCount) i = 0;
+    } // for
+    double ns = (_seconds() - start) * 1e9 / total;
+    printf("  RT+ stream %.1f ns per group, %lu RT+ groups decoded\n", ns, rtplus.getGroupCount());
+} // rtpThroughput()
+
+
+// ----- generator -----
+
+static const char *GEN_TEXT = "Generated text with an A/B toggle";
+static const word genAF[] = { 8840, 9040, 10210, 10450, 10670 };
+static const RDS_GEN_STATION genStation = {
+    PI_CODE, 10, true, false, PS_NAME, { TEXT, GEN_TEXT }, 2,
+    genAF, 5, 1791115200UL, 2, true, 0x6552, RDS_GROUP_A(11)
+};
+static long genTexts, genTextsWrong, genTimes, genTimesWrong, genNamesWrong;
+static unsigned long genLastTime;
+
+
+static void onGenPS(const char *name)
+{
+    if ((name[0] != ' ') && strcmp(name, PS_NAME))
+        genNamesWrong++;
+} // onGenPS()
+
+
+static void onGenText(const char *text)
+{
+    if (!text[0])
+        return;
+    size_t len = strlen(text) - 1;
+    if ((text[len] == '\r') && ((len == strlen(TEXT) && !strncmp(text, TEXT, len)) || (len == strlen(GEN_TEXT) && !strncmp(text, GEN_TEXT, len))))
+        genTexts++;
+    else
+        genTextsWrong++;
+} // onGenText()
+
+
+/// The generated clock time advances by a minute per 4A group.
+static void onGenTime(unsigned long utc, char offset)
+{
+    if ((offset == 2) && (utc % 60 == 0) && (!genLastTime || (utc > genLastTime)))
+        genTimes++;
+    else
+        genTimesWrong++;
+    genLastTime = utc;
+} // onGenTime()
+
+
+/// Groups per second of the generator, and the generated stream with errors decoded by the parser.
+static void generated()
+{
+    static uint16_t groups[4096][4];
+    static byte errors[4096];
+    const long total = 20000000;
+    RDSStreamGenerator gen(&genStation);
+
+    printf("generator, %d groups per pass\n", 4096);
+    for (int e = 0; e < 2; e++) {
+        gen.setErrors(e ? 0.05f : 0, e ? 0.02f : 0);
+        double start = _seconds();
+        for (long n = 0; n < total; n += 4096)
+            gen.generate(groups[0], errors, 4096);
+        double rate = total / (_seconds() - start);
+        sink += groups[1][1];
+        printf("  %-20s %.1f million groups per second\n", e ? "5% + 2% block errors" : "no errors", rate / 1e6);
+    } // for
+
+    RDSBlockFilter filter;
+    rds.attachServicenNameCallback(onGenPS);
+    rds.attachTextCallback(onGenText);
+    rds.attachTimeCallback(onGenTime);
+    rds.attachTextSegmentCallback(NULL);
+    rds.processData(0, 0, 0, 0);
+    gen.restart();
+    long passed = 0;
+    const long hours = 24;
+    double start = _seconds();
+    for (long n = 0; n < hours * 41040; n += 4096) {
+        gen.generate(groups[0], errors, 4096);
+        for (int i = 0; i < 4096; i++) {
+            uint16_t *g = groups[i];
+            if (filter.filter(&g[0], &g[1], &g[2], &g[3], errors[i])) {
+                rds.processData(g[0], g[1], g[2], g[3]);
+                passed++;
+            }
+        } // for
+    } // for
+    double ns = (_seconds() - start) * 1e9 / gen.getGroupCount();
+    printf("  %ld h of signal, %lu groups, %lu dropped by the filter, %.1f ns per group generated, filtered and decoded\n",
+           hours, gen.getGroupCount(), filter.getDropCount(), ns);
+    printf("  %ld RadioTexts, %ld wrong, %ld clock times, %ld wrong, %ld wrong PS\n",
+           genTexts, genTextsWrong, genTimes, genTimesWrong, genNamesWrong);
+    if (genNamesWrong)
+        failures++;
+} // generated()
+
+
+// ----- AF lists -----
+
+/// Method B list of a transmitter: its AF code and the pairs with it, the higher code first marks a regional variant.
+struct AF_LIST {
+    byte tuned;
+    byte pairs[3][2];
+};
+
+static const AF_LIST afLists[2] = {
+    { 99, { { 9, 99 }, { 99, 134 }, { 174, 99 } } }, // 97.4 MHz: 88.4, 100.9 and 104.9 MHz regional
+    { 25, { { 25, 99 }, { 25, 75 }, { 185, 25 } } }  // 90.0 MHz: 97.4, 95.0 and 106.0 MHz regional
+};
+
+static RDSAlternativeFrequencyDecoder af;
+
+
+/// Send both lists 3 times starting with list first, tuned to list tuned or -1 for an unknown frequency.
+static void afCheck(int first, int tuned)
+{
+    STREAM s;
+    s.count = 0;
+    for (int r = 0; r < 3; r++) {
+        for (int n = 0; n < 2; n++) {
+            const AF_LIST &l = afLists[(first + n) % 2];
+            add(s, 0x0000, ((224 + 4) << 8) | l.tuned, 0x4146);
+            for (int p = 0; p < 3; p++)
+                add(s, 0x0001 + p, (l.pairs[p][0] << 8) | l.pairs[p][1], 0x4146);
+        } // for
+    } // for
+
+    rds.processData(0, 0, 0, 0);
+    af.setFrequency(tuned < 0 ? 0 : RDS_AF_FREQ(afLists[tuned].tuned));
+    rds.processGroups(&s.groups[0][0], s.count);
+
+    const AF_LIST &l = afLists[tuned < 0 ? first : tuned];
+    bool ok = af.isMethodB() && af.isComplete() && (af.getAFCount() == 4) && (af.getAF(0) == RDS_AF_FREQ(l.tuned));
+    for (int p = 0; p < 3; p++) {
+        byte code = (l.pairs[p][0] == l.tuned) ? l.pairs[p][1] : l.pairs[p][0];
+        ok = ok && (af.getAF(p + 1) == RDS_AF_FREQ(code)) && (af.isRegional(p + 1) == (l.pairs[p][0] > l.pairs[p][1]));
+    } // for
+    if (!ok)
+        failures++;
+
+    char tunedName[16] = "unknown";
+    if (tuned >= 0)
+        snprintf(tunedName, sizeof(tunedName), "%.1f MHz", RDS_AF_FREQ(afLists[tuned].tuned) / 100.0);
+    printf("  list of %.1f MHz first, tuned to %s: list of %.1f MHz with %u frequencies %s\n",
+           RDS_AF_FREQ(afLists[first].tuned) / 100.0, tunedName, af.getAF(0) / 100.0, af.getAFCount(), ok ? "ok" : "WRONG");
+} // afCheck()
+
+
+static void afMethodB()
+{
+    rds.attachAFDecoder(&af);
+    printf("AF method B, lists of 2 transmitters mixed\n");
+    for (int first = 0; first < 2; first++) {
+        afCheck(first, 0);
+        afCheck(first, 1);
+        afCheck(first, -1);
+    } // for
+    rds.attachAFDecoder(NULL);
+} // afMethodB()
+
+
+// ----- clock -----
+
+/// millis() runs on the virtual clock, 1 ms of millis() is 1.003 ms of the stations.
+static void clockDrift()
+{
+    const double SLOW = 1.003;
+    const unsigned long START = 1791115200UL;
+    const int MINUTES = 6 * 60;
+    RDSClock clock;
+    long worst = 0;
+
+    hostUseVirtualClock(true);
+    unsigned long base = millis();
+    for (int m = 1; m <= MINUTES; m++) {
+        // reception of the CT of minute m and a query half a minute later, in ms of the stations.
+        double received = m * 60000.0 + 88 + _random(60);
+        delay((unsigned long)(received / SLOW) - (millis() - base));
+        clock.update(START + m * 60 + ((m % 37) ? 0 : 3600), 2);
+
+        double query = m * 60000.0 + 30000;
+        delay((unsigned long)(query / SLOW) - (millis() - base));
+        word ms;
+        unsigned long utc = clock.getUTC(&ms);
+        long error = (long)(((double)(utc - START) * 1000 + ms) - query);
+        if ((m > 15) && (labs(error) > worst))
+            worst = labs(error);
+    } // for
+
+    const long total = 10000000;
+    double start = _seconds();
+    for (long n = 0; n < total; n++)
+        sink += clock.getLocalTime();
+    double ns = (_seconds() - start) * 1e9 / total;
+    hostUseVirtualClock(false);
+    printf("clock, %d minutes with millis() 3000 ppm slow\n", MINUTES);
+    printf("  drift %ld ppm, largest error %ld ms after 15 min, %lu CTs rejected, %.1f ns per query\n",
+           clock.getDrift(), worst, clock.getRejectCount(), ns);
+} // clockDrift()
+
+
+static void onRecordedTag(byte contentType, const char *text, byte start, byte length)
+{
+    printf("  RT+ %2u '%.*s'\n", contentType, length, text + start);
+} // onRecordedTag()
+
+
+/// Decode a recorded stream, lines of time, 4 blocks in hex and the 4 error levels.
+/// The tags of RT+ are printed as they are passed on.
+static void recorded(const char *name)
+{
+    static uint16_t groups[200000][4];
+    static byte errors[200000];
+    long count = 0, tmcGroupCount = 0;
+    char line[200];
+    RDSBlockFilter filter;
+
+    FILE *f = fopen(name, "r");
+    if (!f) {
+        perror(name);
+        return;
+    }
+    while (fgets(line, sizeof(line), f) && (count < 200000)) {
+        double t;
+        unsigned b1, b2, b3, b4;
+        char levels[8] = "0000";
+        if (sscanf(line, "%lf %x %x %x %x %7s", &t, &b1, &b2, &b3, &b4, levels) < 5)
+            continue;
+        groups[count][0] = b1;
+        groups[count][1] = b2;
+        groups[count][2] = b3;
+        groups[count][3] = b4;
+        errors[count] = RDS_BLER(levels[0] - '0', levels[1] - '0', levels[2] - '0', levels[3] - '0') & 0xFF;
+        if ((b2 >> 11) == RDS_GROUP_A(8))
+            tmcGroupCount++;
+        count++;
+    } // while
+    fclose(f);
+
+    tmcStore.clear();
+    tmc.reset();
+    rtplus.attachTagCallback(onRecordedTag);
+    rds.processData(0, 0, 0, 0);
+    tmcCorrect = tmcWrong = 0;
+    unsigned long messages = tmc.getMessageCount();
+    unsigned long drops = tmc.getDropCount();
+    double start = _seconds();
+    for (long n = 0; n < count; n++) {
+        uint16_t g[4];
+        memcpy(g, groups[n], sizeof(g));
+        if (filter.filter(&g[0], &g[1], &g[2], &g[3], errors[n]))
+            rds.processData(g[0], g[1], g[2], g[3]);
+    } // for
+    double ns = (_seconds() - start) * 1e9 / (count ? count : 1);
+    printf("%s: %ld groups, %ld 8A groups, %ld dropped by the filter, RT+ %s\n", name, count, tmcGroupCount,
+           (long)filter.getDropCount(), oda.getGroupCode(RDS_RTP_AID) < RDS_GROUP_CODES ? "announced" : "not announced");
+    printf("  %lu messages, %lu multi group messages dropped, %u events stored, %.1f ns per group\n",
+           tmc.getMessageCount() - messages, tmc.getDropCount() - drops, tmcStore.getCount(), ns);
+    for (byte n = 0; n < tmcStore.getCount(); n++) {
+        const RDS_TMC_EVENT *e = tmcStore.get(n);
+        printf("  location %5u event %4u extent %2u %c%s%s duration %u received %u\n", e->location, e->event, e->extent,
+               (e->flags & RDS_TMC_NEGATIVE) ? '-' : '+', (e->flags & RDS_TMC_DIVERSION) ? " diversion" : "",
+               (e->flags & RDS_TMC_MULTIGROUP) ? " multi" : "", e->duration, e->count);
+    } // for
+} // recorded()
+
+
+int main(int argc, char *argv[])
+{
+    STREAM a, b, o;
+    Serial.setOutput(NULL);
+    mix(a, false);
+    mix(b, true);
+    other(o);
+
+    rds.attachServicenNameCallback(onPS);
+    rds.attachTextCallback(onText);
+    rds.attachTextSegmentCallback(onTextSegment);
+    rds.attachTimeCallback(onTime);
+
+    printf("acquisition in groups, %d receptions each\n", TRIALS);
+    for (unsigned c = 0; c < sizeof(channels) / sizeof(channels[0]); c++) {
+        acquire("A groups", a, channels[c]);
+        acquire("B groups", b, channels[c]);
+    } // for
+
+    printf("decoding\n");
+    throughput("A groups", a);
+    throughput("B groups", b);
+    throughput("other", o);
+
+    rds.attachGroupDecoder(RDS_GROUP_A(8), &tmc);
+    tmc.attachEventCallback(onTMC);
+    tmcStream();
+    printf("TMC, %d messages in %d 8A groups, store of %d events\n", TMC_MESSAGES, tmcCount, RDS_TMC_EVENTS);
+    for (unsigned c = 0; c < 3; c++)
+        tmcAcquire(channels[c]);
+    tmcThroughput();
+
+    rds.attachODARegistry(&oda);
+    oda.attachDecoder(RDS_RTP_AID, &rtplus);
+    rds.attachGroupDecoder(RDS_GROUP_A(2), &rtplus);
+    rds.attachGroupDecoder(RDS_GROUP_B(2), &rtplus);
+    rtplus.attachTagCallback(onTag);
+    rtpStream();
+    printf("RT+, %d items in %d groups\n", RTP_ITEMS, rtpCount);
+    for (unsigned c = 0; c < 3; c++)
+        rtpAcquire(channels[c]);
+    rtpThroughput();
+    afMethodB();
+    generated();
+    clockDrift();
+    if (argc > 1)
+        recorded(argv[1]);
+    return (failures > 0) || (sink == 1); // sink keeps the time callback from being optimized away
+} // main()
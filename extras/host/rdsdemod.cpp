@@ -0,0 +1,544 @@
+///
+/// \file rdsdemod.cpp
+/// \brief Implementation of the RDS demodulator for recorded FM multiplex signals.
+///
+/// \details
+/// Signal path and rates at 228 kHz input:
+///   MPX 228 kHz -> x 57 kHz -> low pass, decimation by 12 -> 19 kHz complex baseband
+///   -> matched filter -> Gardner timing at 2375 half bits/s -> biphase symbol -> differential bit -> blocks -> groups
+
+#include "rdsdemod.h"
+#include "RDSBlockFilter.h"
+#include "hostdsp.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const double RDS_CARRIER = 57000.0;  ///< Subcarrier frequency in Hz.
+static const double RDS_BITRATE = 1187.5;   ///< Bits per second, the subcarrier divided by 48.
+static const double BASEBAND_RATE = 19000.0; ///< Target rate after the decimation, 16 samples per bit.
+
+static const double LP_PASS = 2600.0;  ///< End of the low pass band, the RDS spectrum ends at 2.4 kHz.
+static const double LP_STOP = 9000.0;  ///< Start of the stop band, the matched filter takes the rest.
+
+static const float TIMING_GAIN = 0.05f;    ///< Proportional gain of the timing loop, part of a half bit.
+static const float TIMING_DRIFT = 0.0005f; ///< Integral gain of the timing loop.
+
+static const uint16_t GENERATOR = 0x5B9;   ///< g(x) = x^10 + x^8 + x^7 + x^5 + x^4 + x^3 + 1
+
+/// Offset words in the order of RDS_OFFSET.
+static const uint16_t OFFSETS[5] = { 0x0FC, 0x198, 0x168, 0x350, 0x1B4 };
+
+/// Block types in the order of a group, C' uses the type of C.
+enum { TYPE_A = 0, TYPE_B, TYPE_C, TYPE_D };
+
+static uint16_t syndromes[4][256]; ///< Syndrome of every byte of a 26 bit word, byte 3 has 2 bits.
+static uint32_t bursts[1024];      ///< Burst error pattern for a syndrome, 0 = not correctable.
+
+
+
+/// Remainder of a 26 bit word divided by the generator polynomial.
+static uint16_t _polyMod(uint32_t word)
+{
+    for (int bit = 25; bit >= 10; bit--) {
+        if (word & (1UL << bit))
+            word ^= (uint32_t)GENERATOR << (bit - 10);
+    }
+    return (word & 0x3FF);
+} // _polyMod()
+
+
+/// Fill the syndrome and burst tables.
+static bool _fillTables()
+{
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 256; b++)
+            syndromes[i][b] = _polyMod((uint32_t)b << (8 * i));
+    }
+
+    // Shorter bursts first so they win when two patterns share a syndrome.
+    memset(bursts, 0, sizeof(bursts));
+    for (int len = 1; len <= 5; len++) {
+        uint32_t inner = (len > 2) ? (1UL << (len - 2)) : 1;
+        for (int start = 0; start + len <= 26; start++) {
+            for (uint32_t m = 0; m < inner; m++) {
+                uint32_t pattern = (len == 1) ? 1 : (1 | (m << 1) | (1UL << (len - 1)));
+                pattern <<= start;
+                uint16_t s = _polyMod(pattern);
+                if (!bursts[s])
+                    bursts[s] = pattern;
+            }
+        }
+    }
+    return (true);
+} // _fillTables()
+
+
+/// Build the tables once, also when demodulators are created on several threads.
+static void _buildTables()
+{
+    static bool ready = _fillTables();
+    (void)ready;
+} // _buildTables()
+
+
+/// Syndrome of a received 26 bit word.
+static inline uint16_t _syndrome(uint32_t word)
+{
+    return (syndromes[0][word & 0xFF] ^ syndromes[1][(word >> 8) & 0xFF]
+        ^ syndromes[2][(word >> 16) & 0xFF] ^ syndromes[3][(word >> 24) & 0x03]);
+} // _syndrome()
+
+
+double rdsShapingPulse(double t)
+{
+    // Inverse transform of sqrt(cos(pi f td / 4)) for 0 <= f <= 2 / td.
+    const int STEPS = 128;
+    double td = 1.0 / RDS_BITRATE;
+    double df = 2.0 / td / STEPS;
+    double h = 0;
+
+    for (int m = 0; m < STEPS; m++) {
+        double f = (m + 0.5) * df;
+        h += sqrt(cos(M_PI * f * td / 4)) * cos(2 * M_PI * f * t);
+    }
+    return (2 * h * df);
+} // rdsShapingPulse()
+
+
+uint16_t rdsCheckword(uint16_t info, byte offset)
+{
+    _buildTables();
+    return (_polyMod((uint32_t)info << 10) ^ OFFSETS[offset]);
+} // rdsCheckword()
+
+
+RDSDemodulator::RDSDemodulator(unsigned long sampleRate)
+{
+    _buildTables();
+    _receiver = NULL;
+    _rate = sampleRate;
+    _decimation = (int)(sampleRate / BASEBAND_RATE + 0.5);
+    if (_decimation < 1)
+        _decimation = 1;
+    double rate = (double)sampleRate / _decimation;
+
+    // The oscillator repeats after rate / gcd(rate, 57000) samples, 4 at 228 kHz, 64 at 192 kHz.
+    _loLen = dspOscillator(-RDS_CARRIER, sampleRate, sampleRate, CHUNK, &_loCos, &_loSin);
+    _lo = 0;
+
+    // Windowed sinc low pass with a Blackman window.
+    _lpLen = (int)(5.5 * sampleRate / (LP_STOP - LP_PASS)) | 1;
+    if (_lpLen <= _decimation)
+        _lpLen = _decimation + 1;
+    _lpPad = (_lpLen + 7) & ~7;
+    _lpTaps = dspFloats(_lpPad);
+    double fc = (LP_PASS + LP_STOP) / 2 / sampleRate;
+    for (int j = 0; j < _lpLen; j++) {
+        double x = j - (_lpLen - 1) / 2.0;
+        double sinc = (x == 0) ? 2 * fc : sin(2 * M_PI * fc * x) / (M_PI * x);
+        double w = 0.42 - 0.5 * cos(2 * M_PI * j / (_lpLen - 1)) + 0.08 * cos(4 * M_PI * j / (_lpLen - 1));
+        _lpTaps[_lpLen - 1 - j] = (float)(sinc * w);
+    }
+    _mixI = dspFloats(_lpPad + CHUNK);
+    _mixQ = dspFloats(_lpPad + CHUNK);
+    _mixCount = 0;
+    _mixPos = 0;
+
+    // Matched filter for the shaping pulse over 1.5 bits on each side with a Hann window.
+    double td = 1.0 / RDS_BITRATE;
+    _mfLen = (int)(3 * td * rate) | 1;
+    _mfPad = (_mfLen + 7) & ~7;
+    _mfTaps = dspFloats(_mfPad);
+    double sum = 0;
+    for (int j = 0; j < _mfLen; j++) {
+        double t = (j - (_mfLen - 1) / 2.0) / rate;
+        double w = 0.5 - 0.5 * cos(2 * M_PI * j / (_mfLen - 1));
+        double p = rdsShapingPulse(t) * w;
+        _mfTaps[_mfLen - 1 - j] = (float)p;
+        sum += fabs(p);
+    }
+    for (int j = 0; j < _mfLen; j++)
+        _mfTaps[j] /= sum;
+    _bbSize = _mfPad + 256;
+    _bbI = dspFloats(_bbSize);
+    _bbQ = dspFloats(_bbSize);
+    _bbCount = 0;
+
+    memset(_zI, 0, sizeof(_zI));
+    memset(_zQ, 0, sizeof(_zQ));
+    _zCount = 0;
+    _halfPeriod = rate / RDS_BITRATE / 2;
+    _period = _halfPeriod;
+    _next = Z_LEN / 2;
+    _lastI = _lastQ = 0;
+    _power = 0;
+    _halfBits = 0;
+    _pairEnergy[0] = _pairEnergy[1] = 0;
+    _symbolI = _symbolQ = 0;
+
+    _reg = 0;
+    memset(_weights, 0, sizeof(_weights));
+    _bitCount = 0;
+    _synced = false;
+    _candidateBit = 0;
+    _candidateType = -1;
+    _blockBits = 0;
+    _blockType = TYPE_A;
+    _badBlocks = 0;
+    _otherOffset = false;
+    memset(_group, 0, sizeof(_group));
+    _errors = 0;
+    _groupValid = false;
+
+    _samples = 0;
+    _bits = _blocks = _corrected = _uncorrectable = _groups = _syncs = 0;
+} // RDSDemodulator()
+
+
+RDSDemodulator::~RDSDemodulator()
+{
+    free(_loCos);
+    free(_loSin);
+    free(_lpTaps);
+    free(_mixI);
+    free(_mixQ);
+    free(_mfTaps);
+    free(_bbI);
+    free(_bbQ);
+} // ~RDSDemodulator()
+
+
+void RDSDemodulator::attachReceiver(RDSGroupReceiver *receiver)
+{
+    _receiver = receiver;
+} // attachReceiver()
+
+
+void RDSDemodulator::process(const float *mpx, size_t count)
+{
+    _samples += count;
+
+    while (count) {
+        int n = (count < (size_t)CHUNK) ? (int)count : CHUNK;
+
+        // Mix to baseband, both loops are vectorized by the compiler.
+        const float *__restrict loCos = _loCos + _lo;
+        const float *__restrict loSin = _loSin + _lo;
+        float *__restrict mixI = _mixI + _mixCount;
+        float *__restrict mixQ = _mixQ + _mixCount;
+        for (int k = 0; k < n; k++) {
+            mixI[k] = mpx[k] * loCos[k];
+            mixQ[k] = mpx[k] * loSin[k];
+        }
+        _lo = (_lo + n) % _loLen;
+        _mixCount += n;
+        mpx += n;
+        count -= n;
+
+        // Low pass at the decimated rate only.
+        while (_mixPos + _lpLen <= _mixCount) {
+            float i, q;
+            dspDot2(_lpTaps, _mixI + _mixPos, _mixQ + _mixPos, _lpPad, &i, &q);
+            _sample(i, q);
+            _mixPos += _decimation;
+        }
+
+        int keep = _mixCount - _mixPos;
+        memmove(_mixI, _mixI + _mixPos, keep * sizeof(float));
+        memmove(_mixQ, _mixQ + _mixPos, keep * sizeof(float));
+        _mixCount = keep;
+        _mixPos = 0;
+    }
+} // process()
+
+
+void RDSDemodulator::_sample(float i, float q)
+{
+    if (_bbCount == _bbSize) {
+        int keep = _mfLen - 1;
+        memmove(_bbI, _bbI + _bbCount - keep, keep * sizeof(float));
+        memmove(_bbQ, _bbQ + _bbCount - keep, keep * sizeof(float));
+        _bbCount = keep;
+    }
+    _bbI[_bbCount] = i;
+    _bbQ[_bbCount] = q;
+    _bbCount++;
+
+    if (_bbCount >= _mfLen) {
+        float zi, zq;
+        int start = _bbCount - _mfLen;
+        dspDot2(_mfTaps, _bbI + start, _bbQ + start, _mfPad, &zi, &zq);
+        _symbol(zi, zq);
+    }
+} // _sample()
+
+
+void RDSDemodulator::_symbol(float i, float q)
+{
+    _zI[_zCount % Z_LEN] = i;
+    _zQ[_zCount % Z_LEN] = q;
+    _zCount++;
+
+    // The half bit center and the point before it are interpolated linearly.
+    while (_next < _zCount - 1) {
+        double mid = _next - _period / 2;
+        unsigned long k = (unsigned long)_next;
+        unsigned long m = (unsigned long)mid;
+        float f = (float)(_next - k);
+        float g = (float)(mid - m);
+        float cI = _zI[k % Z_LEN] + f * (_zI[(k + 1) % Z_LEN] - _zI[k % Z_LEN]);
+        float cQ = _zQ[k % Z_LEN] + f * (_zQ[(k + 1) % Z_LEN] - _zQ[k % Z_LEN]);
+        float mI = _zI[m % Z_LEN] + g * (_zI[(m + 1) % Z_LEN] - _zI[m % Z_LEN]);
+        float mQ = _zQ[m % Z_LEN] + g * (_zQ[(m + 1) % Z_LEN] - _zQ[m % Z_LEN]);
+
+        // Gardner timing error, positive when the half bits are sampled late.
+        float e = (cI - _lastI) * mI + (cQ - _lastQ) * mQ;
+        _power += 0.02f * ((cI * cI + cQ * cQ) - _power);
+        if (_power > 0) {
+            e /= 2 * _power;
+            if (e > 1)
+                e = 1;
+            else if (e < -1)
+                e = -1;
+            _period += TIMING_DRIFT * e;
+            if (_period > _halfPeriod * 1.005)
+                _period = _halfPeriod * 1.005;
+            else if (_period < _halfPeriod * 0.995)
+                _period = _halfPeriod * 0.995;
+            _next -= TIMING_GAIN * e * _halfPeriod;
+        }
+        _next += _period;
+        _halfBit(cI, cQ);
+    }
+} // _symbol()
+
+
+void RDSDemodulator::_halfBit(float i, float q)
+{
+    // A biphase symbol is a half bit followed by its inverse.
+    float sI = _lastI - i;
+    float sQ = _lastQ - q;
+    int parity = _halfBits & 1;
+    _pairEnergy[parity] += 0.01f * ((sI * sI + sQ * sQ) - _pairEnergy[parity]);
+    _lastI = i;
+    _lastQ = q;
+    _halfBits++;
+
+    if (_pairEnergy[parity] >= _pairEnergy[parity ^ 1]) {
+        // Differential decoding: a bit 1 turns the symbol phase by 180 degrees.
+        float d = sI * _symbolI + sQ * _symbolQ;
+        _bit(d < 0, fabsf(d));
+        _symbolI = sI;
+        _symbolQ = sQ;
+    }
+} // _halfBit()
+
+
+void RDSDemodulator::_bit(bool bit, float weight)
+{
+    _bits++;
+    _bitCount++;
+    _weights[_bitCount % 32] = weight;
+    _reg = ((_reg << 1) | bit) & 0x3FFFFFF;
+
+    if (_synced) {
+        if (++_blockBits == 26) {
+            _blockBits = 0;
+            _block(_reg);
+        }
+        return;
+    }
+
+    if (_bitCount < 26)
+        return;
+
+    // Search: 2 blocks with offsets in the right order and distance.
+    uint16_t s = _syndrome(_reg);
+    int type = -1;
+    if (s == OFFSETS[RDS_OFFSET_A])
+        type = TYPE_A;
+    else if (s == OFFSETS[RDS_OFFSET_B])
+        type = TYPE_B;
+    else if ((s == OFFSETS[RDS_OFFSET_C]) || (s == OFFSETS[RDS_OFFSET_CB]))
+        type = TYPE_C;
+    else if (s == OFFSETS[RDS_OFFSET_D])
+        type = TYPE_D;
+    if (type < 0)
+        return;
+
+    unsigned long distance = _bitCount - _candidateBit;
+    if ((_candidateType >= 0) && (distance % 26 == 0) && (distance <= 26 * 6)
+        && ((_candidateType + distance / 26) % 4 == (unsigned long)type)) {
+        _synced = true;
+        _syncs++;
+        _badBlocks = 0;
+        _otherOffset = false;
+        _blockBits = 0;
+        _blockType = type;
+        _groupValid = false;
+        _block(_reg);
+    } else {
+        _candidateBit = _bitCount;
+        _candidateType = type;
+    }
+} // _bit()
+
+
+bool RDSDemodulator::_weakBits(uint32_t pattern)
+{
+    // At a low C/N a wrong codeword near the received word is found as well, its flipped bits were received clearly.
+    float sum = 0;
+    for (int k = 0; k < 26; k++)
+        sum += _weights[(_bitCount - k) % 32];
+    for (int k = 0; k < 26; k++) {
+        if ((pattern & (1UL << k)) && (_weights[(_bitCount - k) % 32] * 26 > sum))
+            return (false);
+    }
+    return (true);
+} // _weakBits()
+
+
+void RDSDemodulator::_block(uint32_t word)
+{
+    int type = _blockType;
+    uint16_t s = _syndrome(word);
+    uint16_t e;
+
+    if (type == TYPE_C) {
+        // Block B tells C or C' by the version bit, try both when it was not received.
+        uint16_t eA = s ^ OFFSETS[RDS_OFFSET_C];
+        uint16_t eB = s ^ OFFSETS[RDS_OFFSET_CB];
+        bool knownB = _groupValid && (((_errors >> 4) & 0x03) < 3);
+        if (knownB)
+            e = (_group[1] & 0x0800) ? eB : eA;
+        else if ((eA == 0) || (eB == 0))
+            e = 0;
+        else
+            e = bursts[eA] ? eA : eB;
+    } else {
+        e = s ^ OFFSETS[(type == TYPE_D) ? RDS_OFFSET_D : type];
+    }
+
+    // After a slip by whole blocks, e.g. at the end of a looped capture, every block has the offset word of another position.
+    // Some offset words differ by a burst of 1 or 2 bits only, so a single such block is a normal error.
+    bool otherOffset = false;
+    for (int o = RDS_OFFSET_A; o <= RDS_OFFSET_D; o++)
+        otherOffset |= (s == OFFSETS[o]) && (e != 0);
+    if (otherOffset && _otherOffset) {
+        _uncorrectable++;
+        _blocks++;
+        _synced = false;
+        _candidateType = -1;
+        _groupValid = false;
+        return;
+    }
+    _otherOffset = otherOffset;
+
+    byte level = 0;
+    if (e) {
+        uint32_t pattern = bursts[e];
+        if (pattern) {
+            word ^= pattern;
+            level = ((__builtin_popcount(pattern) <= 2) && _weakBits(pattern)) ? 1 : 2;
+            _corrected++;
+        } else {
+            level = 3;
+            _uncorrectable++;
+        }
+    }
+    _blocks++;
+
+    _badBlocks = (_badBlocks << 1) | (level == 3);
+    if (__builtin_popcount(_badBlocks & ((1ULL << SYNC_HISTORY) - 1)) >= SYNC_LOST) {
+        _synced = false;
+        _candidateType = -1;
+        _groupValid = false;
+        return;
+    }
+
+    if (type == TYPE_A) {
+        _groupValid = true;
+        _errors = 0;
+    }
+    if (_groupValid) {
+        _group[type] = (uint16_t)(word >> 10);
+        _errors |= level << (6 - 2 * type);
+        if (type == TYPE_D) {
+            _groups++;
+            if (_receiver)
+                _receiver->receiveGroup(_group[0], _group[1], _group[2], _group[3], _errors);
+            _groupValid = false;
+        }
+    }
+    _blockType = (type + 1) & 3;
+} // _block()
+
+
+double RDSDemodulator::getTime()
+{
+    return (_samples / _rate);
+}
+
+unsigned long RDSDemodulator::getBits()
+{
+    return (_bits);
+}
+
+unsigned long RDSDemodulator::getBlocks()
+{
+    return (_blocks);
+}
+
+unsigned long RDSDemodulator::getCorrected()
+{
+    return (_corrected);
+}
+
+unsigned long RDSDemodulator::getUncorrectable()
+{
+    return (_uncorrectable);
+}
+
+unsigned long RDSDemodulator::getGroups()
+{
+    return (_groups);
+}
+
+unsigned long RDSDemodulator::getSyncs()
+{
+    return (_syncs);
+}
+
+bool RDSDemodulator::isSynced()
+{
+    return (_synced);
+}
+
+
+void RDSRecordedStation::receiveGroup(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4, byte errors)
+{
+    _groups.push_back(block1);
+    _groups.push_back(block2);
+    _groups.push_back(block3);
+    _groups.push_back(block4);
+    _errors.push_back(errors);
+} // receiveGroup()
+
+
+word RDSRecordedStation::getCount()
+{
+    return ((_errors.size() > 0xFFFF) ? 0xFFFF : (word)_errors.size());
+} // getCount()
+
+
+void RDSRecordedStation::getStation(SIM_STATION *station, word freq, byte rssi, bool stereo)
+{
+    station->freq = freq;
+    station->rssi = rssi;
+    station->stereo = stereo;
+    station->rdsCount = getCount();
+    station->rdsGroups = station->rdsCount ? &_groups[0] : NULL;
+    station->rdsErrors = station->rdsCount ? &_errors[0] : NULL;
+} // getStation()
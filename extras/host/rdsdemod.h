@@ -0,0 +1,152 @@
+///
+/// \file rdsdemod.h
+/// \brief RDS demodulator for recorded FM multiplex signals on a Linux host.
+///
+/// \details
+/// The demodulator takes the MPX signal after the FM discriminator, e.g. a 192 kHz or 228 kHz recording,
+/// and passes the RDS groups with the error levels of their blocks to a RDSGroupReceiver:
+/// * The 57 kHz subcarrier is mixed to baseband by a table oscillator.
+/// * A decimating low pass filter reduces the rate to about 19 kHz, 16 samples per bit.
+/// * The matched filter for the data shaping pulse is followed by a Gardner timing loop on the half bits.
+///   Pairs of half bits form the biphase symbols, the pairing with more energy in the difference wins.
+///   Differential detection of the bits needs no carrier recovery.
+/// * Blocks are synchronized by the offset words, 2 blocks in the right distance and order start a sync.
+///   2 blocks in a row with the offset words of other positions restart the search.
+/// * Burst errors up to 5 bits are corrected by a syndrome table like the chips do.
+///   The error levels are 0 = no errors, 1 = 1..2 bits, 2 = 3..5 bits, 3 = not correctable, see RDS_BLER().
+///   A correction of 1..2 bits that flips a bit received more clearly than the average of the block gets the level 2,
+///   at a low C/N it is mostly a wrong codeword.
+///
+/// The filters use GCC vector extensions, so the inner loops run on SSE, AVX or NEON.
+/// RDSRecordedStation collects the groups of a recording as a station of the radio simulator,
+/// so the drivers read recorded RDS through the emulated registers like from a chip.
+
+#pragma once
+
+#include "Arduino.h"
+#include <vector>
+#include "radiosimulator.h"
+
+/// Receiver of the demodulated groups.
+class RDSGroupReceiver
+{
+public:
+    /// A group starting with block A, errors are the error levels of the blocks.
+    virtual void receiveGroup(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4, byte errors) = 0;
+};
+
+
+/// RDS demodulator for MPX samples.
+class RDSDemodulator
+{
+public:
+    RDSDemodulator(unsigned long sampleRate); ///< create a demodulator for MPX samples at sampleRate Hz.
+    ~RDSDemodulator();
+
+    void attachReceiver(RDSGroupReceiver *receiver); ///< Register the receiver of the groups.
+    void process(const float *mpx, size_t count);    ///< Demodulate the next samples.
+
+    double getTime();                ///< Seconds of signal processed.
+    unsigned long getBits();         ///< Number of bits detected.
+    unsigned long getBlocks();       ///< Number of blocks received in sync.
+    unsigned long getCorrected();    ///< Blocks with corrected errors.
+    unsigned long getUncorrectable(); ///< Blocks with errors that could not be corrected.
+    unsigned long getGroups();       ///< Groups passed to the receiver.
+    unsigned long getSyncs();        ///< Number of times the block sync was found.
+    bool isSynced();                 ///< The blocks are in sync.
+
+private:
+    static const int CHUNK = 4096;   ///< Input samples mixed at once.
+    static const int SYNC_HISTORY = 32; ///< Blocks looked at for the loss of sync.
+    static const int SYNC_LOST = 20;    ///< Uncorrectable blocks within SYNC_HISTORY that lose the sync.
+
+    void _sample(float i, float q);  ///< A sample of the decimated baseband.
+    void _symbol(float i, float q);  ///< A matched filter output, runs the timing loop.
+    void _halfBit(float i, float q); ///< A half bit at its center, pairs them to bits.
+    void _bit(bool bit, float weight); ///< A detected bit and its reliability, runs the block sync.
+    void _block(uint32_t word);      ///< A block received in sync.
+    bool _weakBits(uint32_t pattern); ///< The bits of the pattern are less reliable than the average of the block.
+
+    RDSGroupReceiver *_receiver;
+    unsigned long _rate;     ///< Input sample rate.
+    int _decimation;         ///< Input samples per baseband sample.
+
+    // mixer and low pass filter
+    float *_loCos, *_loSin;  ///< Oscillator table, one period followed by CHUNK samples of the next.
+    int _loLen;              ///< Period of the oscillator in samples.
+    int _lo;                 ///< Position in the oscillator table.
+    float *_lpTaps;          ///< Low pass taps, reversed and padded to a multiple of 8.
+    int _lpLen;              ///< Number of low pass taps.
+    int _lpPad;              ///< _lpLen rounded up to a multiple of 8.
+    float *_mixI, *_mixQ;    ///< Mixed samples waiting for the filter.
+    int _mixCount;           ///< Samples in _mixI and _mixQ.
+    int _mixPos;             ///< Start of the next filter window.
+
+    // matched filter
+    float *_mfTaps;          ///< Matched filter taps, reversed and padded to a multiple of 8.
+    int _mfLen;              ///< Number of matched filter taps.
+    int _mfPad;              ///< _mfLen rounded up to a multiple of 8.
+    int _bbSize;             ///< Size of _bbI and _bbQ.
+    float *_bbI, *_bbQ;      ///< Baseband samples waiting for the matched filter.
+    int _bbCount;            ///< Samples in _bbI and _bbQ.
+
+    // timing loop
+    static const int Z_LEN = 32; ///< Matched filter outputs kept for the interpolation.
+    float _zI[Z_LEN], _zQ[Z_LEN]; ///< Last matched filter outputs.
+    unsigned long _zCount;   ///< Number of matched filter outputs.
+    double _halfPeriod;      ///< Nominal samples per half bit.
+    double _period;          ///< Samples per half bit tracked by the loop.
+    double _next;            ///< Sample number of the next half bit center.
+    float _lastI, _lastQ;    ///< Matched filter output at the last half bit center.
+    float _power;            ///< Average power at the half bit centers.
+
+    // biphase symbols
+    unsigned long _halfBits; ///< Number of half bits.
+    float _pairEnergy[2];    ///< Average energy of the symbols ending on even and odd half bits.
+    float _symbolI, _symbolQ; ///< The last biphase symbol.
+
+    // block sync
+    uint32_t _reg;           ///< The last 26 bits.
+    float _weights[32];      ///< Reliability of the last bits, indexed by the bit number modulo 32.
+    unsigned long _bitCount; ///< Number of bits.
+    bool _synced;
+    unsigned long _candidateBit; ///< Bit number of the last block found while searching.
+    int _candidateType;      ///< Type of that block: 0 = A, 1 = B, 2 = C or C', 3 = D, -1 = none.
+    int _blockBits;          ///< Bits of the next block received.
+    int _blockType;          ///< Type of the next block.
+    uint32_t _badBlocks;     ///< Bitmap of the uncorrectable blocks of the last SYNC_HISTORY blocks.
+    bool _otherOffset;       ///< The last block had the offset word of another position.
+    uint16_t _group[4];
+    byte _errors;
+    bool _groupValid;        ///< The group started with a block A.
+
+    double _samples;         ///< Input samples processed.
+    unsigned long _bits, _blocks, _corrected, _uncorrectable, _groups, _syncs;
+}; // class RDSDemodulator
+
+
+/// The groups of a recording as a SIM_STATION.
+class RDSRecordedStation : public RDSGroupReceiver
+{
+public:
+    void receiveGroup(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4, byte errors);
+
+    /// Fill a station with the groups, at most 65535 are used.
+    void getStation(SIM_STATION *station, word freq, byte rssi, bool stereo);
+    word getCount(); ///< Number of groups used for the station.
+
+private:
+    std::vector<uint16_t> _groups;
+    std::vector<byte> _errors;
+}; // class RDSRecordedStation
+
+
+/// Impulse response of the RDS data shaping filter at t seconds.
+/// The transmitter and the receiver each apply half of the overall cos(pi f td / 4) shaping.
+double rdsShapingPulse(double t);
+
+/// RDS block code: checkword of 16 information bits plus an offset word.
+uint16_t rdsCheckword(uint16_t info, byte offset);
+
+/// Offset words A, B, C, C' and D for rdsCheckword().
+enum RDS_OFFSET { RDS_OFFSET_A = 0, RDS_OFFSET_B, RDS_OFFSET_C, RDS_OFFSET_CB, RDS_OFFSET_D };
@@ -0,0 +1,307 @@
+///
+/// \file rdsgen.cpp
+/// \brief Implementation of the RDS stream generator.
+///
+/// \details
+/// The kinds of groups are picked by a smooth weighted round robin: every kind gains its weight per group,
+/// the kind with the most credits is sent and pays the sum of the weights.
+/// So a kind with weight 4 of 11 is sent 4 times in every 11 groups, spread over them.
+/// The clock time replaces the picked group when a minute of the stream has passed.
+
+#include "rdsgen.h"
+#include "RDSParser.h"
+
+#include <string.h>
+
+static const unsigned long GROUP_USEC = 87719;  ///< usec per group, 11.4 groups per second.
+static const unsigned long MINUTE_USEC = 60000000UL;
+static const uint16_t TMC_AID = 0xCD46;
+static const byte AF_FILLER = 205;
+static const byte AF_COUNT_BASE = 224;
+
+
+RDSStreamGenerator::RDSStreamGenerator(const RDS_GEN_STATION *station)
+{
+    static const RDS_GEN_MIX mix = { 4, 4, 1, 1, 1 };
+
+    _station = station;
+    _header = (station->tp ? 0x0400 : 0) | ((station->pty & 0x1F) << 5);
+    _corrected = _uncorrectable = 0;
+    _seed = 1;
+    setMix(&mix);
+} // RDSStreamGenerator()
+
+
+void RDSStreamGenerator::setMix(const RDS_GEN_MIX *mix)
+{
+    const RDS_GEN_STATION *st = _station;
+
+    _weight[KIND_PS] = st->ps ? mix->ps : 0;
+    _weight[KIND_TEXT] = st->text[0] ? mix->text : 0;
+    _weight[KIND_TMC] = st->tmc ? mix->tmc : 0;
+    _weight[KIND_ODA] = st->odaAid ? mix->oda : 0;
+    _weight[KIND_ANNOUNCE] = (st->tmc || st->odaAid) ? mix->announce : 0;
+    _total = 0;
+    for (int k = 0; k < KINDS; k++)
+        _total += _weight[k];
+    restart();
+} // setMix()
+
+
+void RDSStreamGenerator::setErrors(float corrected, float uncorrectable, uint32_t seed)
+{
+    double sum = corrected + uncorrectable;
+    _uncorrectable = (uint32_t)(uncorrectable * 4294967295.0);
+    _corrected = (uint32_t)(((sum < 1) ? sum : 1) * 4294967295.0);
+    _seed = seed ? seed : 1;
+} // setErrors()
+
+
+void RDSStreamGenerator::restart()
+{
+    for (int k = 0; k < KINDS; k++)
+        _current[k] = 0;
+    _groups = 0;
+    _minuteTime = MINUTE_USEC; // the stream starts with the clock time.
+    _utc = _station->utc;
+    _psSegment = 0;
+    _afPair = 0;
+    _textIndex = 0;
+    _textSegment = 0;
+    _textSent = 0;
+    _textAB = false;
+    _odaCount = 0;
+    _announceODA = false;
+
+    _textSegments = _station->text[0] ? _segments(_station->text[0]) : 0;
+} // restart()
+
+
+/// A text shorter than the RadioText ends with a carriage return, 2B groups have 32 characters.
+byte RDSStreamGenerator::_segments(const char *text)
+{
+    byte limit = _station->versionB ? 32 : 64;
+    byte per = _station->versionB ? 2 : 4;
+    byte len = strlen(text);
+
+    if (len < limit) len++;
+    if (len > limit) len = limit;
+    return (len + per - 1) / per;
+} // _segments()
+
+
+unsigned long RDSStreamGenerator::getGroupCount()
+{
+    return _groups;
+} // getGroupCount()
+
+
+void RDSStreamGenerator::generate(uint16_t *groups, byte *errors, size_t count)
+{
+    for (size_t n = 0; n < count; n++, groups += 4) {
+        _next(groups);
+        byte e = (_corrected ? _errors(groups) : 0);
+        if (errors)
+            errors[n] = e;
+    }
+} // generate()
+
+
+void RDSStreamGenerator::getStation(SIM_STATION *station, word freq, byte rssi, bool stereo, word count)
+{
+    _stationGroups.resize(4 * (size_t)count);
+    _stationErrors.resize(count);
+    if (count)
+        generate(&_stationGroups[0], &_stationErrors[0], count);
+    station->freq = freq;
+    station->rssi = rssi;
+    station->stereo = stereo;
+    station->rdsCount = count;
+    station->rdsGroups = count ? &_stationGroups[0] : NULL;
+    station->rdsErrors = count ? &_stationErrors[0] : NULL;
+} // getStation()
+
+
+void RDSStreamGenerator::_next(uint16_t *g)
+{
+    _groups++;
+    g[0] = _station->pi;
+
+    _minuteTime += GROUP_USEC;
+    if (_minuteTime >= MINUTE_USEC) {
+        _minuteTime -= MINUTE_USEC;
+        if (_station->utc) {
+            _clock(g);
+            return;
+        }
+    }
+
+    if (!_total) {
+        // nothing to send, 15B groups repeat the PI and block 2.
+        g[1] = 0xF800 | _header;
+        g[2] = _station->pi;
+        g[3] = g[1];
+        return;
+    }
+    int pick = 0;
+    for (int k = 0; k < KINDS; k++) {
+        _current[k] += _weight[k];
+        if (_current[k] > _current[pick])
+            pick = k;
+    }
+    _current[pick] -= _total;
+
+    switch (pick) {
+    case KIND_PS:       _ps(g);       break;
+    case KIND_TEXT:     _text(g);     break;
+    case KIND_TMC:      _tmc(g);      break;
+    case KIND_ODA:      _oda(g);      break;
+    default:            _announce(g); break;
+    }
+} // _next()
+
+
+/// 0A groups carry the AF list, 2 codes per group, starting with the number of AFs.
+void RDSStreamGenerator::_ps(uint16_t *g)
+{
+    const RDS_GEN_STATION *st = _station;
+    const char *p = st->ps + 2 * _psSegment;
+
+    g[1] = (st->versionB ? 0x0800 : 0x0000) | _header | 0x0008 | _psSegment; // music
+    g[3] = (p[0] << 8) | p[1];
+    if (st->versionB) {
+        g[2] = st->pi;
+    } else if (!st->afCount) {
+        g[2] = (AF_COUNT_BASE << 8) | AF_FILLER;
+    } else {
+        byte codes[2];
+        for (byte c = 0; c < 2; c++) {
+            byte i = 2 * _afPair + c; // index in the sequence count, AF 0, AF 1, ...
+            if (i == 0)
+                codes[c] = AF_COUNT_BASE + st->afCount;
+            else if (i <= st->afCount)
+                codes[c] = RDS_AF_CODE(st->af[i - 1]);
+            else
+                codes[c] = AF_FILLER;
+        }
+        g[2] = (codes[0] << 8) | codes[1];
+        if (2 * ++_afPair > st->afCount)
+            _afPair = 0;
+    }
+    _psSegment = (_psSegment + 1) & 3;
+} // _ps()
+
+
+void RDSStreamGenerator::_text(uint16_t *g)
+{
+    const RDS_GEN_STATION *st = _station;
+    const char *text = st->text[_textIndex];
+    byte len = strlen(text);
+    byte per = st->versionB ? 2 : 4;
+    char c[4];
+
+    for (byte i = 0; i < per; i++) {
+        byte pos = _textSegment * per + i;
+        c[i] = (pos < len) ? text[pos] : (pos == len) ? '\r' : ' ';
+    }
+    g[1] = (st->versionB ? 0x2800 : 0x2000) | _header | (_textAB ? 0x0010 : 0) | _textSegment;
+    if (st->versionB) {
+        g[2] = st->pi;
+        g[3] = (c[0] << 8) | c[1];
+    } else {
+        g[2] = (c[0] << 8) | c[1];
+        g[3] = (c[2] << 8) | c[3];
+    }
+
+    if (++_textSegment < _textSegments)
+        return;
+    _textSegment = 0;
+    if (++_textSent < (st->textRepeat ? st->textRepeat : 1))
+        return;
+
+    // the next RadioText starts with the other A/B flag.
+    _textSent = 0;
+    _textAB = !_textAB;
+    if (st->text[1])
+        _textIndex ^= 1;
+    _textSegments = _segments(st->text[_textIndex]);
+} // _text()
+
+
+/// MJD, hours and minutes of the UTC and the local offset, see RDSClockTimeDecoder.
+void RDSStreamGenerator::_clock(uint16_t *g)
+{
+    unsigned long mjd = _utc / 86400 + 40587;
+    byte hours = (_utc / 3600) % 24;
+    byte mins = (_utc / 60) % 60;
+    char offset = _station->offset;
+
+    g[1] = 0x4000 | _header | ((mjd >> 15) & 0x03);
+    g[2] = ((mjd & 0x7FFF) << 1) | (hours >> 4);
+    g[3] = ((hours & 0x0F) << 12) | (mins << 6) | ((offset < 0) ? 0x20 | -offset : offset);
+    _utc += 60;
+} // _clock()
+
+
+/// A single group message with the F flag, duration and extent are random.
+void RDSStreamGenerator::_tmc(uint16_t *g)
+{
+    uint32_t r = _random();
+
+    g[1] = 0x8000 | _header | 0x0008 | (r & 0x07);
+    g[2] = ((r >> 3) & 0x3800) | (1 + (r >> 16) % 2047);
+    g[3] = 12000 + (r >> 8) % 4000;
+} // _tmc()
+
+
+void RDSStreamGenerator::_oda(uint16_t *g)
+{
+    byte code = _station->odaGroup;
+
+    g[1] = ((uint16_t)code << 11) | _header | (_odaCount & 0x1F);
+    g[2] = (code & 1) ? _station->pi : _odaCount;
+    g[3] = _odaCount;
+    _odaCount++;
+} // _oda()
+
+
+/// TMC and the ODA are announced in turns, the TMC message has variant 0 with location table 1.
+void RDSStreamGenerator::_announce(uint16_t *g)
+{
+    bool oda = _station->odaAid && (_announceODA || !_station->tmc);
+
+    g[1] = 0x3000 | _header | (oda ? _station->odaGroup : RDS_GROUP_A(8));
+    g[2] = oda ? 0 : 0x0040;
+    g[3] = oda ? _station->odaAid : TMC_AID;
+    _announceODA = !_announceODA;
+} // _announce()
+
+
+/// Every block draws a random number: below _uncorrectable it gets the level 3 and wrong bits,
+/// below _corrected the level 1 or 2.
+byte RDSStreamGenerator::_errors(uint16_t *g)
+{
+    byte errors = 0;
+
+    for (byte b = 0; b < 4; b++) {
+        uint32_t r = _random();
+        byte level = 0;
+        if (r < _uncorrectable) {
+            level = 3;
+            g[b] ^= (uint16_t)(_random() | 1);
+        } else if (r < _corrected) {
+            level = 1 + (r & 1);
+        }
+        errors = (errors << 2) | level;
+    }
+    return errors;
+} // _errors()
+
+
+uint32_t RDSStreamGenerator::_random()
+{
+    _seed ^= _seed << 13;
+    _seed ^= _seed >> 17;
+    _seed ^= _seed << 5;
+    return _seed;
+} // _random()
@@ -0,0 +1,116 @@
+///
+/// \file rdsgen.h
+/// \brief Generator of synthetic RDS group streams for load tests on a Linux host.
+///
+/// \details
+/// The generator sends the groups a station description asks for:
+/// * 0A or 0B groups with the PS name, the AF list of method A in block 3 of the 0A groups,
+/// * 2A or 2B groups with up to two RadioTexts, the A/B flag toggles when the next text starts,
+/// * a 4A group with the clock time at the start of every minute of the stream,
+/// * 8A groups with single group TMC messages of random locations and events,
+/// * groups of an Open Data Application with a counter as data,
+/// * 3A groups announcing TMC and the Open Data Application.
+/// The mix sets how often the kinds of groups are sent relative to each other, they are interleaved evenly.
+/// The groups are 87.719 ms apart like on air for the clock time.
+///
+/// Blocks can be received with errors: a corrected block has the error level 1 or 2 and the right contents,
+/// an uncorrectable block has the level 3 and wrong bits.
+/// The groups are written to an array of 4 blocks per group or become a station of the radio simulator,
+/// so the drivers read them through the emulated registers of the chips.
+/// Nothing is allocated while generating into an array.
+
+#pragma once
+
+#include "Arduino.h"
+#include <vector>
+#include "radiosimulator.h"
+
+/// Description of a generated station.
+typedef struct RDS_GEN_STATION {
+    uint16_t pi;
+    byte pty;
+    bool tp;
+    bool versionB;          ///< 0B and 2B groups instead of 0A and 2A.
+    const char *ps;         ///< Program Service name, 8 characters.
+    const char *text[2];    ///< RadioTexts up to 64 characters, sent in turns. NULL for none.
+    byte textRepeat;        ///< Times a RadioText is sent completely before the next one starts.
+    const word *af;         ///< AF list in 10 kHz units, NULL for none.
+    byte afCount;           ///< Number of AFs, up to 25.
+    unsigned long utc;      ///< Clock time at the start of the stream in seconds since 1.1.1970, 0 = no 4A groups.
+    char offset;            ///< Local time offset in half hours.
+    bool tmc;               ///< Send TMC in 8A groups.
+    uint16_t odaAid;        ///< Application of the ODA groups, 0 = none.
+    byte odaGroup;          ///< Group code of the ODA groups, e.g. RDS_GROUP_A(11).
+} RDS_GEN_STATION;
+
+
+/// Weights of the kinds of groups, 0 = not sent.
+typedef struct RDS_GEN_MIX {
+    byte ps;
+    byte text;
+    byte tmc;
+    byte oda;
+    byte announce;
+} RDS_GEN_MIX;
+
+
+/// Generator of a group stream for a station.
+class RDSStreamGenerator
+{
+public:
+    RDSStreamGenerator(const RDS_GEN_STATION *station); ///< create a generator with the mix 4:4:1:1:1 of the sent kinds.
+
+    void setMix(const RDS_GEN_MIX *mix);  ///< Weights of the kinds, those the station does not send are ignored.
+    /// Part of the blocks with corrected errors and with uncorrectable errors, 0 .. 1.
+    void setErrors(float corrected, float uncorrectable, uint32_t seed = 1);
+    void restart();                        ///< Start the stream again.
+
+    /// The next count groups, 4 blocks each, and the error levels of their blocks, see RDS_BLER(). errors may be NULL.
+    void generate(uint16_t *groups, byte *errors, size_t count);
+
+    /// Fill a station of the radio simulator with the next count groups, sent cyclically by the simulator.
+    /// The groups are kept by the generator until the next call.
+    void getStation(SIM_STATION *station, word freq, byte rssi, bool stereo, word count);
+
+    unsigned long getGroupCount(); ///< Groups generated since the start.
+
+private:
+    enum { KIND_PS, KIND_TEXT, KIND_TMC, KIND_ODA, KIND_ANNOUNCE, KINDS };
+
+    void _next(uint16_t *g);      // the next group without errors.
+    void _ps(uint16_t *g);
+    void _text(uint16_t *g);
+    void _clock(uint16_t *g);
+    void _tmc(uint16_t *g);
+    void _oda(uint16_t *g);
+    void _announce(uint16_t *g);
+    byte _errors(uint16_t *g);    // inject errors into the blocks.
+    byte _segments(const char *text); // 2A or 2B groups of a RadioText.
+    uint32_t _random();
+
+    const RDS_GEN_STATION *_station;
+    uint16_t _header;             ///< TP and PTY bits of block 2.
+    int _weight[KINDS];
+    int _current[KINDS];          ///< Credits of the smooth weighted round robin.
+    int _total;
+
+    uint32_t _corrected;          ///< Thresholds of _random() for the errors.
+    uint32_t _uncorrectable;
+    uint32_t _seed;
+
+    unsigned long _groups;
+    unsigned long _minuteTime;    ///< usec since the start of the minute.
+    unsigned long _utc;
+    byte _psSegment;
+    byte _afPair;
+    byte _textIndex;
+    byte _textSegment;
+    byte _textSegments;           ///< Segments of the current RadioText with the end mark.
+    byte _textSent;               ///< Complete sends of the current RadioText.
+    bool _textAB;
+    byte _odaCount;
+    bool _announceODA;            ///< The next announcement is the one of the ODA.
+
+    std::vector<uint16_t> _stationGroups;
+    std::vector<byte> _stationErrors;
+}; // class RDSStreamGenerator
@@ -0,0 +1,380 @@
+/// \file rdsreplay.cpp
+/// \brief Replay recorded RDS group logs through the RDSParser and measure its throughput.
+///
+/// \details
+/// Build and run on a Linux host:
+///   g++ -O2 -Iextras/host -Isrc extras/host/Arduino.cpp extras/host/rdsreplay.cpp src/RDSParser.cpp src/RDSStationCache.cpp src/RDSBlockFilter.cpp src/RDSCapture.cpp -o rdsreplay
+///   ./rdsreplay [-w groups.bin] [-c capture.rdc] log.txt
+///   ./rdsreplay -b groups.bin
+///   ./rdsreplay capture.rdc
+/// Text logs have a group per line, the 4 blocks in hex:
+/// * RDS Spy logs, "----" marks a block that was not received, a time stamp "@2014/06/29 17:22:01.12" may follow.
+/// * Logs of mpxrds -g with the time in seconds before and the error levels of the blocks after the blocks.
+/// Lines with other contents are skipped. The groups go through a RDSBlockFilter like on a radio.
+/// A binary group log has the 4 blocks of a group as 16 bit little endian words, 8 bytes per group,
+/// that is the layout processGroups() takes. -w writes the groups that passed the filter as binary group log.
+/// Without time stamps the groups are 87.6 ms apart.
+/// Captures of a RDSCaptureWriter are found by their start record, -c writes the log as capture
+/// with the time stamps and error levels and prints its size compared to the log.
+///
+/// The log is decoded group by group first for the stream time until the first PS, RadioText and clock time.
+/// Then the whole log is passed to processGroups() repeatedly for one second, the groups per second are reported.
+
+#include "Arduino.h"
+#include "RDSParser.h"
+#include "RDSBlockFilter.h"
+#include "RDSCapture.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+static const double GROUP_TIME = 0.0876;  ///< Seconds per group at 1187.5 bit/s.
+
+static RDSParser rds;
+static long current;      ///< Index of the group being processed.
+static long psAt = -1;
+static long textAt = -1;
+static long timeAt = -1;
+static char serviceName[10];
+static char radioText[66];
+static unsigned long sink;
+
+// the groups as read from the log, before the filter.
+static std::vector<uint16_t> logBlocks;
+static std::vector<byte> logErrors;
+static std::vector<double> logTimes;
+static FILE *captureFile;
+
+
+static void onPS(const char *name)
+{
+    if ((psAt < 0) && (name[0] != ' ')) {
+        psAt = current;
+        strncpy(serviceName, name, sizeof(serviceName) - 1);
+    }
+} // onPS()
+
+
+static void onText(const char *text)
+{
+    if ((textAt < 0) && text[0]) {
+        textAt = current;
+        strncpy(radioText, text, sizeof(radioText) - 1);
+        radioText[strcspn(radioText, "\r")] = '\0';
+    }
+} // onText()
+
+
+static void onTime(unsigned long utc, char)
+{
+    if (timeAt < 0)
+        timeAt = current;
+    sink += utc;
+} // onTime()
+
+
+static double _seconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+} // _seconds()
+
+
+/// A block in hex or "----", returns the error level 0 or 3 or -1 for another token.
+static int _block(const char *token, uint16_t *block)
+{
+    if (!strcmp(token, "----")) {
+        *block = 0;
+        return 3;
+    }
+    if ((strlen(token) != 4) || !isxdigit(token[0]) || !isxdigit(token[1]) || !isxdigit(token[2]) || !isxdigit(token[3]))
+        return -1;
+    *block = (uint16_t)strtoul(token, NULL, 16);
+    return 0;
+} // _block()
+
+
+/// Parse a line of a text log into the blocks, their error levels and the time, -1 when there is no time.
+static bool _parseLine(char *line, uint16_t *blocks, byte *errors, double *t)
+{
+    char *tokens[16];
+    int count = 0;
+    int levels[4];
+
+    for (char *tok = strtok(line, " \t\r\n"); tok && (count < 16); tok = strtok(NULL, " \t\r\n"))
+        tokens[count++] = tok;
+
+    int first = 0;
+    while ((first + 4 <= count) && (_block(tokens[first], &blocks[0]) < 0))
+        first++;
+    if (first + 4 > count)
+        return false;
+    for (int b = 0; b < 4; b++) {
+        levels[b] = _block(tokens[first + b], &blocks[b]);
+        if (levels[b] < 0)
+            return false;
+    }
+
+    *t = -1;
+    if (first > 0) {
+        // mpxrds -g: time before the blocks.
+        *t = atof(tokens[first - 1]);
+    }
+    int next = first + 4;
+    if ((next < count) && (strlen(tokens[next]) == 4) && (strspn(tokens[next], "0123") == 4)) {
+        // mpxrds -g: error levels after the blocks.
+        for (int b = 0; b < 4; b++)
+            levels[b] = tokens[next][b] - '0';
+    } else if ((next + 1 < count) && (tokens[next][0] == '@')) {
+        // RDS Spy: time stamp of the day.
+        int h, m;
+        double s;
+        if (sscanf(tokens[next + 1], "%d:%d:%lf", &h, &m, &s) == 3)
+            *t = h * 3600.0 + m * 60 + s;
+    }
+    *errors = RDS_BLER(levels[0], levels[1], levels[2], levels[3]) & 0xFF;
+    return true;
+} // _parseLine()
+
+
+static void _logGroup(double t, const uint16_t *blocks, byte errors)
+{
+    logBlocks.insert(logBlocks.end(), blocks, blocks + 4);
+    logErrors.push_back(errors);
+    logTimes.push_back(t);
+} // _logGroup()
+
+
+static bool loadText(FILE *f)
+{
+    char line[256];
+    double start = -1, last = 0;
+
+    while (fgets(line, sizeof(line), f)) {
+        uint16_t b[4];
+        byte errors;
+        double t;
+        if ((line[0] == '<') || (line[0] == '#') || !_parseLine(line, b, &errors, &t))
+            continue;
+        if (t >= 0) {
+            if (start < 0)
+                start = t;
+            if (t < start + last - 43200)
+                t += 86400; // the log runs past midnight.
+            last = t - start;
+        } else {
+            last += GROUP_TIME;
+        }
+        _logGroup(last, b, errors);
+    } // while
+    return true;
+} // loadText()
+
+
+static bool loadBinary(FILE *f)
+{
+    byte raw[8];
+    uint16_t b[4];
+
+    while (fread(raw, sizeof(raw), 1, f) == 1) {
+        for (int n = 0; n < 4; n++)
+            b[n] = raw[2 * n] | (raw[2 * n + 1] << 8);
+        _logGroup(logTimes.size() * GROUP_TIME, b, 0);
+    }
+    return true;
+} // loadBinary()
+
+
+static unsigned long captureStart;
+
+static void onCaptureGroup(unsigned long time, uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4, byte errors)
+{
+    uint16_t b[4] = { block1, block2, block3, block4 };
+    if (logTimes.empty())
+        captureStart = time;
+    _logGroup((time - captureStart) / 1000.0, b, errors);
+} // onCaptureGroup()
+
+
+/// A frequency change is passed on as a group with block 1 = 0 that resets the parser.
+static void onCaptureFrequency(word)
+{
+    uint16_t b[4] = { 0, 0, 0, 0 };
+    _logGroup(logTimes.empty() ? 0 : logTimes.back(), b, 0);
+} // onCaptureFrequency()
+
+
+/// Read the capture in small pieces like from a SD card.
+static bool loadCapture(FILE *f)
+{
+    RDSCaptureReader reader;
+    byte data[64];
+    size_t kept = 0, len;
+
+    reader.attachGroupCallback(onCaptureGroup);
+    reader.attachFrequencyCallback(onCaptureFrequency);
+    while ((len = fread(data + kept, 1, sizeof(data) - kept, f)) > 0) {
+        len += kept;
+        size_t used = reader.decode(data, len);
+        kept = len - used;
+        memmove(data, data + used, kept);
+    }
+    if (!reader.isValid() || kept) {
+        fprintf(stderr, "capture broken after %lu groups\n", reader.getGroupCount());
+        return false;
+    }
+    return true;
+} // loadCapture()
+
+
+static void onCaptureFlush(const byte *data, size_t len)
+{
+    fwrite(data, 1, len, captureFile);
+} // onCaptureFlush()
+
+
+static long writeCapture(const char *name)
+{
+    byte buffer[512];
+    RDSCaptureWriter capture(buffer, sizeof(buffer));
+
+    captureFile = fopen(name, "wb");
+    if (!captureFile)
+        return -1;
+    capture.attachFlushCallback(onCaptureFlush);
+    for (size_t n = 0; n < logTimes.size(); n++) {
+        const uint16_t *b = &logBlocks[4 * n];
+        if (!b[0] && !b[1])
+            capture.setFrequency(0);
+        else
+            capture.put(b[0], b[1], b[2], b[3], logErrors[n], (unsigned long)(logTimes[n] * 1000 + 0.5));
+    }
+    capture.flush();
+    if (fclose(captureFile))
+        return -1;
+    return capture.getSize();
+} // writeCapture()
+
+
+static bool writeBinary(const char *name, const std::vector<uint16_t> &groups)
+{
+    FILE *f = fopen(name, "wb");
+    if (!f)
+        return false;
+    for (size_t n = 0; n < groups.size(); n++) {
+        byte raw[2] = { (byte)(groups[n] & 0xFF), (byte)(groups[n] >> 8) };
+        fwrite(raw, sizeof(raw), 1, f);
+    }
+    return fclose(f) == 0;
+} // writeBinary()
+
+
+static void printFirst(const char *label, long at, const std::vector<double> &times, const char *value)
+{
+    if (at < 0)
+        printf("  %-4s not received\n", label);
+    else
+        printf("  %-4s after %8.2f s, %6ld groups %s\n", label, times[at], at + 1, value);
+} // printFirst()
+
+
+int main(int argc, char *argv[])
+{
+    std::vector<uint16_t> groups;
+    std::vector<double> times;
+    RDSBlockFilter filter;
+    const char *output = NULL;
+    const char *capture = NULL;
+    bool binary = false;
+    int i;
+
+    Serial.setOutput(NULL);
+    for (i = 1; (i < argc - 1) && (argv[i][0] == '-'); i++) {
+        if (!strcmp(argv[i], "-b")) {
+            binary = true;
+        } else if (!strcmp(argv[i], "-w") && (i + 2 < argc)) {
+            output = argv[++i];
+        } else if (!strcmp(argv[i], "-c") && (i + 2 < argc)) {
+            capture = argv[++i];
+        } else {
+            break;
+        }
+    }
+    if (i != argc - 1) {
+        fprintf(stderr, "usage: rdsreplay [-b] [-w groups.bin] [-c capture.rdc] log\n");
+        return 2;
+    }
+    FILE *f = fopen(argv[i], "rb");
+    if (!f) {
+        perror(argv[i]);
+        return 1;
+    }
+    int first = fgetc(f);
+    rewind(f);
+    bool loaded = binary ? loadBinary(f) : (first == 0xF8) ? loadCapture(f) : loadText(f);
+    long logSize = ftell(f);
+    fclose(f);
+    if (!loaded)
+        return 1;
+
+    for (size_t n = 0; n < logTimes.size(); n++) {
+        uint16_t *b = &logBlocks[4 * n];
+        if (!b[0] && !b[1])
+            filter.reset();
+        else if (!filter.filter(&b[0], &b[1], &b[2], &b[3], logErrors[n]))
+            continue;
+        groups.insert(groups.end(), b, b + 4);
+        times.push_back(logTimes[n]);
+    }
+    long count = times.size();
+    printf("%s: %ld groups, %lu dropped by the filter, %.1f s of signal\n", argv[i], count, filter.getDropCount(), count ? times.back() : 0.0);
+    if (output && !writeBinary(output, groups)) {
+        perror(output);
+        return 1;
+    }
+    if (capture) {
+        long size = writeCapture(capture);
+        if (size < 0) {
+            perror(capture);
+            return 1;
+        }
+        printf("  capture %ld bytes, %.2f bytes per group, %.1f times smaller than the log\n",
+               size, (double)size / logTimes.size(), (double)logSize / size);
+    }
+    if (!count)
+        return 0;
+
+    rds.attachServicenNameCallback(onPS);
+    rds.attachTextCallback(onText);
+    rds.attachTimeCallback(onTime);
+    rds.init();
+    for (current = 0; current < count; current++)
+        rds.processGroups(&groups[4 * current], 1);
+    char quoted[80];
+    snprintf(quoted, sizeof(quoted), "'%s'", serviceName);
+    printFirst("PS", psAt, times, quoted);
+    snprintf(quoted, sizeof(quoted), "'%s'", radioText);
+    printFirst("RT", textAt, times, quoted);
+    printFirst("CT", timeAt, times, "");
+
+    // throughput without the callbacks of the first pass.
+    rds.attachServicenNameCallback(NULL);
+    rds.attachTextCallback(NULL);
+    rds.attachTimeCallback(NULL);
+    long passes = 0;
+    double start = _seconds(), elapsed;
+    do {
+        rds.processData(0, 0, 0, 0);
+        rds.processGroups(&groups[0], count);
+        passes++;
+        elapsed = _seconds() - start;
+    } while (elapsed < 1.0);
+    double rate = passes * count / elapsed;
+    printf("  %.1f million groups per second, %.1f ns per group, an hour of signal takes %.2f ms\n",
+           rate / 1e6, 1e9 / rate, 3600 / GROUP_TIME / rate * 1e3);
+    return sink == 1; // keep the time callback from being optimized away
+} // main()
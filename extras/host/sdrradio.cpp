@@ -0,0 +1,721 @@
+///
+/// \file sdrradio.cpp
+/// \brief Implementation of the RADIO interface on recorded IQ captures.
+///
+/// \details
+/// Signal path of a channel at 2.4 MHz capture rate:
+///   IQ 2.4 MHz -> x exp(-j 2 pi offset t) -> channel filter +-100 kHz, decimation by 10 -> 240 kHz
+///   -> FM discriminator -> MPX 240 kHz -> RDSDemodulator, pilot and noise measurement
+
+#include "sdrradio.h"
+#include "hostdsp.h"
+
+#include <atomic>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static const unsigned long CHANNEL_RATE = 240000; ///< Minimal sample rate of a channel.
+static const unsigned long CHANNEL_WIDTH = 100000; ///< Half bandwidth of a channel in Hz.
+static const double DEVIATION = 75000.0;          ///< Peak deviation, MPX 1.0.
+static const double AUDIO_BANDWIDTH = 15000.0;    ///< Bandwidth of the mono audio for the SNR.
+static const float PILOT_LEVEL = 0.02f;           ///< Minimal amplitude of the pilot, it is sent with about 0.09.
+static const double FM_THRESHOLD = 10.0;          ///< C/N in dB below which the discriminator output is mostly clicks.
+
+/// Frequencies of the pilot and of the noise measurement in the MPX signal.
+static const double BIN_FREQS[4] = { 19000, 65000, 68000, 71000 };
+
+static const int SPECTRUM_BIN = 10000; ///< Maximal bin width of the power spectrum in Hz.
+
+
+// ----- capture -----
+
+SDRCapture::SDRCapture()
+{
+    _data = NULL;
+    _bytes = 0;
+    _mapped = false;
+    _length = 0;
+} // SDRCapture()
+
+
+SDRCapture::~SDRCapture()
+{
+    close();
+} // ~SDRCapture()
+
+
+bool SDRCapture::open(const char *file, SDR_FORMAT format, unsigned long rate, unsigned long center)
+{
+    struct stat st;
+    int fd = ::open(file, O_RDONLY);
+
+    if (fd < 0)
+        return (false);
+    if ((fstat(fd, &st) < 0) || (st.st_size <= 0)) {
+        ::close(fd);
+        return (false);
+    }
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+        return (false);
+    if (!open(data, st.st_size, format, rate, center)) {
+        munmap(data, st.st_size);
+        return (false);
+    }
+    _mapped = true;
+    return (true);
+} // open()
+
+
+bool SDRCapture::open(const void *data, size_t bytes, SDR_FORMAT format, unsigned long rate, unsigned long center)
+{
+    static const int SIZES[] = { 2, 2, 4, 8 };
+
+    close();
+    _format = format;
+    _sampleSize = SIZES[format];
+    _rate = rate;
+    _center = center;
+    _length = bytes / _sampleSize;
+    if (!_length || !rate)
+        return (false);
+    _data = (const byte *)data;
+    _bytes = bytes;
+    return (true);
+} // open()
+
+
+void SDRCapture::close()
+{
+    if (_mapped)
+        munmap((void *)_data, _bytes);
+    _data = NULL;
+    _bytes = 0;
+    _mapped = false;
+    _length = 0;
+} // close()
+
+
+unsigned long SDRCapture::getRate()        { return (_rate); }
+unsigned long SDRCapture::getCenter()      { return (_center); }
+unsigned long long SDRCapture::getLength() { return (_length); }
+
+
+void SDRCapture::read(unsigned long long pos, int count, float *i, float *q)
+{
+    pos %= _length;
+    while (count > 0) {
+        int n = count;
+        if (pos + n > _length)
+            n = (int)(_length - pos);
+
+        const byte *p = _data + pos * _sampleSize;
+        switch (_format) {
+        case SDR_CU8:
+            for (int k = 0; k < n; k++) {
+                i[k] = (p[2 * k] - 127.5f) * (1.0f / 128);
+                q[k] = (p[2 * k + 1] - 127.5f) * (1.0f / 128);
+            }
+            break;
+        case SDR_CS8:
+            for (int k = 0; k < n; k++) {
+                i[k] = (int8_t)p[2 * k] * (1.0f / 128);
+                q[k] = (int8_t)p[2 * k + 1] * (1.0f / 128);
+            }
+            break;
+        case SDR_CS16:
+            for (int k = 0; k < n; k++) {
+                int16_t v[2];
+                memcpy(v, p + 4 * k, 4);
+                i[k] = v[0] * (1.0f / 32768);
+                q[k] = v[1] * (1.0f / 32768);
+            }
+            break;
+        case SDR_CF32:
+            for (int k = 0; k < n; k++) {
+                memcpy(&i[k], p + 8 * k, 4);
+                memcpy(&q[k], p + 8 * k + 4, 4);
+            }
+            break;
+        }
+        i += n;
+        q += n;
+        count -= n;
+        pos = 0;
+    }
+} // read()
+
+
+// ----- channel -----
+
+SDRChannel::SDRChannel(SDRCapture *capture, unsigned long freq, unsigned long long pos)
+{
+    unsigned long rate = capture->getRate();
+    long offset = (long)freq - (long)capture->getCenter();
+
+    _capture = capture;
+    _pos = pos;
+    _decimation = (rate > CHANNEL_RATE) ? (int)(rate / CHANNEL_RATE) : 1;
+    _rate = rate / _decimation;
+    _inside = (_rate >= 150000) && ((unsigned long)labs(offset) + CHANNEL_WIDTH <= rate / 2);
+
+    _loLen = dspOscillator(-offset, rate, 1 << 16, CHUNK, &_loCos, &_loSin);
+    _lo = 0;
+
+    // Windowed sinc with a Hamming window, the stop band starts where it would alias into the channel.
+    double stop = (double)_rate - CHANNEL_WIDTH;
+    _tapCount = (int)(3.3 * rate / (stop - CHANNEL_WIDTH)) | 1;
+    if (_tapCount <= _decimation)
+        _tapCount = _decimation + 1;
+    _tapPad = (_tapCount + 7) & ~7;
+    _taps = dspFloats(_tapPad);
+    double fc = (CHANNEL_WIDTH + stop) / 2 / rate;
+    double sum = 0;
+    for (int j = 0; j < _tapCount; j++) {
+        double x = j - (_tapCount - 1) / 2.0;
+        double sinc = (x == 0) ? 2 * fc : sin(2 * M_PI * fc * x) / (M_PI * x);
+        _taps[j] = (float)(sinc * (0.54 - 0.46 * cos(2 * M_PI * j / (_tapCount - 1))));
+        sum += _taps[j];
+    }
+    for (int j = 0; j < _tapCount; j++)
+        _taps[j] /= sum;
+
+    _inI = dspFloats(CHUNK);
+    _inQ = dspFloats(CHUNK);
+    _mixI = dspFloats(_tapPad + CHUNK);
+    _mixQ = dspFloats(_tapPad + CHUNK);
+    _mixCount = 0;
+    _mixPos = 0;
+    int outputs = CHUNK / _decimation + 8;
+    _chI = dspFloats(outputs);
+    _chQ = dspFloats(outputs);
+    _mpx = dspFloats(outputs);
+    _chCount = 0;
+    _lastI = _lastQ = 0;
+
+    _rds = new RDSDemodulator(_rate);
+
+    for (int b = 0; b < BINS; b++) {
+        _binLen[b] = dspOscillator(-BIN_FREQS[b], _rate, 1 << 16, outputs, &_binCos[b], &_binSin[b]);
+        _binPos[b] = 0;
+        _binRe[b] = _binIm[b] = 0;
+    }
+    _powerSum = _power2Sum = 0;
+    _measureCount = 0;
+    _measureLength = _rate * MEASURE_MS / 1000;
+    _power = _snr = 0;
+    _stereo = _measured = false;
+} // SDRChannel()
+
+
+SDRChannel::~SDRChannel()
+{
+    free(_loCos);
+    free(_loSin);
+    free(_taps);
+    free(_inI);
+    free(_inQ);
+    free(_mixI);
+    free(_mixQ);
+    free(_chI);
+    free(_chQ);
+    free(_mpx);
+    for (int b = 0; b < BINS; b++) {
+        free(_binCos[b]);
+        free(_binSin[b]);
+    }
+    delete _rds;
+} // ~SDRChannel()
+
+
+void SDRChannel::attachReceiver(RDSGroupReceiver *receiver)
+{
+    _rds->attachReceiver(receiver);
+} // attachReceiver()
+
+
+void SDRChannel::process(unsigned long long pos)
+{
+    if (!_inside || (pos <= _pos)) {
+        _pos = (pos > _pos) ? pos : _pos;
+        return;
+    }
+    // Callers that paused for a long time get the last second only.
+    if (pos - _pos > _capture->getRate())
+        _pos = pos - _capture->getRate();
+
+    while (_pos < pos) {
+        int n = (pos - _pos < (unsigned long long)CHUNK) ? (int)(pos - _pos) : CHUNK;
+        _capture->read(_pos, n, _inI, _inQ);
+        _pos += n;
+
+        // Move the channel to zero, the loop is vectorized by the compiler.
+        const float *__restrict loCos = _loCos + _lo;
+        const float *__restrict loSin = _loSin + _lo;
+        const float *__restrict inI = _inI;
+        const float *__restrict inQ = _inQ;
+        float *__restrict mixI = _mixI + _mixCount;
+        float *__restrict mixQ = _mixQ + _mixCount;
+        for (int k = 0; k < n; k++) {
+            mixI[k] = inI[k] * loCos[k] - inQ[k] * loSin[k];
+            mixQ[k] = inI[k] * loSin[k] + inQ[k] * loCos[k];
+        }
+        _lo = (_lo + n) % _loLen;
+        _mixCount += n;
+
+        // Channel filter at the decimated rate only.
+        while (_mixPos + _tapCount <= _mixCount) {
+            dspDot2(_taps, _mixI + _mixPos, _mixQ + _mixPos, _tapPad, &_chI[_chCount], &_chQ[_chCount]);
+            _chCount++;
+            _mixPos += _decimation;
+        }
+        int keep = _mixCount - _mixPos;
+        memmove(_mixI, _mixI + _mixPos, keep * sizeof(float));
+        memmove(_mixQ, _mixQ + _mixPos, keep * sizeof(float));
+        _mixCount = keep;
+        _mixPos = 0;
+
+        // The discriminator takes multiples of 4 samples, the rest waits for the next chunk.
+        int m = _chCount & ~3;
+        dspDiscriminate(_chI, _chQ, m, &_lastI, &_lastQ, (float)(_rate / (2 * M_PI * DEVIATION)), _mpx);
+        _rds->process(_mpx, m);
+
+        // Measurements over MEASURE_MS of the channel.
+        for (int k = 0; k < m;) {
+            int len = m - k;
+            if (len > _measureLength - _measureCount)
+                len = _measureLength - _measureCount;
+            double power = 0, power2 = 0;
+            for (int j = k; j < k + len; j++) {
+                float p = _chI[j] * _chI[j] + _chQ[j] * _chQ[j];
+                power += p;
+                power2 += p * p;
+            }
+            _powerSum += power;
+            _power2Sum += power2;
+            for (int b = 0; b < BINS; b++) {
+                const float *c = _binCos[b] + _binPos[b];
+                const float *s = _binSin[b] + _binPos[b];
+                float re = 0, im = 0;
+                for (int j = 0; j < len; j++) {
+                    re += _mpx[k + j] * c[j];
+                    im += _mpx[k + j] * s[j];
+                }
+                _binRe[b] += re;
+                _binIm[b] += im;
+                _binPos[b] = (_binPos[b] + len) % _binLen[b];
+            }
+            _measureCount += len;
+            k += len;
+
+            if (_measureCount == _measureLength) {
+                // The FM noise density grows with f^2, the bins above the RDS carrier give its scale.
+                double n = _measureLength;
+                double scale = 0;
+                for (int b = 1; b < BINS; b++) {
+                    double density = 2 * (_binRe[b] * _binRe[b] + _binIm[b] * _binIm[b]) / (n * _rate);
+                    scale += density / (BIN_FREQS[b] * BIN_FREQS[b]) / (BINS - 1);
+                }
+                double audioNoise = scale * AUDIO_BANDWIDTH * AUDIO_BANDWIDTH * AUDIO_BANDWIDTH / 3;
+                _snr = (audioNoise > 0) ? (float)(10 * log10(0.5 / audioNoise)) : 99;
+
+                // Below the FM threshold the noise is white, the SNR is the C/N from the moments of the envelope.
+                double m2 = _powerSum / n, m4 = _power2Sum / n;
+                double carrier = (2 * m2 * m2 > m4) ? sqrt(2 * m2 * m2 - m4) : 0;
+                double cn = (m2 > carrier) ? 10 * log10(carrier / (m2 - carrier) + 1e-10) : 99;
+                if (cn < FM_THRESHOLD)
+                    _snr = (float)cn;
+                _snr = (_snr < 0) ? 0 : (_snr > 99) ? 99 : _snr;
+
+                double pilot = _binRe[0] * _binRe[0] + _binIm[0] * _binIm[0];
+                double pilotNoise = scale * BIN_FREQS[0] * BIN_FREQS[0] * n * _rate / 2;
+                _stereo = (2 * sqrt(pilot) / n > PILOT_LEVEL) && (pilot > 10 * pilotNoise);
+
+                _power = (float)(_powerSum / n);
+                _measured = true;
+                _powerSum = _power2Sum = 0;
+                _measureCount = 0;
+                for (int b = 0; b < BINS; b++)
+                    _binRe[b] = _binIm[b] = 0;
+            }
+        }
+        memmove(_chI, _chI + m, (_chCount - m) * sizeof(float));
+        memmove(_chQ, _chQ + m, (_chCount - m) * sizeof(float));
+        _chCount -= m;
+    }
+} // process()
+
+
+bool SDRChannel::isInside()   { return (_inside); }
+bool SDRChannel::isMeasured() { return (_measured); }
+float SDRChannel::getPower()  { return (_power); }
+float SDRChannel::getSnr()    { return (_snr); }
+bool SDRChannel::isStereo()   { return (_stereo); }
+bool SDRChannel::isRdsSync()  { return (_rds->isSynced()); }
+
+
+// ----- radio -----
+
+/// In place radix 2 FFT, n is a power of 2.
+static void _fft(float *re, float *im, int n)
+{
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+    for (int len = 2; len <= n; len <<= 1) {
+        double a = -2 * M_PI / len;
+        float wr = (float)cos(a), wi = (float)sin(a);
+        for (int i = 0; i < n; i += len) {
+            float cr = 1, ci = 0;
+            for (int k = 0; k < len / 2; k++) {
+                int u = i + k, v = u + len / 2;
+                float xr = re[v] * cr - im[v] * ci;
+                float xi = re[v] * ci + im[v] * cr;
+                re[v] = re[u] - xr;
+                im[v] = im[u] - xi;
+                re[u] += xr;
+                im[u] += xi;
+                float t = cr * wr - ci * wi;
+                ci = cr * wi + ci * wr;
+                cr = t;
+            }
+        }
+    }
+} // _fft()
+
+
+SDRRadio::SDRRadio(SDRCapture *capture) : RADIO(NULL)
+{
+    _capture = capture;
+    _channel = NULL;
+    _startTime = 0;
+    _rssiOffset = 100;
+    _seekThreshold = 30;
+    _seeking = false;
+    _groupHead = _groupCount = 0;
+} // SDRRadio()
+
+
+SDRRadio::~SDRRadio()
+{
+    delete _channel;
+} // ~SDRRadio()
+
+
+/// Start the playback of the capture and tune to the channel in its center.
+bool SDRRadio::init()
+{
+    _startTime = micros();
+    setBand(RADIO_BAND_FM);
+    RADIO_FREQ center = (RADIO_FREQ)((_capture->getCenter() / 10000 + _freqSteps / 2) / _freqSteps * _freqSteps);
+    setFrequency(center);
+    return (_capture->getLength() > 0);
+} // init()
+
+
+void SDRRadio::term()
+{
+    delete _channel;
+    _channel = NULL;
+} // term()
+
+
+/// The channels of the FM bands are 100 kHz apart.
+void SDRRadio::setBand(RADIO_BAND newBand)
+{
+    RADIO::setBand(newBand);
+    _freqSteps = 10;
+} // setBand()
+
+
+void SDRRadio::setRssiOffset(int offset)
+{
+    _rssiOffset = offset;
+} // setRssiOffset()
+
+
+void SDRRadio::setSeekThreshold(uint8_t rssi)
+{
+    _seekThreshold = rssi;
+} // setSeekThreshold()
+
+
+unsigned long long SDRRadio::_position()
+{
+    return ((unsigned long long)(micros() - _startTime) * _capture->getRate() / 1000000);
+} // _position()
+
+
+uint8_t SDRRadio::_rssi(float power)
+{
+    if (power <= 0)
+        return (0);
+    int rssi = (int)lround(10 * log10(power)) + _rssiOffset;
+    return ((rssi < 0) ? 0 : (rssi > 127) ? 127 : rssi);
+} // _rssi()
+
+
+void SDRRadio::_openChannel(RADIO_FREQ freq, unsigned long long pos)
+{
+    delete _channel;
+    _channel = new SDRChannel(_capture, freq * 10000UL, pos);
+    _channel->attachReceiver(this);
+    _groupHead = _groupCount = 0;
+} // _openChannel()
+
+
+bool SDRRadio::setFrequency(RADIO_FREQ newF)
+{
+    return (startFrequency(newF) && _waitTune());
+} // setFrequency()
+
+
+bool SDRRadio::seekUp(bool)
+{
+    return (startSeek(true) && _waitTune());
+} // seekUp()
+
+
+bool SDRRadio::seekDown(bool)
+{
+    return (startSeek(false) && _waitTune());
+} // seekDown()
+
+
+/// Start tuning, the channel is demodulated from now on and measured when the tune time has passed.
+bool SDRRadio::startFrequency(RADIO_FREQ newF)
+{
+    RADIO::setFrequency(newF);
+    _seeking = false;
+    _openChannel(_freq, _position());
+    _tuneStart(TUNE_WAIT_STC, TUNE_TIME);
+    return (true);
+} // startFrequency()
+
+
+/// Start a seek, the next station is found in the power spectrum and reached after the modeled seek time.
+/// Like the chips the seek checks the SNR of a peak before it stops and it stops at the band limit.
+bool SDRRadio::startSeek(bool seekUp)
+{
+    int count = (_freqHigh - _freqLow) / _freqSteps + 1;
+    std::vector<uint8_t> rssi(count);
+    int start = (_freq - _freqLow) / _freqSteps;
+    int n = start;
+
+    _spectrum(&rssi[0], count);
+    _seekFound = false;
+    do {
+        n += seekUp ? 1 : -1;
+        _seekFound = (n >= 0) && (n < count) && _isPeak(&rssi[0], count, n) && _isStation(_freqLow + n * _freqSteps);
+    } while (!_seekFound && (n > 0) && (n < count - 1));
+    if (n < 0)
+        n = 0;
+    else if (n >= count)
+        n = count - 1;
+
+    _seekFreq = _freqLow + n * _freqSteps;
+    _seeking = true;
+    _tuneStart(TUNE_WAIT_STC, abs(n - start) * SEEK_STEP_TIME + TUNE_TIME);
+    return (true);
+} // startSeek()
+
+
+bool SDRRadio::pollTune()
+{
+    if (_tuneState == TUNE_IDLE)
+        return (true);
+    if (!_tuneDue())
+        return (false);
+
+    unsigned long long pos = _position();
+    if (_seeking) {
+        // The chip listens to the station for the tune time at the end of the seek.
+        unsigned long long settle = (unsigned long long)TUNE_TIME * _capture->getRate() / 1000;
+        _freq = _seekFreq;
+        _openChannel(_freq, (pos > settle) ? pos - settle : 0);
+    }
+    _channel->process(pos);
+    _tuneDone(_seeking ? _seekFound : _channel->isInside());
+    _seeking = false;
+    return (true);
+} // pollTune()
+
+
+bool SDRRadio::_isPeak(const uint8_t *rssi, int count, int n)
+{
+    return ((rssi[n] >= _seekThreshold) && ((n == 0) || (rssi[n] >= rssi[n - 1]))
+            && ((n == count - 1) || (rssi[n] > rssi[n + 1])));
+} // _isPeak()
+
+
+/// Measure the SNR of a channel over the tune time like the seek of a chip.
+bool SDRRadio::_isStation(RADIO_FREQ freq)
+{
+    unsigned long long pos = _position();
+    SDRChannel channel(_capture, freq * 10000UL, pos);
+    channel.process(pos + (unsigned long long)TUNE_TIME * _capture->getRate() / 1000);
+    return (channel.isMeasured() && (channel.getSnr() >= STATION_SNR));
+} // _isStation()
+
+
+/// Welch power spectrum over SPECTRUM_TIME msec, the power of a channel is the sum of its bins.
+void SDRRadio::_spectrum(uint8_t *rssi, int count)
+{
+    unsigned long rate = _capture->getRate();
+    int size = 16;
+    while ((unsigned long)size * SPECTRUM_BIN < rate)
+        size <<= 1;
+    int frames = (int)((unsigned long long)SPECTRUM_TIME * rate / 1000 / size);
+    if (frames < 1)
+        frames = 1;
+
+    std::vector<float> window(size), re(size), im(size);
+    std::vector<double> psd(size, 0);
+    double windowPower = 0;
+    for (int k = 0; k < size; k++) {
+        window[k] = (float)(0.5 - 0.5 * cos(2 * M_PI * k / size));
+        windowPower += window[k] * window[k];
+    }
+    unsigned long long pos = _position();
+    for (int f = 0; f < frames; f++) {
+        _capture->read(pos + (unsigned long long)f * size, size, &re[0], &im[0]);
+        for (int k = 0; k < size; k++) {
+            re[k] *= window[k];
+            im[k] *= window[k];
+        }
+        _fft(&re[0], &im[0], size);
+        for (int k = 0; k < size; k++)
+            psd[k] += re[k] * re[k] + im[k] * im[k];
+    }
+
+    double binWidth = (double)rate / size;
+    for (int n = 0; n < count; n++) {
+        long offset = (long)(_freqLow + n * _freqSteps) * 10000L - (long)_capture->getCenter();
+        rssi[n] = 0;
+        if ((unsigned long)labs(offset) + CHANNEL_WIDTH > rate / 2)
+            continue;
+        double power = 0;
+        int first = (int)ceil((offset - (double)CHANNEL_WIDTH) / binWidth);
+        int last = (int)floor((offset + (double)CHANNEL_WIDTH) / binWidth);
+        for (int k = first; k <= last; k++)
+            power += psd[(k + size) % size];
+        rssi[n] = _rssi((float)(power / ((double)frames * size * windowPower)));
+    }
+} // _spectrum()
+
+
+bool SDRRadio::getRadioInfo(RADIO_INFO *info)
+{
+    RADIO::getRadioInfo(info);
+    if (!_channel)
+        return (false);
+
+    _channel->process(_position());
+    info->active = true;
+    if (_channel->isMeasured()) {
+        info->rssi = _rssi(_channel->getPower());
+        info->snr = (uint8_t)_channel->getSnr();
+        info->stereo = _channel->isStereo() && !_mono;
+        info->tuned = (_tuneState == TUNE_IDLE) && (info->snr >= STATION_SNR);
+    }
+    info->rds = _channel->isRdsSync();
+    return (true);
+} // getRadioInfo()
+
+
+/// Deliver the groups decoded since the last call.
+bool SDRRadio::checkRDS()
+{
+    if (!_channel || (_tuneState != TUNE_IDLE))
+        return (false);
+
+    _channel->process(_position());
+    if (!_groupCount)
+        return (false);
+    while (_groupCount) {
+        byte n = (byte)((_groupHead + GROUPS - _groupCount) % GROUPS);
+        _groupCount--;
+        _receiveRDS(_groups[n][0], _groups[n][1], _groups[n][2], _groups[n][3], _errors[n]);
+    }
+    return (true);
+} // checkRDS()
+
+
+/// Queue a group of the tuned channel, the oldest is dropped when checkRDS() is not called often enough.
+void SDRRadio::receiveGroup(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4, byte errors)
+{
+    _groups[_groupHead][0] = block1;
+    _groups[_groupHead][1] = block2;
+    _groups[_groupHead][2] = block3;
+    _groups[_groupHead][3] = block4;
+    _errors[_groupHead] = errors;
+    _groupHead = (_groupHead + 1) % GROUPS;
+    if (_groupCount < GROUPS)
+        _groupCount++;
+} // receiveGroup()
+
+
+/// The channels that a seek would stop on are demodulated on the threads in parallel.
+uint8_t SDRRadio::sweep(RADIO_STATION *stations, uint8_t maxStations, word dwellTime, uint8_t minRssi, int threads)
+{
+    int count = (_freqHigh - _freqLow) / _freqSteps + 1;
+    std::vector<uint8_t> rssi(count);
+    std::vector<int> candidates;
+
+    _spectrum(&rssi[0], count);
+    for (int n = 0; n < count; n++) {
+        if (_isPeak(&rssi[0], count, n) && (rssi[n] >= minRssi))
+            candidates.push_back(n);
+    }
+
+    std::vector<RADIO_STATION> found(candidates.size());
+    std::vector<char> isStation(candidates.size(), false); // not vector<bool>, the threads write neighbours
+    std::atomic<size_t> next(0);
+    unsigned long long pos = _position();
+    unsigned long long end = pos + (unsigned long long)dwellTime * _capture->getRate() / 1000;
+
+    auto worker = [&]() {
+        size_t c;
+        while ((c = next++) < candidates.size()) {
+            RADIO_FREQ freq = _freqLow + candidates[c] * _freqSteps;
+            SDRChannel channel(_capture, freq * 10000UL, pos);
+            channel.process(end);
+            uint8_t r = _rssi(channel.getPower());
+            found[c].freq = freq;
+            found[c].rssi = r;
+            found[c].stereo = channel.isStereo();
+            found[c].rdsSync = channel.isRdsSync();
+            isStation[c] = channel.isMeasured() && (channel.getSnr() >= STATION_SNR) && (r >= minRssi);
+        }
+    };
+
+    if (threads <= 0)
+        threads = std::thread::hardware_concurrency();
+    if (threads < 1)
+        threads = 1;
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++)
+        pool.push_back(std::thread(worker));
+    worker();
+    for (size_t t = 0; t < pool.size(); t++)
+        pool[t].join();
+
+    uint8_t stationCount = 0;
+    for (size_t c = 0; (c < candidates.size()) && (stationCount < maxStations); c++) {
+        if (isStation[c])
+            stations[stationCount++] = found[c];
+    }
+    return (stationCount);
+} // sweep()
@@ -0,0 +1,172 @@
+///
+/// \file sdrradio.h
+/// \brief The RADIO interface on recorded wideband IQ captures on a Linux host.
+///
+/// \details
+/// SDRRadio receives the FM stations inside an IQ capture like a radio chip, without hardware:
+/// * setFrequency() selects a channel of the capture: it is mixed to zero, filtered and decimated to about 240 kHz.
+/// * The FM discriminator gives the MPX signal, RDSDemodulator decodes the RDS groups from it,
+///   they are delivered by checkRDS() through attachReceiveRDS() with their block error levels.
+/// * getRadioInfo() measures the RSSI from the channel power, the SNR from the noise of the MPX signal above 60 kHz
+///   or, below the FM threshold, from the fluctuation of the envelope, and the stereo pilot from its 19 kHz component.
+/// * Seeks look at the power spectrum of the capture, tunes and seeks take the modeled time of a chip.
+/// * sweep() measures all channels of the band at once on several threads.
+///
+/// The capture is played cyclically against micros(), use hostUseVirtualClock(true) to run faster than real time.
+/// The RSSI is 10 * log10(channel power) + offset, the power is 1.0 for a full scale signal, see setRssiOffset().
+
+#pragma once
+
+#include "radio.h"
+#include "rdsdemod.h"
+
+/// Sample formats of IQ captures, interleaved I and Q.
+enum SDR_FORMAT {
+    SDR_CU8,   ///< unsigned 8 bit, 127.5 is zero, e.g. rtl_sdr.
+    SDR_CS8,   ///< signed 8 bit, e.g. hackrf_transfer.
+    SDR_CS16,  ///< signed 16 bit little endian.
+    SDR_CF32   ///< float.
+};
+
+
+/// An IQ capture in memory or mapped from a file.
+class SDRCapture
+{
+public:
+    SDRCapture();
+    ~SDRCapture();
+
+    bool open(const char *file, SDR_FORMAT format, unsigned long rate, unsigned long center); ///< Map a capture file, rate and center in Hz.
+    bool open(const void *data, size_t bytes, SDR_FORMAT format, unsigned long rate, unsigned long center); ///< Use a capture in memory.
+    void close();
+
+    unsigned long getRate();       ///< Samples per second.
+    unsigned long getCenter();     ///< Center frequency in Hz.
+    unsigned long long getLength(); ///< Number of samples.
+
+    /// Read count samples from pos on as floats, the capture repeats after its end.
+    void read(unsigned long long pos, int count, float *i, float *q);
+
+private:
+    const byte *_data;
+    size_t _bytes;
+    bool _mapped;
+    SDR_FORMAT _format;
+    int _sampleSize;
+    unsigned long _rate;
+    unsigned long _center;
+    unsigned long long _length;
+}; // class SDRCapture
+
+
+/// One FM channel of a capture: channel filter, FM discriminator, RDS and the measurements.
+class SDRChannel
+{
+public:
+    SDRChannel(SDRCapture *capture, unsigned long freq, unsigned long long pos); ///< Channel at freq Hz, starting at sample pos.
+    ~SDRChannel();
+
+    void attachReceiver(RDSGroupReceiver *receiver); ///< Register the receiver of the RDS groups.
+    void process(unsigned long long pos);   ///< Demodulate the capture up to sample pos.
+
+    bool isInside();      ///< The channel is inside the bandwidth of the capture.
+    bool isMeasured();    ///< A measurement is complete.
+    float getPower();     ///< Mean power of the channel in the last measurement, 1.0 = full scale.
+    float getSnr();       ///< Estimated SNR of the mono audio in dB.
+    bool isStereo();      ///< The stereo pilot is present.
+    bool isRdsSync();     ///< The RDS demodulator is in sync.
+
+private:
+    static const int CHUNK = 4096;       ///< Capture samples read at once.
+    static const int MEASURE_MS = 40;    ///< Length of a measurement.
+    static const int BINS = 4;           ///< Frequencies measured in the MPX signal: the pilot and 3 noise bins.
+
+    SDRCapture *_capture;
+    bool _inside;
+    unsigned long long _pos;   ///< Next sample of the capture.
+    int _decimation;
+    unsigned long _rate;       ///< Channel sample rate.
+
+    float *_loCos, *_loSin;    ///< Oscillator moving the channel to zero.
+    int _loLen, _lo;
+    float *_inI, *_inQ;        ///< Capture samples of a chunk.
+    float *_taps;              ///< Channel filter, reversed and padded to a multiple of 8.
+    int _tapCount, _tapPad;
+    float *_mixI, *_mixQ;      ///< Mixed samples waiting for the filter.
+    int _mixCount, _mixPos;
+    float *_chI, *_chQ;        ///< Channel samples of a chunk.
+    int _chCount;              ///< Samples in _chI and _chQ.
+    float *_mpx;               ///< MPX samples of a chunk.
+    float _lastI, _lastQ;      ///< Last channel sample for the discriminator.
+
+    RDSDemodulator *_rds;
+
+    // measurements
+    float *_binCos[BINS], *_binSin[BINS];
+    int _binLen[BINS], _binPos[BINS];
+    double _binRe[BINS], _binIm[BINS];
+    double _powerSum, _power2Sum; ///< Sums of the power and its square for the C/N.
+    int _measureCount, _measureLength;
+    float _power, _snr;
+    bool _stereo, _measured;
+}; // class SDRChannel
+
+
+/// The RADIO interface on an IQ capture.
+class SDRRadio : public RADIO, public RDSGroupReceiver
+{
+public:
+    SDRRadio(SDRCapture *capture);
+    ~SDRRadio();
+
+    bool init();
+    void term();
+
+    void setBand(RADIO_BAND newBand);
+    bool setFrequency(RADIO_FREQ newF);
+    bool seekUp(bool toNextSender = true);
+    bool seekDown(bool toNextSender = true);
+
+    bool startFrequency(RADIO_FREQ newF);
+    bool startSeek(bool seekUp = true);
+    bool pollTune();
+
+    bool checkRDS();
+    bool getRadioInfo(RADIO_INFO *info);
+
+    void setRssiOffset(int offset);      ///< dB added to the channel power for the RSSI, default 100.
+    void setSeekThreshold(uint8_t rssi); ///< Minimal RSSI of a station for seeks, default 30.
+
+    /// Measure every channel of the band on dwellTime msec of the capture, starting at the current time, on threads.
+    /// Returns the number of stations found like scan(), without spending modeled time.
+    uint8_t sweep(RADIO_STATION *stations, uint8_t maxStations, word dwellTime, uint8_t minRssi = 0, int threads = 0);
+
+    void receiveGroup(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4, byte errors);
+
+private:
+    static const word TUNE_TIME = 60;       ///< Modeled time of a tune in msec.
+    static const word SEEK_STEP_TIME = 20;  ///< Modeled time per channel of a seek in msec.
+    static const word SPECTRUM_TIME = 20;   ///< Time in msec of the capture looked at by a seek.
+    static const byte STATION_SNR = 10;     ///< Minimal SNR of a tuned station.
+    static const byte GROUPS = 32;          ///< RDS groups waiting for checkRDS().
+
+    unsigned long long _position();        ///< Sample of the capture at the current time.
+    void _openChannel(RADIO_FREQ freq, unsigned long long pos);
+    uint8_t _rssi(float power);
+    void _spectrum(uint8_t *rssi, int count); ///< RSSI of the channels of the band from the power spectrum.
+    bool _isPeak(const uint8_t *rssi, int count, int n); ///< Channel n is a peak of the spectrum for a seek.
+    bool _isStation(RADIO_FREQ freq);     ///< The SNR of the channel is good enough for a seek to stop.
+
+    SDRCapture *_capture;
+    SDRChannel *_channel;
+    unsigned long _startTime;    ///< micros() at the start of the capture.
+    int _rssiOffset;
+    uint8_t _seekThreshold;
+    bool _seeking;
+    RADIO_FREQ _seekFreq;        ///< Frequency the running seek ends on.
+    bool _seekFound;
+
+    uint16_t _groups[GROUPS][4];
+    byte _errors[GROUPS];
+    byte _groupHead, _groupCount;
+}; // class SDRRadio
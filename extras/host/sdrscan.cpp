@@ -0,0 +1,283 @@
+/// \file sdrscan.cpp
+/// \brief Scan and receive RDS on recorded IQ captures with the SDRRadio backend.
+///
+/// \details
+/// Build and run on a Linux host:
+///   g++ -O2 -pthread -Iextras/host -Isrc extras/host/Arduino.cpp extras/host/rdsdemod.cpp extras/host/mpxsynth.cpp extras/host/sdrradio.cpp extras/host/sdrscan.cpp src/*.cpp -o sdrscan
+///   ./sdrscan -r 2400000 -c 98.0 [-f cu8|cs8|cs16|cf32] [-j threads] [-t 97.0] capture.iq
+///   ./sdrscan [-j threads] -s
+/// A capture is swept on all threads and on one thread, the wall clock times of the sweeps are reported.
+/// Then the band is scanned through the RADIO interface with seeks in modeled time,
+/// and the PS of every station with RDS is received. -t receives PS and RadioText of one frequency for 30 s.
+/// -s runs the same on a synthesized 2.4 MHz capture with four FM stations.
+
+#include "sdrradio.h"
+#include "mpxsynth.h"
+#include "RDSParser.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+static RDSParser rds;
+static char serviceName[10];
+static char radioText[70];
+
+static void processRDS(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4)
+{
+    rds.processData(block1, block2, block3, block4);
+}
+
+static void receiveServiceName(const char *name)
+{
+    strncpy(serviceName, name, sizeof(serviceName) - 1);
+}
+
+static void receiveText(const char *text)
+{
+    strncpy(radioText, text, sizeof(radioText) - 1);
+}
+
+
+/// Wall clock seconds of a sweep.
+static double timedSweep(SDRRadio &radio, RADIO_STATION *list, uint8_t *count, int threads)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    *count = radio.sweep(list, 32, 500, 0, threads);
+    return (std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+} // timedSweep()
+
+
+/// Receive RDS on a frequency until the PS is complete or maxTime msec have passed.
+static unsigned long receivePS(SDRRadio &radio, RADIO_FREQ freq, unsigned long maxTime)
+{
+    radio.setFrequency(freq);
+    radio.clearRDS();
+    serviceName[0] = radioText[0] = '\0';
+    unsigned long start = millis();
+    while ((millis() - start < maxTime) && (!serviceName[0] || (serviceName[0] == ' '))) {
+        radio.checkRDS();
+        delay(10);
+    }
+    return (millis() - start);
+} // receivePS()
+
+
+/// Sweep, scan and receive the stations of a capture.
+static void run(SDRCapture &capture, int threads)
+{
+    static SDRRadio radio(&capture);
+    RADIO_STATION list[32];
+    uint8_t count;
+    RADIO_INFO info;
+
+    printf("capture of %.2f s at %.3f MHz, %lu samples per second\n",
+           (double)capture.getLength() / capture.getRate(), capture.getCenter() / 1e6, capture.getRate());
+    radio.init();
+    radio.attachReceiveRDS(processRDS);
+    rds.attachServicenNameCallback(receiveServiceName);
+    rds.attachTextCallback(receiveText);
+
+    if (threads <= 0)
+        threads = std::thread::hardware_concurrency();
+    double single = timedSweep(radio, list, &count, 1);
+    double multi = timedSweep(radio, list, &count, threads);
+    printf("sweep of 500 ms per channel: %u stations, %.3f s on 1 thread, %.3f s on %d threads\n", count, single, multi, threads);
+    for (uint8_t n = 0; n < count; n++)
+        printf("  %6.1f MHz RSSI %3u %s%s\n", list[n].freq / 100.0, list[n].rssi, list[n].stereo ? "stereo" : "mono",
+               list[n].rdsSync ? " RDS" : "");
+
+    auto t0 = std::chrono::steady_clock::now();
+    count = radio.scan(list, 32, 60000, false, 300);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    printf("scan with seeks: %u stations in %lu ms modeled, %.3f s wall clock\n", count, radio.getScanDuration(), elapsed);
+    for (uint8_t n = 0; n < count; n++) {
+        radio.setFrequency(list[n].freq);
+        delay(100);
+        radio.getRadioInfo(&info);
+        printf("  %6.1f MHz RSSI %3u SNR %2u %s", list[n].freq / 100.0, info.rssi, info.snr, info.stereo ? "stereo" : "mono  ");
+        if (list[n].rdsSync) {
+            unsigned long t = receivePS(radio, list[n].freq, 5000);
+            printf(" PS '%s' after %lu ms", serviceName, t);
+        }
+        printf("\n");
+    }
+} // run()
+
+
+/// Receive one frequency for 30 s of the capture.
+static void listen(SDRCapture &capture, RADIO_FREQ freq)
+{
+    static SDRRadio radio(&capture);
+    RADIO_INFO info;
+
+    radio.init();
+    radio.attachReceiveRDS(processRDS);
+    rds.attachServicenNameCallback(receiveServiceName);
+    rds.attachTextCallback(receiveText);
+    unsigned long start = millis();
+    unsigned long t = receivePS(radio, freq, 30000);
+    radio.getRadioInfo(&info);
+    printf("%6.1f MHz RSSI %u SNR %u %s%s PS '%s' after %lu ms\n", freq / 100.0, info.rssi, info.snr,
+           info.stereo ? "stereo" : "mono", info.rds ? " RDS" : "", serviceName, t);
+    while (millis() - start < 30000) {
+        radio.checkRDS();
+        delay(10);
+    }
+    printf("RT '%s'\n", radioText);
+} // listen()
+
+
+// ----- synthesized capture -----
+
+/// A station of the synthesized capture.
+struct SYNTH_STATION {
+    unsigned long freq;  ///< Hz.
+    float level;         ///< dB relative to full scale.
+    bool stereo;
+    uint16_t pi;         ///< 0 = no RDS.
+    const char *ps;
+};
+
+static const SYNTH_STATION synthStations[] = {
+    { 97000000, -20, true,  0xD3C2, "SDR ONE " },
+    { 97400000, -45, false, 0xD311, "SDR TWO " },
+    { 98500000, -30, true,  0,      NULL },
+    { 99100000, -75, true,  0xD312, "TOO WEAK" }
+};
+
+static const unsigned long SYNTH_RATE = 2400000;
+static const unsigned long SYNTH_CENTER = 98000000;
+static const double SYNTH_SECONDS = 3;
+static const float SYNTH_NOISE = -65;  ///< Noise in dB relative to full scale within a 200 kHz channel.
+
+
+/// Groups 0A with the PS and groups 2A with the RadioText "Station <ps>" ending with a carriage return.
+static void buildGroups(const SYNTH_STATION &s, uint16_t *groups)
+{
+    char text[17];
+    snprintf(text, sizeof(text), "Station %.7s\r", s.ps);
+    for (int n = 0; n < 4; n++) {
+        uint16_t *g = &groups[n * 8];
+        g[0] = s.pi;
+        g[1] = 0x0408 | n;
+        g[2] = 0xE0CD;
+        g[3] = (uint16_t)((s.ps[2 * n] << 8) | s.ps[2 * n + 1]);
+        g[4] = s.pi;
+        g[5] = 0x2400 | n;
+        g[6] = (uint16_t)((text[4 * n] << 8) | text[4 * n + 1]);
+        g[7] = (uint16_t)((text[4 * n + 2] << 8) | text[4 * n + 3]);
+    }
+} // buildGroups()
+
+
+/// FM modulate the stations into a 16 bit capture with noise.
+static void synthesizeCapture(std::vector<int16_t> &iq)
+{
+    size_t samples = (size_t)(SYNTH_SECONDS * SYNTH_RATE);
+    std::vector<float> sumI(samples, 0), sumQ(samples, 0), mpx(samples);
+    static uint16_t groups[4][32];
+
+    for (size_t s = 0; s < sizeof(synthStations) / sizeof(synthStations[0]); s++) {
+        const SYNTH_STATION &st = synthStations[s];
+        MpxSynthesizer synth(SYNTH_RATE);
+        if (st.pi) {
+            buildGroups(st, groups[s]);
+            synth.setGroups(groups[s], 8);
+        }
+        synth.setLevels(0.4f, st.stereo ? 0.09f : 0, 0.04f);
+        synth.generate(&mpx[0], samples);
+
+        double amplitude = pow(10, st.level / 20);
+        double offset = 2 * M_PI * ((double)st.freq - SYNTH_CENTER) / SYNTH_RATE;
+        double deviation = 2 * M_PI * 75000.0 / SYNTH_RATE;
+        double phase = 0;
+        for (size_t n = 0; n < samples; n++) {
+            phase = fmod(phase + offset + deviation * mpx[n], 2 * M_PI);
+            sumI[n] += (float)(amplitude * cos(phase));
+            sumQ[n] += (float)(amplitude * sin(phase));
+        }
+    }
+
+    // The noise power is spread over the whole capture bandwidth.
+    double noise = pow(10, SYNTH_NOISE / 20) * sqrt(SYNTH_RATE / 200000.0 / 2);
+    unsigned long seed = 88172645463325252UL;
+    iq.resize(2 * samples);
+    for (size_t n = 0; n < samples; n++) {
+        double u[2];
+        for (int r = 0; r < 2; r++) {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            u[r] = ((seed >> 11) & 0xFFFFFFFFFFFFFUL) * (1.0 / 4503599627370496.0);
+        }
+        double radius = noise * sqrt(-2 * log(u[0] + 1e-300));
+        iq[2 * n] = (int16_t)lround((sumI[n] + radius * cos(2 * M_PI * u[1])) * 32767);
+        iq[2 * n + 1] = (int16_t)lround((sumQ[n] + radius * sin(2 * M_PI * u[1])) * 32767);
+    }
+} // synthesizeCapture()
+
+
+int main(int argc, char *argv[])
+{
+    static SDRCapture capture;
+    static std::vector<int16_t> synthesized;
+    unsigned long rate = 0;
+    double center = 0;
+    SDR_FORMAT format = SDR_CU8;
+    RADIO_FREQ tune = 0;
+    int threads = 0;
+    bool selfTest = false;
+    int i;
+
+    hostUseVirtualClock(true);
+    Serial.setOutput(NULL);
+
+    for (i = 1; (i < argc) && (argv[i][0] == '-'); i++) {
+        if (!strcmp(argv[i], "-s")) {
+            selfTest = true;
+        } else if (!strcmp(argv[i], "-r") && (i + 1 < argc)) {
+            rate = strtoul(argv[++i], NULL, 10);
+        } else if (!strcmp(argv[i], "-c") && (i + 1 < argc)) {
+            center = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "-j") && (i + 1 < argc)) {
+            threads = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-t") && (i + 1 < argc)) {
+            tune = (RADIO_FREQ)lround(atof(argv[++i]) * 100);
+        } else if (!strcmp(argv[i], "-f") && (i + 1 < argc)) {
+            static const char *names[] = { "cu8", "cs8", "cs16", "cf32" };
+            i++;
+            int f = 0;
+            while ((f < 4) && strcmp(argv[i], names[f]))
+                f++;
+            if (f == 4)
+                break;
+            format = (SDR_FORMAT)f;
+        } else {
+            break;
+        }
+    }
+    if (selfTest && (i == argc)) {
+        printf("synthesizing the capture...\n");
+        synthesizeCapture(synthesized);
+        capture.open(&synthesized[0], synthesized.size() * sizeof(int16_t), SDR_CS16, SYNTH_RATE, SYNTH_CENTER);
+        run(capture, threads);
+        return (0);
+    }
+    if ((i != argc - 1) || !rate || (center <= 0)) {
+        fprintf(stderr, "usage: sdrscan -r rate -c centerMHz [-f cu8|cs8|cs16|cf32] [-j threads] [-t MHz] capture | sdrscan [-j threads] -s\n");
+        return (2);
+    }
+    if (!capture.open(argv[i], format, rate, (unsigned long)lround(center * 1e6))) {
+        perror(argv[i]);
+        return (1);
+    }
+    if (tune)
+        listen(capture, tune);
+    else
+        run(capture, threads);
+    return (0);
+} // main()
@@ -0,0 +1,430 @@
+/// \file simradio.cpp
+/// \brief Run the SI4703 and RDA5807M drivers against the simulated chips and report their latency.
+///
+/// \details
+/// Build and run on a Linux host:
+///   g++ -O2 -DRADIO_BUS_STATS -Iextras/host -Isrc extras/host/Arduino.cpp extras/host/radiosimulator.cpp extras/host/simradio.cpp src/*.cpp -o simradio
+///   ./simradio
+/// All times are modeled times of the virtual clock.
+/// The bus traffic of every driver operation is reported at the end of each run.
+/// RDS is checked every 1 ms but only parsed every 200 ms like in a sketch with a slow display,
+/// the RDS buffer takes up the groups in between.
+/// RDS is received first by polling and then with the emulated interrupt line of the chip.
+/// Some blocks of 88.4 MHz are received with errors and checked by the RDS block filter.
+/// Zapping between two stations shows the PS of known stations from the station cache.
+/// Then the signal of 88.4 MHz fades and the AF follow mode has to find the program on another frequency.
+/// Finally 88.4 MHz announces a traffic announcement of 90.4 MHz in EON groups and the radio switches there and back.
+
+#include "radiosimulator.h"
+#include "radiointerfacestats.h"
+#include "SI4703.h"
+#include "RDA5807M.h"
+#include "RDSParser.h"
+#include "RDSBlockFilter.h"
+#include "RDSEON.h"
+
+// ----- a small band with two RDS stations -----
+
+// PS "SIMRADIO" in 4 groups 0A and the RadioText "Hello from the simulator\r" in 7 groups 2A.
+// The AF list (method A) names 88.4, 90.4 and 102.1 MHz, 90.4 MHz carries another program to exercise the PI check.
+static const uint16_t rdsSimRadio[] = {
+    0xD3C2, 0x0408, 0xE309, 0x5349,
+    0xD3C2, 0x0409, 0x1D92, 0x4D52,
+    0xD3C2, 0x040A, 0xE309, 0x4144,
+    0xD3C2, 0x040B, 0x1D92, 0x494F,
+    0xD3C2, 0x2400, 0x4865, 0x6C6C,
+    0xD3C2, 0x2401, 0x6F20, 0x6672,
+    0xD3C2, 0x2402, 0x6F6D, 0x2074,
+    0xD3C2, 0x2403, 0x6865, 0x2073,
+    0xD3C2, 0x2404, 0x696D, 0x756C,
+    0xD3C2, 0x2405, 0x6174, 0x6F72,
+    0xD3C2, 0x2406, 0x0D00, 0x0000,
+    0xD3C2, 0x1400, 0x0000, 0x0000
+};
+
+// A bad block C of a 0A group, a corrected and a bad block A and a bad block B.
+// The RDA5807M reports errors of the blocks A and B only.
+static const byte rdsSimRadioErrors[] = {
+    0, 0, RDS_BLER(0, 0, 3, 0), 0,
+    RDS_BLER(1, 0, 0, 0), 0, RDS_BLER(3, 0, 0, 0), 0,
+    0, 0, 0, RDS_BLER(0, 3, 0, 0)
+};
+
+// PS "CLASSIC " in 4 groups 0A.
+static const uint16_t rdsClassic[] = {
+    0xD4A1, 0x0508, 0xE0CD, 0x434C,
+    0xD4A1, 0x0509, 0xE0CD, 0x4153,
+    0xD4A1, 0x050A, 0xE0CD, 0x5349,
+    0xD4A1, 0x050B, 0xE0CD, 0x4320
+};
+
+// The groups 0A of "SIMRADIO" and groups 14A about the other network CLASSIC, a traffic program:
+// its PS, the mapped frequency 90.4 MHz for 88.4 MHz and the PTY 6 without TA.
+static const uint16_t rdsSimRadioEON[] = {
+    0xD3C2, 0x0408, 0xE309, 0x5349,
+    0xD3C2, 0xE410, 0x434C, 0xD4A1,
+    0xD3C2, 0x0409, 0x1D92, 0x4D52,
+    0xD3C2, 0xE411, 0x4153, 0xD4A1,
+    0xD3C2, 0x040A, 0xE309, 0x4144,
+    0xD3C2, 0xE412, 0x5349, 0xD4A1,
+    0xD3C2, 0x040B, 0x1D92, 0x494F,
+    0xD3C2, 0xE413, 0x4320, 0xD4A1,
+    0xD3C2, 0xE415, 0x091D, 0xD4A1,
+    0xD3C2, 0xE41D, 0x3000, 0xD4A1
+};
+
+// The groups 0A of "SIMRADIO" and groups 14B: a traffic announcement on CLASSIC.
+static const uint16_t rdsSimRadioTA[] = {
+    0xD3C2, 0x0408, 0xE309, 0x5349,
+    0xD3C2, 0xEC18, 0xD3C2, 0xD4A1,
+    0xD3C2, 0x0409, 0x1D92, 0x4D52,
+    0xD3C2, 0xEC18, 0xD3C2, 0xD4A1,
+    0xD3C2, 0x040A, 0xE309, 0x4144,
+    0xD3C2, 0xEC18, 0xD3C2, 0xD4A1,
+    0xD3C2, 0x040B, 0x1D92, 0x494F,
+    0xD3C2, 0xEC18, 0xD3C2, 0xD4A1
+};
+
+// "CLASSIC " with the TA flag set.
+static const uint16_t rdsClassicTA[] = {
+    0xD4A1, 0x0518, 0xE0CD, 0x434C,
+    0xD4A1, 0x0519, 0xE0CD, 0x4153,
+    0xD4A1, 0x051A, 0xE0CD, 0x5349,
+    0xD4A1, 0x051B, 0xE0CD, 0x4320
+};
+
+// not const, the RSSI of 88.4 MHz is changed to let the station fade.
+static SIM_STATION stations[] = {
+    { 8840, 32, true,  rdsSimRadio, 12, rdsSimRadioErrors },
+    { 9040, 45, true,  rdsClassic,   4, NULL },
+    { 9650, 20, false, NULL,         0, NULL },
+    { 10210, 38, true, rdsSimRadio, 12, rdsSimRadioErrors }
+};
+
+static const byte INT_PIN = 2;
+
+static RDSParser rds;
+static RDSBuffer rdsBuffer;
+static RDSStationCache stationCache;
+static RDSBlockFilter rdsFilter;
+static RDSEONDecoder eon;
+static RDSAlternativeFrequencyDecoder afDecoder;
+static RADIO *afRadio;
+static unsigned long trafficAt;
+static bool trafficStarted;
+static unsigned long tunedAt;
+static unsigned long psAt;
+static unsigned long ptyAt;
+static byte ptyShown;
+static byte afCount;
+
+static void processRDS(uint16_t b1, uint16_t b2, uint16_t b3, uint16_t b4)
+{
+    rds.processData(b1, b2, b3, b4);
+}
+
+static void showServiceName(const char *name)
+{
+    if (!psAt && name[0] != ' ')
+    {
+        psAt = millis();
+        printf("  PS '%s' after %lu ms\n", name, psAt - tunedAt);
+    }
+}
+
+
+static void showPTY(byte pty)
+{
+    if (!ptyAt && pty)
+    {
+        ptyAt = millis();
+        ptyShown = pty;
+    }
+}
+
+
+static void setAFList(uint16_t pi, const word *freqs, byte count)
+{
+    afCount = count;
+    afRadio->setAFList(freqs, count);
+}
+
+
+static void startTraffic(uint16_t pi, bool ta)
+{
+    if (ta && !trafficAt)
+    {
+        trafficAt = millis();
+        trafficStarted = afRadio->startTraffic(eon.getFrequency(pi, afRadio->getFrequency()), pi);
+    }
+}
+
+
+/// Receive RDS for 10 s and report the delivered groups, their latency and the bus load.
+static void listen(const char *mode, RADIO &radio, RadioSimulator &sim, RadioInterfaceStats &stats)
+{
+    RADIO_BUS_STATISTICS s;
+
+    radio.setFrequency(8840);
+    radio.clearRDS();
+    rdsBuffer.resetStatistics();
+    rdsFilter.resetStatistics();
+    stats.reset();
+    psAt = 0;
+    tunedAt = millis();
+    unsigned long processAt = tunedAt;
+    while (millis() - tunedAt < 10000)
+    {
+        radio.checkRDS();
+        if (millis() - processAt >= 200)
+        {
+            radio.processRDS();
+            processAt = millis();
+        }
+        delay(1);
+    }
+    radio.processRDS();
+    stats.snapshot(&s);
+    printf("  %s: RDS groups sent %lu, delivered %lu, latency %lu us, checkRDS bus calls %lu\n", mode,
+           sim.rdsGroupsSent(), sim.rdsGroupsRead(), sim.rdsLatency(), s.byOperation[RADIO_OP_CHECK_RDS].transactions);
+    printf("  RDS buffer high water %u of %u, dropped %lu\n", rdsBuffer.getHighWater(), RDS_BUFFER_SIZE, rdsBuffer.getDropCount());
+    printf("  RDS filter: groups %lu, blocks with errors %lu, dropped %lu\n", rdsFilter.getGroupCount(),
+           rdsFilter.getBlockCount(1) + rdsFilter.getBlockCount(2) + rdsFilter.getBlockCount(3), rdsFilter.getDropCount());
+} // listen()
+
+
+/// Tune between the stations and report when their PS is shown.
+/// The first visits are not cached, 102.1 MHz is known by the PI of 88.4 MHz.
+static void zap(RADIO &radio)
+{
+    static const RADIO_FREQ presets[] = { 9040, 8840, 9040, 10210 };
+
+    radio.setFrequency(9650);
+    radio.clearRDS();
+    stationCache.clear();
+    rds.attachStationCache(&stationCache);
+    rds.attachPTYCallback(showPTY);
+    for (byte i = 0; i < sizeof(presets) / sizeof(presets[0]); i++)
+    {
+        radio.setFrequency(presets[i]);
+        radio.clearRDS();
+        psAt = ptyAt = 0;
+        tunedAt = millis();
+        printf("  zap to %u:", presets[i]);
+        while (!psAt && millis() - tunedAt < 5000)
+        {
+            radio.checkRDS();
+            radio.processRDS();
+            delay(1);
+        }
+        if (ptyAt) printf("    PTY %u after %lu ms\n", ptyShown, ptyAt - tunedAt);
+    }
+    rds.attachPTYCallback(NULL);
+    rds.attachStationCache(NULL);
+} // zap()
+
+
+/// Let 88.4 MHz fade after 7 s and report the switch to an alternative frequency and the time the audio was muted.
+static void follow(RADIO &radio, RadioSimulator &sim, RadioInterfaceStats &stats)
+{
+    RADIO_BUS_STATISTICS s;
+    unsigned long muted = 0, mutedAt = 0, fadeAt = 0;
+    byte samples = 0;
+    bool switched = false;
+
+    afRadio = &radio;
+    afCount = 0;
+    stations[0].rssi = 32;
+    radio.setFrequency(8840);
+    radio.clearRDS();
+    radio.setAFFollow(true, 25);
+    stats.reset();
+    tunedAt = millis();
+    unsigned long processAt = tunedAt;
+    while (!switched && millis() - tunedAt < 15000)
+    {
+        if (!fadeAt && millis() - tunedAt >= 7000)
+        {
+            fadeAt = millis();
+            stations[0].rssi = 10;
+        }
+        radio.checkRDS();
+        if (millis() - processAt >= 200)
+        {
+            radio.processRDS();
+            processAt = millis();
+        }
+        switched = radio.pollAF();
+        if (radio.getMute() && !mutedAt)
+        {
+            mutedAt = millis();
+        }
+        else if (!radio.getMute() && mutedAt)
+        {
+            muted += millis() - mutedAt;
+            mutedAt = 0;
+            if (!fadeAt) samples++;
+        }
+        delay(1);
+    }
+    stats.snapshot(&s);
+    printf("  AF list of %u frequencies, %u AF samples before the fade muted %lu ms\n", afCount, samples, muted - radio.getAFMuteTime());
+    printf("  AF follow %s to %u %lu ms after the fade, switch %lu ms, muted %lu ms, bus calls %lu\n",
+           switched ? "switched" : "failed", radio.getFrequency(), millis() - fadeAt,
+           radio.getAFSwitchTime(), radio.getAFMuteTime(), s.byOperation[RADIO_OP_AF].transactions);
+    radio.setAFFollow(false);
+    stations[0].rssi = 32;
+} // follow()
+
+
+/// Let 88.4 MHz send EON groups about CLASSIC and start a traffic announcement there after 5 s that lasts 5 s.
+/// Report the switch to 90.4 MHz from the mapped frequency and the return after the TA flag is cleared.
+static void traffic(RADIO &radio)
+{
+    unsigned long startAt = 0, onAt = 0, endAt = 0, backAt = 0;
+    RADIO_FREQ onFreq = 0;
+    char name[9];
+
+    afRadio = &radio;
+    trafficAt = 0;
+    trafficStarted = false;
+    eon.clear();
+    eon.attachTrafficCallback(startTraffic);
+    rds.attachGroupDecoder(RDS_GROUP_A(14), &eon);
+    rds.attachGroupDecoder(RDS_GROUP_B(14), &eon);
+    stations[0].rdsGroups = rdsSimRadioEON;
+    stations[0].rdsCount = 10;
+    stations[0].rdsErrors = NULL;
+    radio.setFrequency(8840);
+    radio.clearRDS();
+    tunedAt = millis();
+    unsigned long processAt = tunedAt;
+    while (!backAt && millis() - tunedAt < 20000)
+    {
+        if (!startAt && millis() - tunedAt >= 5000)
+        {
+            startAt = millis();
+            stations[0].rdsGroups = rdsSimRadioTA;
+            stations[0].rdsCount = 8;
+            stations[1].rdsGroups = rdsClassicTA;
+        }
+        else if (startAt && !endAt && millis() - startAt >= 5000)
+        {
+            endAt = millis();
+            stations[0].rdsGroups = rdsSimRadioEON;
+            stations[0].rdsCount = 10;
+            stations[1].rdsGroups = rdsClassic;
+        }
+        radio.checkRDS();
+        if (millis() - processAt >= 200)
+        {
+            radio.processRDS();
+            processAt = millis();
+        }
+        bool on = radio.pollTraffic();
+        if (on && !onAt)
+        {
+            onAt = millis();
+            onFreq = radio.getFrequency();
+        }
+        else if (!on && onAt && endAt && radio.isTuneComplete() && radio.getFrequency() == 8840)
+            backAt = millis();
+        delay(1);
+    }
+    int n = eon.find(0xD4A1);
+    eon.getServiceName(n, name);
+    printf("  EON: '%s' PTY %u%s on %u for 8840\n", name, eon.getPTY(n), eon.getTP(n) ? " TP" : "", eon.getFrequency(0xD4A1, 8840));
+    printf("  traffic %s %lu ms after the 14B groups started, on %u after %lu ms, back %lu ms after TA was cleared\n",
+           trafficStarted ? "started" : "failed", trafficAt ? trafficAt - startAt : 0, onFreq,
+           radio.getTrafficSwitchTime(), backAt ? backAt - endAt : 0);
+    rds.attachGroupDecoder(RDS_GROUP_A(14), NULL);
+    rds.attachGroupDecoder(RDS_GROUP_B(14), NULL);
+    stations[0].rdsGroups = rdsSimRadio;
+    stations[0].rdsCount = 12;
+    stations[0].rdsErrors = rdsSimRadioErrors;
+} // traffic()
+
+
+/// Measure init, tune, seek, scan and RDS acquisition of one driver.
+static void run(const char *name, RADIO &radio, RadioSimulator &sim, RadioInterfaceStats &stats)
+{
+    RADIO_STATION list[16];
+    RADIO_BUS_STATISTICS s;
+    unsigned long t;
+
+    printf("%s\n", name);
+    sim.setStations(stations, sizeof(stations) / sizeof(stations[0]));
+    t = millis();
+    bool ok = radio.init();
+    printf("  init %s in %lu ms\n", ok ? "ok" : "failed", millis() - t);
+    radio.attachAFDecoder(&afDecoder);
+
+    t = millis();
+    ok = radio.setFrequency(9040);
+    printf("  setFrequency(9040) %s in %lu ms\n", ok ? "ok" : "failed", millis() - t);
+
+    stats.reset();
+    t = millis();
+    ok = radio.seekUp();
+    stats.snapshot(&s);
+    printf("  seekUp() %s to %u in %lu ms, bus calls %lu\n", ok ? "ok" : "failed", radio.getFrequency(), millis() - t,
+           s.byOperation[RADIO_OP_SEEK].transactions);
+
+    byte count = radio.scan(list, 16, 60000, false, 300);
+    printf("  scan found %u stations in %lu ms:", count, radio.getScanDuration());
+    for (byte i = 0; i < count; i++)
+        printf(" %u%s", list[i].freq, list[i].rdsSync ? "(RDS)" : "");
+    printf("\n");
+
+    Serial.setOutput(stdout);
+    stats.dump();
+    Serial.setOutput(NULL);
+
+    radio.attachReceiveRDS(processRDS);
+    radio.attachRDSBuffer(&rdsBuffer);
+    radio.attachRDSFilter(&rdsFilter);
+    rds.attachServicenNameCallback(showServiceName);
+    listen("polling", radio, sim, stats);
+
+    sim.setInterruptPin(INT_PIN);
+    ok = radio.enableInterrupt(INT_PIN);
+    printf("  enableInterrupt() %s\n", ok ? "ok" : "failed");
+    radio.setFrequency(9040);
+    stats.reset();
+    t = millis();
+    ok = radio.seekUp();
+    stats.snapshot(&s);
+    printf("  seekUp() %s to %u in %lu ms, bus calls %lu\n", ok ? "ok" : "failed", radio.getFrequency(), millis() - t,
+           s.byOperation[RADIO_OP_SEEK].transactions);
+    listen("interrupt", radio, sim, stats);
+    Serial.setOutput(stdout);
+    rdsFilter.dump();
+    Serial.setOutput(NULL);
+    zap(radio);
+    afDecoder.attachAFListCallback(setAFList);
+    follow(radio, sim, stats);
+    afDecoder.attachAFListCallback(NULL);
+    traffic(radio);
+    radio.disableInterrupt();
+    radio.attachAFDecoder(NULL);
+} // run()
+
+
+int main()
+{
+    // static like the globals of a sketch, the drivers rely on zero initialized members.
+    hostUseVirtualClock(true);
+    Serial.setOutput(NULL);
+    rds.attachAFDecoder(&afDecoder);
+
+    static SimSI4703 simSI4703;
+    static RadioInterfaceStats statsSI4703(&simSI4703);
+    static SI4703 si4703(&statsSI4703, 2, A4);
+    run("SI4703", si4703, simSI4703, statsSI4703);
+
+    static SimRDA5807M simRDA5807M;
+    static RadioInterfaceStats statsRDA5807M(&simRDA5807M);
+    static RDA5807M rda5807m(&statsRDA5807M);
+    run("RDA5807M", rda5807m, simRDA5807M, statsRDA5807M);
+    return 0;
+} // main()
@@ -11,30 +11,36 @@
 RDA5807M::RDA5807M(RadioInterface* prf): RADIO(prf)
 {
     memset(aui_RDA5807_Reg, 0, sizeof(aui_RDA5807_Reg));
+    _batching=false;
+    _batchRegs=0;
 }
 
 bool RDA5807M::checkRDS()
 {
-    if(millis()<rdsPollTime+50)
+    RADIO_BUS_OPERATION(RADIO_OP_CHECK_RDS);
+    if(!_rdsDue())
     {
-	return false;
+        return false;
     }
-    rdsPollTime=millis();
 
     if(!_readRegisters(&aui_RDA5807_Reg[0xA]) || !bitRead(aui_RDA5807_Reg[0xA],R0A_RDSS))
     {
         return false;
     }
-    if(!bitRead(aui_RDA5807_Reg[0xA],R0A_RDSR) || ((aui_RDA5807_Reg[0xA]&0x3==3)) || ((aui_RDA5807_Reg[0xA]&0xC==0xC)))
+    if(!bitRead(aui_RDA5807_Reg[0xA],R0A_RDSR))
     {
         return false;
     }
-    _sendRDS(aui_RDA5807_Reg[0xC], aui_RDA5807_Reg[0xD],aui_RDA5807_Reg[0xE],aui_RDA5807_Reg[0xF]);
+    // The chip reports blocks A and B only, C and D are assumed to be like B.
+    byte blerA=(aui_RDA5807_Reg[0xB]>>R0B_BLERA) & 0x03;
+    byte blerB=(aui_RDA5807_Reg[0xB]>>R0B_BLERB) & 0x03;
+    _receiveRDS(aui_RDA5807_Reg[0xC], aui_RDA5807_Reg[0xD],aui_RDA5807_Reg[0xE],aui_RDA5807_Reg[0xF], RDS_BLER(blerA, blerB, blerB, blerB));
     return true;
 }
 
 RADIO_FREQ RDA5807M::getFrequency(void)
 {
+    RADIO_BUS_OPERATION(RADIO_OP_GET_FREQUENCY);
     if(!readReg(0xA, aui_RDA5807_Reg[0xA]))
     {
         return 0;
@@ -45,6 +51,7 @@ RADIO_FREQ RDA5807M::getFrequency(void)
 
 bool RDA5807M::getRadioInfo(RADIO_INFO *info)
 {
+    RADIO_BUS_OPERATION(RADIO_OP_GET_INFO);
     RADIO::getRadioInfo(info);
 
     if(!_readRegisters(&aui_RDA5807_Reg[0xA]))
@@ -53,7 +60,7 @@ bool RDA5807M::getRadioInfo(RADIO_INFO *info)
     }
     info->stereo = bitRead(aui_RDA5807_Reg[0xA], R0A_ST);
     info->mono = bitRead(aui_RDA5807_Reg[0x2], R02_MONO);
-    info->rds = bitRead(aui_RDA5807_Reg[0xA], R0A_RDSR);
+    info->rds = bitRead(aui_RDA5807_Reg[0xA], R0A_RDSS);
     info->rssi = aui_RDA5807_Reg[0xB]>>9;
     info->tuned = bitRead(aui_RDA5807_Reg[0xB], R0B_FM_TRUE) && bitRead(aui_RDA5807_Reg[0xB], R0B_FM_READY);
     return true;
@@ -61,9 +68,19 @@ bool RDA5807M::getRadioInfo(RADIO_INFO *info)
 
 bool RDA5807M::init()
 {
+    RADIO_BUS_OPERATION(RADIO_OP_INIT);
     _pRadio->init();
-    if(!reset() || !powerOn(true))
+    if(!reset())
+    {
+        return false;
+    }
+    // Collect the setup writes, they are sent as one transaction when tuning starts.
+    // A failed transaction fails the tune and so the init.
+    _batching=true;
+    if(!powerOn(true))
     {
+        _batching=false;
+        _batchRegs=0;
         return false;
     }
 //    bitSet(aui_RDA5807_Reg[4],R04_DE);//de-emphasis 50µs
@@ -113,16 +130,29 @@ void RDA5807M::term()
 
 bool RDA5807M::seekUp(bool toNextSender)
 {
-    bitSet(aui_RDA5807_Reg[2], R02_SEEKUP);
-    bitSet(aui_RDA5807_Reg[2], R02_SEEK);
-    writeReg(2);
+    RADIO_BUS_OPERATION(RADIO_OP_SEEK);
+    return startSeek(true) && _waitTune();
 }
 
 bool RDA5807M::seekDown(bool toNextSender)
 {
-    bitClear(aui_RDA5807_Reg[2], R02_SEEKUP);
+    RADIO_BUS_OPERATION(RADIO_OP_SEEK);
+    return startSeek(false) && _waitTune();
+}
+
+/// Start a seek, pollTune() has to be called until it is complete.
+bool RDA5807M::startSeek(bool seekUp)
+{
+    RADIO_BUS_OPERATION(RADIO_OP_SEEK);
+    bitWrite(aui_RDA5807_Reg[2], R02_SEEKUP, seekUp);
     bitSet(aui_RDA5807_Reg[2], R02_SEEK);
-    writeReg(2);
+    if(!writeReg(2) || !_flushBatch())
+    {
+        _tuneDone(false);
+        return false;
+    }
+    _tuneStart(TUNE_WAIT_STC, 50);
+    return true;
 }
 
 void RDA5807M::setBand(RADIO_BAND newBand)
@@ -141,6 +171,7 @@ void RDA5807M::setBand(RADIO_BAND newBand)
 
 bool RDA5807M::setBassBoost(bool switchOn)
 {
+    RADIO_BUS_OPERATION(RADIO_OP_SETTINGS);
     bitWrite(aui_RDA5807_Reg[2], R02_BASS, switchOn);
     return writeReg(2);
 }
@@ -167,28 +198,90 @@ void RDA5807M::setChannelSpacing(SPACINGS sp)
 
 bool RDA5807M::setFrequency(RADIO_FREQ newF)
 {
+    RADIO_BUS_OPERATION(RADIO_OP_SET_FREQUENCY);
+    return startFrequency(newF) && _waitTune();
+}
+
+/// Start tuning to a new frequency, pollTune() has to be called until it is complete.
+bool RDA5807M::startFrequency(RADIO_FREQ newF)
+{
+    RADIO_BUS_OPERATION(RADIO_OP_SET_FREQUENCY);
     RADIO::setFrequency(newF);
     word channel = (_freq - _freqLow) / _freqSteps;
 
     aui_RDA5807_Reg[3]&=0x003F;
     aui_RDA5807_Reg[3]|=channel<<6;
     bitSet(aui_RDA5807_Reg[3], R03_TUNE);
-    if(!writeReg(3))
+    if(!writeReg(3) || !_flushBatch())
     {
+        _tuneDone(false);
         return false;
     }
-    delay(50);
-    for(byte i=0;i<100;i++)
+    _tuneStart(TUNE_WAIT_STC, 50);
+    return true;
+}
+
+/// Advance a running tune or seek by polling the STC bit.
+/// @return true when no tune or seek is running any more.
+bool RDA5807M::pollTune()
+{
+    RADIO_BUS_OPERATION(RADIO_OP_POLL_TUNE);
+    if(_tuneState==TUNE_IDLE)
     {
-        readReg(0xA, aui_RDA5807_Reg[0xA]);
-        if(bitRead(aui_RDA5807_Reg[0xA], R0A_STC))
-        {
-            break;
-        }
-        delay(10);
-    };
+        return true;
+    }
+    if(!_tuneDue())
+    {
+        return false;
+    }
+    bool complete=readReg(0xA, aui_RDA5807_Reg[0xA]) && bitRead(aui_RDA5807_Reg[0xA], R0A_STC);
+    if(!complete && ++_tunePolls<100)
+    {
+        _tuneInterval=10;
+        return false;
+    }
+    // the chip clears TUNE and SEEK by itself, keep the local copy in sync.
+    bitClear(aui_RDA5807_Reg[2], R02_SEEK);
+    bitClear(aui_RDA5807_Reg[3], R03_TUNE);
     writeReg(2);    //Turn RDS on again.
-    return bitRead(aui_RDA5807_Reg[0xA], R0A_STC);
+    if(complete)
+    {
+        _freq = _freqLow + _freqSteps * (aui_RDA5807_Reg[0xA] & 0x03FF);
+    }
+    _tuneDone(complete && !bitRead(aui_RDA5807_Reg[0xA], R0A_SF));
+    return true;
+}
+
+/// Let the chip pull GPIO2 low when RDS data is ready or a tune or seek is complete.
+/// The interrupt is a 5 msec pulse (INT_MODE cleared), the level mode would keep the line low
+/// until register 0x0C is read and block further interrupts when the RDS data is not read.
+bool RDA5807M::enableInterrupt(byte intPin)
+{
+    RADIO_BUS_OPERATION(RADIO_OP_SETTINGS);
+    if(!_attachInterruptPin(intPin))
+    {
+        return false;
+    }
+    bitSet(aui_RDA5807_Reg[4], R04_RDSIEN);
+    bitSet(aui_RDA5807_Reg[4], R04_STCIEN);
+    aui_RDA5807_Reg[4] = (aui_RDA5807_Reg[4] & ~R04_GPIO2_MASK) | R04_GPIO2_INT;
+    bitClear(aui_RDA5807_Reg[5], R05_INT_MODE);
+    if(!writeReg(4) || !writeReg(5))
+    {
+        disableInterrupt();
+        return false;
+    }
+    return true;
+}
+
+void RDA5807M::disableInterrupt()
+{
+    RADIO_BUS_OPERATION(RADIO_OP_SETTINGS);
+    RADIO::disableInterrupt();
+    bitClear(aui_RDA5807_Reg[4], R04_RDSIEN);
+    bitClear(aui_RDA5807_Reg[4], R04_STCIEN);
+    aui_RDA5807_Reg[4] &= ~R04_GPIO2_MASK;
+    writeReg(4);
 }
 
 void RDA5807M::setMono(bool switchOn)
@@ -198,7 +291,10 @@ void RDA5807M::setMono(bool switchOn)
 
 void RDA5807M::setMute(bool switchOn)
 {
-
+    RADIO_BUS_OPERATION(RADIO_OP_SETTINGS);
+    RADIO::setMute(switchOn);
+    bitWrite(aui_RDA5807_Reg[2], R02_DMUTE, !switchOn);
+    writeReg(2);
 }
 
 void RDA5807M::setSoftMute(bool switchOn)
@@ -208,6 +304,7 @@ void RDA5807M::setSoftMute(bool switchOn)
 
 void RDA5807M::setVolume(byte newVolume)
 {
+    RADIO_BUS_OPERATION(RADIO_OP_SETTINGS);
     RADIO::setVolume(newVolume);
     aui_RDA5807_Reg[5]=(aui_RDA5807_Reg[5] & 0xFFF0)| _volume;
     writeReg(5);
@@ -215,6 +312,7 @@ void RDA5807M::setVolume(byte newVolume)
 
 bool RDA5807M::debugStatus(word* regs)
 {
+    RADIO_BUS_OPERATION(RADIO_OP_DEBUG);
     return _readRegisters(regs);
 
 }
@@ -228,17 +326,46 @@ bool RDA5807M::readReg(byte regNr, word& val)
         return false;
     }
     val = arrayToRegister(data);
+    return true;
 }
 
 
 bool RDA5807M::writeReg(byte regNr)
 {
+    if(_batching)
+    {
+        bitSet(_batchRegs, regNr);
+        return true;
+    }
     byte data[3];
     data[0]=regNr;
     registerToArray(aui_RDA5807_Reg[regNr],data+1);
     return _pRadio->send(RDA5807_adrr, data, sizeof(data));
 }
 
+/// Queue every register written while batching once and send them in one transaction.
+bool RDA5807M::_flushBatch()
+{
+    if(!_batching)
+    {
+        return true;
+    }
+    RadioTransaction batch(_pRadio);
+    byte data[3];
+    for (byte regNr=0;regNr<16;regNr++)
+    {
+        if(bitRead(_batchRegs, regNr))
+        {
+            data[0]=regNr;
+            registerToArray(aui_RDA5807_Reg[regNr],data+1);
+            batch.send(RDA5807_adrr, data, sizeof(data));
+        }
+    }
+    _batching=false;
+    _batchRegs=0;
+    return batch.flush();
+}
+
 bool RDA5807M::_saveRegisters()
 {
     byte data[10];
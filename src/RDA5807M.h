@@ -17,6 +17,9 @@
 /// * 12.05.2014 creation of the RDA5807M library.
 /// * 28.06.2014 running simple radio
 /// * 08.07.2014 RDS data receive function can be registered.
+/// * 17.10.2026 setup writes in init() are sent as one bus transaction.
+/// * 17.10.2026 non-blocking tune and seek.
+/// * 17.10.2026 RDS and seek/tune complete interrupts on GPIO2.
 
 // multi-Band enabled
 
@@ -58,9 +61,16 @@ public:
     bool    seekUp(bool toNextSender = true);   // start seek mode upwards
     bool    seekDown(bool toNextSender = true); // start seek mode downwards
 
+    bool    startFrequency(RADIO_FREQ newF);    // start tuning, returns immediately
+    bool    startSeek(bool seekUp = true);      // start seek, returns immediately
+    bool    pollTune();                         // advance a running tune or seek
+
     // ----- Supporting RDS for RADIO_BAND_FM and RADIO_BAND_FMWORLD
     bool    checkRDS();
 
+    bool    enableInterrupt(byte intPin);       // use GPIO2 of the chip connected to intPin, call after init().
+    void    disableInterrupt();
+
     // ----- combined status functions -----
     virtual bool getRadioInfo(RADIO_INFO *info); ///< Retrieve some information about the current radio function of the chip.
 
@@ -68,7 +78,6 @@ public:
 
     // ----- debug Helpers send information to Serial port
 
-    void    debugScan();               // Scan all frequencies and report a status
     bool    debugStatus(word* data);             // DebugInfo about actual chip data available
 private:
     //Bit definitions
@@ -88,17 +97,24 @@ private:
     const byte R03_BAND0=2;
     const byte R03_SPACE1=1;
     const byte R03_SPACE0=0;
+    const byte R04_RDSIEN=15;
+    const byte R04_STCIEN=14;
     const byte R04_DE=11;
+    const word R04_GPIO2_MASK=0x000C;
+    const word R04_GPIO2_INT=0x0004;
     const byte R05_INT_MODE=15;
     const word R05_SEEKTH=0x08;
     const byte R05_LNA_PORT_SEL=0x2;
     const byte R05_LNA_ICSEL_BIT=0x2;
     const byte R0A_RDSR=15;
     const byte R0A_STC=14;
+    const byte R0A_SF=13;
     const byte R0A_RDSS=12;
     const byte R0A_ST=10;
     const byte R0B_FM_TRUE=8;
     const byte R0B_FM_READY=7;
+    const byte R0B_BLERA=2;             // Block A error level, 2 bits.
+    const byte R0B_BLERB=0;             // Block B error level, 2 bits.
 
     const word RDA5807_adrs=0x10;       // I2C-Address RDA Chip for sequential  Access
     const word RDA5807_adrr=0x11;       // I2C-Address RDA Chip for random      Access
@@ -110,8 +126,11 @@ private:
     bool _readRegisters(word *regs);                       ///< Read regs 0x0A and up.
     bool readReg(byte regNr, word &val);
     bool writeReg(byte regNr);
+    bool _flushBatch();                                   ///< Send the registers queued while batching.
     bool _saveRegisters();                                ///< Write regs 0x02 and up.
     void registerToArray(word regIn, byte* dataOut);
     word arrayToRegister(byte* dataIn);
     word aui_RDA5807_Reg[16];
+    bool _batching;      ///< writeReg() only queues the register.
+    word _batchRegs;     ///< Bitmask of the registers queued while batching.
 };
@@ -0,0 +1,181 @@
+/// \file RDSBlockFilter.cpp
+/// \brief Filter for RDS groups by the error levels of their blocks.
+///
+/// \details
+/// See RDSBlockFilter.h.
+/// The 2 bit levels of all blocks are checked at once:
+/// bit 0 of a pair is set in (errors | errors >> 1) for a block with errors,
+/// in (errors >> 1) for a level of 2 or more and in (errors & errors >> 1) for level 3.
+/// _pack() packs these bits into a nibble with block A in bit 3, so tables can be used for the rest.
+
+#include "RDSBlockFilter.h"
+
+// Bits of the blocks in a nibble.
+#define BLOCK_A 0x08
+#define BLOCK_B 0x04
+#define BLOCK_C 0x02
+#define BLOCK_D 0x01
+
+// Block C of 0A groups carries AF codes and can be replaced by fillers.
+#define FILL_C  0x10
+
+// AF filler codes for a bad block C.
+#define AF_FILLERS 0xCDCD
+
+/// Number of blocks in a nibble.
+static const byte BLOCK_COUNT[16] PROGMEM = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+/// Blocks C and D used by the group codes, version B groups repeat the PI in block C.
+static const byte BLOCKS_USED[32] PROGMEM = {
+    BLOCK_C | BLOCK_D | FILL_C, BLOCK_D, // 0A, 0B basic tuning
+    BLOCK_C | BLOCK_D, BLOCK_D,          // 1
+    BLOCK_C | BLOCK_D, BLOCK_D,          // 2 RadioText
+    BLOCK_C | BLOCK_D, BLOCK_D,          // 3
+    BLOCK_C | BLOCK_D, BLOCK_D,          // 4 clock time
+    BLOCK_C | BLOCK_D, BLOCK_D,          // 5
+    BLOCK_C | BLOCK_D, BLOCK_D,          // 6
+    BLOCK_C | BLOCK_D, BLOCK_D,          // 7
+    BLOCK_C | BLOCK_D, BLOCK_D,          // 8
+    BLOCK_C | BLOCK_D, BLOCK_D,          // 9
+    BLOCK_C | BLOCK_D, BLOCK_D,          // 10
+    BLOCK_C | BLOCK_D, BLOCK_D,          // 11
+    BLOCK_C | BLOCK_D, BLOCK_D,          // 12
+    BLOCK_C | BLOCK_D, BLOCK_D,          // 13
+    BLOCK_C | BLOCK_D, BLOCK_D,          // 14
+    BLOCK_C | BLOCK_D, BLOCK_D           // 15
+};
+
+
+/// Pack bit 0 of the 4 pairs into a nibble.
+static inline byte _pack(byte pairs)
+{
+    pairs = (pairs | (pairs >> 1)) & 0x33;
+    return (pairs | (pairs >> 2)) & 0x0F;
+} // _pack()
+
+
+RDSBlockFilter::RDSBlockFilter(byte maxLevel)
+{
+    _maxLevel = maxLevel;
+    _pi = 0;
+    resetStatistics();
+} // RDSBlockFilter()
+
+
+void RDSBlockFilter::setMaxLevel(byte maxLevel)
+{
+    _maxLevel = maxLevel;
+} // setMaxLevel()
+
+
+void RDSBlockFilter::reset()
+{
+    _pi = 0;
+} // reset()
+
+
+bool RDSBlockFilter::filter(uint16_t *block1, uint16_t *block2, uint16_t *block3, uint16_t *block4, byte errors)
+{
+    (void)block4; // block D is never replaced, only its error level is checked.
+    byte code = *block2 >> 11;
+
+    _groups++;
+    if (errors == 0)
+    {
+        _blocks[0] += 4;
+        _codeGroups[code]++;
+        _pi = *block1;
+        return true;
+    }
+
+    byte any = _pack((errors | (errors >> 1)) & 0x55);
+    byte high = _pack((errors >> 1) & 0x55);
+    byte worst = _pack(errors & (errors >> 1) & 0x55);
+    byte bad = (_maxLevel == 0) ? any : (_maxLevel == 1) ? high : (_maxLevel == 2) ? worst : 0;
+    byte count = pgm_read_byte(&BLOCK_COUNT[any]);
+
+    _blocks[0] += 4 - count;
+    _blocks[1] += count - pgm_read_byte(&BLOCK_COUNT[high]);
+    _blocks[2] += pgm_read_byte(&BLOCK_COUNT[high]) - pgm_read_byte(&BLOCK_COUNT[worst]);
+    _blocks[3] += pgm_read_byte(&BLOCK_COUNT[worst]);
+
+    if (bad & BLOCK_B) code = RDS_GROUP_UNKNOWN;
+    _codeGroups[code]++;
+    _codeErrors[code] += count;
+    if (bad & BLOCK_B) return _drop(code);
+
+    if (!(bad & BLOCK_A))
+        _pi = *block1;
+    else if (_pi)
+        *block1 = _pi;
+    else
+        return _drop(code);
+
+    byte used = pgm_read_byte(&BLOCKS_USED[code]);
+    if (bad & used & BLOCK_D) return _drop(code);
+    if (bad & used & BLOCK_C)
+    {
+        if (!(used & FILL_C)) return _drop(code);
+        *block3 = AF_FILLERS;
+    }
+    return true;
+} // filter()
+
+
+bool RDSBlockFilter::_drop(byte code)
+{
+    _drops++;
+    _codeDrops[code]++;
+    return false;
+} // _drop()
+
+
+unsigned long RDSBlockFilter::getGroupCount() { return _groups; }
+unsigned long RDSBlockFilter::getDropCount() { return _drops; }
+unsigned long RDSBlockFilter::getBlockCount(byte level) { return level < 4 ? _blocks[level] : 0; }
+word RDSBlockFilter::getGroupCount(byte groupCode) { return groupCode <= RDS_GROUP_UNKNOWN ? _codeGroups[groupCode] : 0; }
+word RDSBlockFilter::getErrorCount(byte groupCode) { return groupCode <= RDS_GROUP_UNKNOWN ? _codeErrors[groupCode] : 0; }
+word RDSBlockFilter::getDropCount(byte groupCode) { return groupCode <= RDS_GROUP_UNKNOWN ? _codeDrops[groupCode] : 0; }
+
+
+void RDSBlockFilter::resetStatistics()
+{
+    _groups = 0;
+    _drops = 0;
+    memset(_blocks, 0, sizeof(_blocks));
+    memset(_codeGroups, 0, sizeof(_codeGroups));
+    memset(_codeErrors, 0, sizeof(_codeErrors));
+    memset(_codeDrops, 0, sizeof(_codeDrops));
+} // resetStatistics()
+
+
+/// Print one line for all groups and one per group code with traffic:
+/// label n=groups e=blocks with errors d=dropped groups bler=percent of the blocks with errors.
+void RDSBlockFilter::dump()
+{
+    Serial.print("all n="); Serial.print(_groups);
+    Serial.print(" levels="); Serial.print(_blocks[0]);
+    Serial.print(','); Serial.print(_blocks[1]);
+    Serial.print(','); Serial.print(_blocks[2]);
+    Serial.print(','); Serial.print(_blocks[3]);
+    Serial.print(" d="); Serial.println(_drops);
+
+    for (byte code = 0; code <= RDS_GROUP_UNKNOWN; code++)
+    {
+        if (!_codeGroups[code]) continue;
+        if (code == RDS_GROUP_UNKNOWN)
+        {
+            Serial.print("??");
+        }
+        else
+        {
+            Serial.print(code >> 1);
+            Serial.print((code & 1) ? 'B' : 'A');
+        }
+        Serial.print(" n="); Serial.print(_codeGroups[code]);
+        Serial.print(" e="); Serial.print(_codeErrors[code]);
+        Serial.print(" d="); Serial.print(_codeDrops[code]);
+        Serial.print(" bler="); Serial.print((unsigned long)_codeErrors[code] * 100 / (4UL * _codeGroups[code]));
+        Serial.println('%');
+    }
+} // dump()
@@ -0,0 +1,70 @@
+///
+/// \file RDSBlockFilter.h
+/// \brief Filter for RDS groups by the error levels of their blocks.
+///
+/// \details
+/// The chips report how many bit errors they corrected in each block of a group:
+///   0 = no errors, 1 = 1..2 errors, 2 = 3..5 errors, 3 = 6+ errors or not correctable.
+/// A block with a level above the maximum level of the filter is bad:
+/// * A bad block B drops the group, its type is unknown.
+/// * A bad block A is replaced by the PI of the last good block A.
+/// * A bad block C or D drops the group when its group type uses the block.
+///   A bad block C of a 0A group is replaced by AF filler codes so the PS in block D is kept.
+///
+/// The filter is attached to the radio and checks the groups before they are buffered or passed to the parser:
+///   RDSBlockFilter rdsFilter;
+///   radio.attachRDSFilter(&rdsFilter);
+///
+/// It counts the groups, their blocks with errors and the dropped groups by group code.
+/// The counters by group code wrap around after 65535.
+///
+/// History:
+/// --------
+/// * 17.10.2026 created.
+
+#pragma once
+
+#include <Arduino.h>
+
+/// Error levels of the 4 blocks of a group, 2 bits per block with block A in bits 7:6.
+#define RDS_BLER(a, b, c, d) ((byte)(((a) << 6) | ((b) << 4) | ((c) << 2) | (d)))
+
+/// Statistics index of the groups with a bad block B, their group code is unknown.
+#define RDS_GROUP_UNKNOWN 32
+
+
+/// Checks the error levels of the blocks and keeps the block error statistics.
+class RDSBlockFilter
+{
+public:
+    RDSBlockFilter(byte maxLevel = 1); ///< create a filter using blocks up to maxLevel.
+
+    void setMaxLevel(byte maxLevel); ///< Highest error level of a block that is used, 0..3.
+    void reset();                    ///< Forget the PI of the station, call this after tuning.
+
+    /// Check a group, a bad block A or C may be replaced. Returns false when the group is dropped.
+    bool filter(uint16_t *block1, uint16_t *block2, uint16_t *block3, uint16_t *block4, byte errors);
+
+    // ----- statistics -----
+
+    unsigned long getGroupCount();          ///< Number of groups checked.
+    unsigned long getDropCount();           ///< Number of groups dropped.
+    unsigned long getBlockCount(byte level); ///< Number of blocks with an error level.
+    word getGroupCount(byte groupCode);     ///< Groups of a group code or RDS_GROUP_UNKNOWN.
+    word getErrorCount(byte groupCode);     ///< Blocks with errors in the groups of a group code.
+    word getDropCount(byte groupCode);      ///< Dropped groups of a group code.
+    void resetStatistics();                 ///< Clear all counters.
+    void dump();                            ///< Print the counters of the group codes with traffic to the Serial port.
+
+private:
+    bool _drop(byte code);
+
+    byte _maxLevel;                 ///< Highest error level of a good block.
+    uint16_t _pi;                   ///< PI of the last good block A, 0 = unknown.
+    unsigned long _groups;          ///< Groups checked.
+    unsigned long _drops;           ///< Groups dropped.
+    unsigned long _blocks[4];       ///< Blocks by error level.
+    word _codeGroups[RDS_GROUP_UNKNOWN + 1]; ///< Groups by group code.
+    word _codeErrors[RDS_GROUP_UNKNOWN + 1]; ///< Blocks with errors by group code.
+    word _codeDrops[RDS_GROUP_UNKNOWN + 1];  ///< Dropped groups by group code.
+}; // class RDSBlockFilter
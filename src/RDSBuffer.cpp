@@ -0,0 +1,101 @@
+/// \file RDSBuffer.cpp
+/// \brief Ring buffer for RDS groups between the chip and the RDS parser.
+///
+/// \details
+/// See RDSBuffer.h.
+/// _head and _tail are free running byte counters, so the fill level is their difference
+/// modulo 256 and a full buffer can be told apart from an empty one.
+
+#include "RDSBuffer.h"
+
+
+RDSBuffer::RDSBuffer()
+{
+    _head=0;
+    _tail=0;
+    _drops=0;
+    _highWater=0;
+} // RDSBuffer()
+
+
+bool RDSBuffer::put(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4)
+{
+    byte head=_head;
+    byte level=(byte)(head - _tail);
+
+    if (level >= RDS_BUFFER_SIZE)
+    {
+        _drops=_drops + 1;
+        return false;
+    }
+
+    uint16_t *g=_groups[head & (RDS_BUFFER_SIZE - 1)];
+    g[0]=block1;
+    g[1]=block2;
+    g[2]=block3;
+    g[3]=block4;
+    RDS_BUFFER_BARRIER();
+    _head=head + 1;
+
+    if (level + 1 > _highWater)
+        _highWater=level + 1;
+    return true;
+} // put()
+
+
+bool RDSBuffer::get(uint16_t *block1, uint16_t *block2, uint16_t *block3, uint16_t *block4)
+{
+    byte tail=_tail;
+
+    if (_head == tail)
+        return false;
+    RDS_BUFFER_BARRIER();
+
+    uint16_t *g=_groups[tail & (RDS_BUFFER_SIZE - 1)];
+    *block1=g[0];
+    *block2=g[1];
+    *block3=g[2];
+    *block4=g[3];
+    RDS_BUFFER_BARRIER();
+    _tail=tail + 1;
+    return true;
+} // get()
+
+
+byte RDSBuffer::available()
+{
+    return (byte)(_head - _tail);
+} // available()
+
+
+/// Only the consumer index is moved, so this is safe while the producer is running.
+void RDSBuffer::flush()
+{
+    _tail=_head;
+} // flush()
+
+
+/// The counter is wider than a byte and may be changed by an ISR while it is read,
+/// so it is read until two reads are equal.
+unsigned long RDSBuffer::getDropCount()
+{
+    unsigned long drops;
+    do
+    {
+        drops=_drops;
+    } while (drops != _drops);
+    return drops;
+} // getDropCount()
+
+
+byte RDSBuffer::getHighWater()
+{
+    return _highWater;
+} // getHighWater()
+
+
+void RDSBuffer::resetStatistics()
+{
+    _drops=0;
+    _highWater=0;
+} // resetStatistics()
@@ -0,0 +1,73 @@
+///
+/// \file RDSBuffer.h
+/// \brief Ring buffer for RDS groups between the chip and the RDS parser.
+///
+/// \details
+/// The radio driver puts the groups it reads from the chip into the buffer and
+/// the main loop takes them out and passes them to the parser:
+///   RDSBuffer rdsBuffer;
+///   radio.attachReceiveRDS(RDS_process);
+///   radio.attachRDSBuffer(&rdsBuffer);
+///   ...
+///   radio.checkRDS();   // polling context or interrupt: read the chip
+///   radio.processRDS(); // main loop: run the parser and its callbacks
+///
+/// There is exactly one producer and one consumer. The producer only writes _head and
+/// the consumer only writes _tail, so no locking is needed and put() is safe in an ISR.
+/// When the buffer is full the new group is dropped and counted.
+///
+/// History:
+/// --------
+/// * 17.10.2026 created.
+
+#pragma once
+
+#include <Arduino.h>
+
+/// Number of groups in the buffer, must be a power of 2 and not more than 128.
+#define RDS_BUFFER_SIZE 16
+
+/// Make the group data visible before the index is published.
+/// A compiler barrier is enough on a single core AVR.
+#if defined(__AVR__)
+#define RDS_BUFFER_BARRIER() __asm__ __volatile__("" ::: "memory")
+#else
+#define RDS_BUFFER_BARRIER() __sync_synchronize()
+#endif
+
+
+/// Single producer, single consumer ring buffer of RDS groups.
+class RDSBuffer
+{
+public:
+    RDSBuffer(); ///< create an empty buffer.
+
+    // ----- producer side -----
+
+    /// Add a group, returns false when the buffer is full and the group was dropped.
+    bool put(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4);
+
+    // ----- consumer side -----
+
+    /// Take the oldest group, returns false when the buffer is empty.
+    bool get(uint16_t *block1, uint16_t *block2, uint16_t *block3, uint16_t *block4);
+
+    byte available(); ///< Number of groups in the buffer.
+    void flush();     ///< Discard all groups in the buffer.
+
+    // ----- statistics -----
+
+    unsigned long getDropCount(); ///< Number of groups dropped because the buffer was full.
+    byte getHighWater();          ///< Highest number of groups that were in the buffer at the same time.
+
+    /// Clear the statistics.
+    /// The counters belong to the producer, so call this only when no put() can run at the same time.
+    void resetStatistics();
+
+private:
+    uint16_t _groups[RDS_BUFFER_SIZE][4]; ///< The blocks A, B, C and D of the groups.
+    volatile byte _head;  ///< Count of groups put, written by the producer only.
+    volatile byte _tail;  ///< Count of groups taken, written by the consumer only.
+    volatile unsigned long _drops; ///< Groups dropped, written by the producer only.
+    volatile byte _highWater;      ///< Maximal fill level, written by the producer only.
+}; // class RDSBuffer
@@ -0,0 +1,319 @@
+/// \file RDSCapture.cpp
+/// \brief Compact binary capture of RDS groups for recording in the field.
+///
+/// \details
+/// See RDSCapture.h.
+/// The writer keeps the time of the last group as the reader computes it from the 2 ms steps,
+/// so the rounding of the steps does not add up over a long capture.
+/// Every record is written as a whole, a flush never splits a record.
+
+#include "RDSCapture.h"
+
+#define RECORD_GROUP_ERRORS 0x40
+#define RECORD_GROUP_TIME   0x3F
+#define RECORD_PI           0xF0
+#define RECORD_TIME         0xF1
+#define RECORD_FREQUENCY    0xF2
+#define RECORD_START        0xF8
+
+#define GROUP_LEN 7
+#define TIME_STEP 2
+#define TIME_MAX  (RECORD_GROUP_TIME * TIME_STEP)
+
+
+// ----- writer -----
+
+RDSCaptureWriter::RDSCaptureWriter(byte *buffer, size_t size)
+{
+    _buffer = buffer;
+    _size = size;
+    _sendFlush = NULL;
+    restart();
+} // RDSCaptureWriter()
+
+
+void RDSCaptureWriter::attachFlushCallback(flushCaptureFunction newFunction)
+{
+    _sendFlush = newFunction;
+} // attachFlushCallback()
+
+
+void RDSCaptureWriter::restart()
+{
+    _flushed = 0;
+    _groups = 0;
+    _drops = 0;
+    _time = 0;
+    _pi = 0;
+    _run = false;
+    _timed = false;
+
+    byte *r = _buffer;
+    r[0] = RECORD_START;
+    r[1] = 'R';
+    r[2] = 'D';
+    r[3] = 'C';
+    r[4] = RDS_CAPTURE_VERSION;
+    _used = 5;
+} // restart()
+
+
+bool RDSCaptureWriter::_reserve(byte len)
+{
+    if (_used + len <= _size) return true;
+    if (!_sendFlush) return false;
+    flush();
+    return true;
+} // _reserve()
+
+
+bool RDSCaptureWriter::put(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4, byte errors)
+{
+    return put(block1, block2, block3, block4, errors, millis());
+} // put()
+
+
+bool RDSCaptureWriter::put(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4, byte errors, unsigned long time)
+{
+    byte *r;
+    unsigned long delta = time - _time;
+
+    if (!_timed || (delta > TIME_MAX))
+    {
+        if (!_reserve(5)) return _drop();
+        r = _buffer + _used;
+        r[0] = RECORD_TIME;
+        r[1] = time >> 24;
+        r[2] = time >> 16;
+        r[3] = time >> 8;
+        r[4] = time;
+        _used += 5;
+        _time = time;
+        _timed = true;
+        delta = 0;
+    }
+
+    if (!_run || (block1 != _pi))
+    {
+        if (!_reserve(3)) return _drop();
+        r = _buffer + _used;
+        r[0] = RECORD_PI;
+        r[1] = block1 >> 8;
+        r[2] = block1;
+        _used += 3;
+        _pi = block1;
+        _run = true;
+    }
+
+    if (!_reserve(errors ? GROUP_LEN + 1 : GROUP_LEN)) return _drop();
+    r = _buffer + _used;
+    r[0] = (delta / TIME_STEP) | (errors ? RECORD_GROUP_ERRORS : 0);
+    r[1] = block2 >> 8;
+    r[2] = block2;
+    r[3] = block3 >> 8;
+    r[4] = block3;
+    r[5] = block4 >> 8;
+    r[6] = block4;
+    if (errors) r[7] = errors;
+    _used += errors ? GROUP_LEN + 1 : GROUP_LEN;
+    _time += delta - (delta % TIME_STEP);
+    _groups++;
+    return true;
+} // put()
+
+
+bool RDSCaptureWriter::_drop()
+{
+    _drops++;
+    return false;
+} // _drop()
+
+
+bool RDSCaptureWriter::setFrequency(word frequency)
+{
+    if (!_reserve(3)) return false;
+    byte *r = _buffer + _used;
+    r[0] = RECORD_FREQUENCY;
+    r[1] = frequency >> 8;
+    r[2] = frequency;
+    _used += 3;
+    _run = false;
+    return true;
+} // setFrequency()
+
+
+void RDSCaptureWriter::flush()
+{
+    if (_sendFlush && _used) _sendFlush(_buffer, _used);
+    _flushed += _used;
+    _used = 0;
+} // flush()
+
+
+const byte *RDSCaptureWriter::getData()
+{
+    return _buffer;
+} // getData()
+
+
+size_t RDSCaptureWriter::getLength()
+{
+    return _used;
+} // getLength()
+
+
+unsigned long RDSCaptureWriter::getSize()
+{
+    return _flushed + _used;
+} // getSize()
+
+
+unsigned long RDSCaptureWriter::getGroupCount()
+{
+    return _groups;
+} // getGroupCount()
+
+
+unsigned long RDSCaptureWriter::getDropCount()
+{
+    return _drops;
+} // getDropCount()
+
+
+// ----- reader -----
+
+RDSCaptureReader::RDSCaptureReader()
+{
+    _parser = NULL;
+    _filter = NULL;
+    _sendGroup = NULL;
+    _sendFrequency = NULL;
+    reset();
+} // RDSCaptureReader()
+
+
+void RDSCaptureReader::attachParser(RDSParser *parser)
+{
+    _parser = parser;
+} // attachParser()
+
+
+void RDSCaptureReader::attachFilter(RDSBlockFilter *filter)
+{
+    _filter = filter;
+} // attachFilter()
+
+
+void RDSCaptureReader::attachGroupCallback(receiveCaptureGroupFunction newFunction)
+{
+    _sendGroup = newFunction;
+} // attachGroupCallback()
+
+
+void RDSCaptureReader::attachFrequencyCallback(receiveCaptureFrequencyFunction newFunction)
+{
+    _sendFrequency = newFunction;
+} // attachFrequencyCallback()
+
+
+void RDSCaptureReader::reset()
+{
+    _time = 0;
+    _groups = 0;
+    _pi = 0;
+    _frequency = 0;
+    _valid = true;
+} // reset()
+
+
+size_t RDSCaptureReader::decode(const byte *data, size_t len)
+{
+    size_t pos = 0;
+
+    while (_valid && (pos < len))
+    {
+        const byte *r = data + pos;
+        byte need;
+
+        if (r[0] < 0x80)
+            need = (r[0] & RECORD_GROUP_ERRORS) ? GROUP_LEN + 1 : GROUP_LEN;
+        else if ((r[0] == RECORD_PI) || (r[0] == RECORD_FREQUENCY))
+            need = 3;
+        else if ((r[0] == RECORD_TIME) || (r[0] == RECORD_START))
+            need = 5;
+        else
+        {
+            _valid = false;
+            break;
+        }
+        if (len - pos < need) break;
+
+        if (r[0] < 0x80)
+        {
+            _time += (r[0] & RECORD_GROUP_TIME) * TIME_STEP;
+            _group(_pi, (r[1] << 8) | r[2], (r[3] << 8) | r[4], (r[5] << 8) | r[6],
+                   (r[0] & RECORD_GROUP_ERRORS) ? r[7] : 0);
+        }
+        else if (r[0] == RECORD_PI)
+        {
+            _pi = (r[1] << 8) | r[2];
+        }
+        else if (r[0] == RECORD_TIME)
+        {
+            _time = ((unsigned long)r[1] << 24) | ((unsigned long)r[2] << 16) | ((unsigned long)r[3] << 8) | r[4];
+        }
+        else if (r[0] == RECORD_FREQUENCY)
+        {
+            _frequency = (r[1] << 8) | r[2];
+            _pi = 0;
+            if (_filter) _filter->reset();
+            if (_parser) _parser->processData(0, 0, 0, 0);
+            if (_sendFrequency) _sendFrequency(_frequency);
+        }
+        else
+        {
+            // a capture appended to another one.
+            if ((r[1] != 'R') || (r[2] != 'D') || (r[3] != 'C') || (r[4] > RDS_CAPTURE_VERSION))
+            {
+                _valid = false;
+                break;
+            }
+            _pi = 0;
+        }
+        pos += need;
+    } // while
+    return pos;
+} // decode()
+
+
+void RDSCaptureReader::_group(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4, byte errors)
+{
+    _groups++;
+    if (_sendGroup) _sendGroup(_time, block1, block2, block3, block4, errors);
+    if (_parser && (!_filter || _filter->filter(&block1, &block2, &block3, &block4, errors)))
+        _parser->processData(block1, block2, block3, block4);
+} // _group()
+
+
+bool RDSCaptureReader::isValid()
+{
+    return _valid;
+} // isValid()
+
+
+unsigned long RDSCaptureReader::getTime()
+{
+    return _time;
+} // getTime()
+
+
+word RDSCaptureReader::getFrequency()
+{
+    return _frequency;
+} // getFrequency()
+
+
+unsigned long RDSCaptureReader::getGroupCount()
+{
+    return _groups;
+} // getGroupCount()
@@ -0,0 +1,145 @@
+///
+/// \file RDSCapture.h
+/// \brief Compact binary capture of RDS groups for recording in the field.
+///
+/// \details
+/// The writer appends the groups to a buffer and passes the full buffer to a flush function,
+/// e.g. writing it to a SD card or the Serial port:
+///   byte captureBuffer[512];
+///   RDSCaptureWriter capture(captureBuffer, sizeof(captureBuffer));
+///   capture.attachFlushCallback(writeCapture);
+///   ...
+///   void RDS_process(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4) {
+///     capture.put(block1, block2, block3, block4);
+///     rds.processData(block1, block2, block3, block4);
+///   }
+/// Without a flush function the capture stops when the buffer is full and the groups are counted as dropped.
+/// Nothing is allocated, the buffer must hold at least RDS_CAPTURE_RECORD bytes.
+///
+/// The reader decodes a capture in pieces of any size and passes the groups to a group function
+/// and through an optional block filter to a parser:
+///   RDSCaptureReader reader;
+///   reader.attachFilter(&rdsFilter);
+///   reader.attachParser(&rds);
+///   while ((len = file.read(data + kept, sizeof(data) - kept)) > 0) {
+///     len += kept;
+///     size_t used = reader.decode(data, len);
+///     kept = len - used;
+///     memmove(data, data + used, kept);
+///   }
+///
+/// The capture is a sequence of records, the first byte tells the type:
+/// * 0x00..0x7F group: bit 6 set = an error byte follows, bits 5..0 = time since the last group in 2 ms.
+///   Then the blocks 2, 3 and 4 big endian and the error byte, see RDS_BLER(), when bit 6 is set.
+///   Block 1 is the PI of the last PI record, so a run of groups of a station has no block 1.
+/// * 0xF0 PI: 2 bytes block 1 of the following groups.
+/// * 0xF1 time: 4 bytes milliseconds, the time of the next group when it is more than 126 ms after the last one.
+/// * 0xF2 frequency: 2 bytes frequency in 10 kHz units, the radio was tuned.
+///   The PI of the groups before is not used any more, the reader passes a group with block 1 = 0 to the parser.
+/// * 0xF8 start: "RDC" and the version, the start of a capture.
+/// A group takes 7 bytes without and 8 bytes with errors,
+/// the same group as hex text "D3C2 0408 E309 5349" with a line end takes 20 bytes and more than 40 bytes with a time stamp.
+///
+/// History:
+/// --------
+/// * 17.10.2026 created.
+
+#pragma once
+
+#include <Arduino.h>
+#include "RDSParser.h"
+#include "RDSBlockFilter.h"
+
+/// Longest record of the capture in bytes.
+#define RDS_CAPTURE_RECORD 8
+
+/// Version of the capture format in the start record.
+#define RDS_CAPTURE_VERSION 1
+
+/// callback functions of the capture.
+extern "C" {
+typedef void(*flushCaptureFunction)(const byte *data, size_t len);
+typedef void(*receiveCaptureGroupFunction)(unsigned long time, uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4, byte errors);
+typedef void(*receiveCaptureFrequencyFunction)(word frequency);
+}
+
+
+/// Writes RDS groups into a fixed buffer in the capture format.
+/// Call the functions from one context only, e.g. the RDS function of the radio.
+class RDSCaptureWriter
+{
+public:
+    RDSCaptureWriter(byte *buffer, size_t size); ///< create a writer, the buffer starts with the start record.
+
+    void attachFlushCallback(flushCaptureFunction newFunction); ///< Register function for the full buffer.
+
+    /// Add a group received now, errors are the error levels of the blocks.
+    /// Returns false when the buffer is full and there is no flush function.
+    bool put(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4, byte errors = 0);
+
+    /// Add a group received at time in milliseconds, e.g. from a log.
+    bool put(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4, byte errors, unsigned long time);
+
+    bool setFrequency(word frequency); ///< Mark a change of the frequency in 10 kHz units.
+
+    void flush();                ///< Pass the records in the buffer to the flush function and empty the buffer.
+    void restart();              ///< Drop the records in the buffer and start a new capture.
+
+    const byte *getData();       ///< Records in the buffer, not yet flushed.
+    size_t getLength();          ///< Bytes in the buffer.
+    unsigned long getSize();     ///< Bytes of the capture, flushed or not.
+    unsigned long getGroupCount(); ///< Groups in the capture.
+    unsigned long getDropCount(); ///< Groups dropped because the buffer was full.
+
+private:
+    bool _reserve(byte len);     // make room for a record.
+    bool _drop();                // count a group that did not fit.
+
+    byte *_buffer;
+    size_t _size;
+    size_t _used;                ///< Bytes in the buffer.
+    flushCaptureFunction _sendFlush;
+    unsigned long _flushed;      ///< Bytes passed to the flush function.
+    unsigned long _groups;
+    unsigned long _drops;
+    unsigned long _time;         ///< Time of the last group as the reader will see it.
+    uint16_t _pi;                ///< Block 1 of the current run.
+    bool _run;                   ///< A PI record was written since the start or the last frequency.
+    bool _timed;                 ///< A time record was written.
+}; // class RDSCaptureWriter
+
+
+/// Decodes a capture and passes the groups on.
+class RDSCaptureReader
+{
+public:
+    RDSCaptureReader(); ///< create a reader for the start of a capture.
+
+    void attachParser(RDSParser *parser); ///< Pass the groups to a parser.
+    void attachFilter(RDSBlockFilter *filter); ///< Check the groups for the parser with a filter.
+    void attachGroupCallback(receiveCaptureGroupFunction newFunction); ///< Register function for the groups.
+    void attachFrequencyCallback(receiveCaptureFrequencyFunction newFunction); ///< Register function for frequency changes.
+
+    /// Decode the complete records of data. Returns the number of bytes used,
+    /// a record at the end that is not complete is left for the next call.
+    size_t decode(const byte *data, size_t len);
+
+    void reset();                ///< Start a new capture.
+    bool isValid();              ///< No unknown record or version was found.
+    unsigned long getTime();     ///< Time of the last group in milliseconds.
+    word getFrequency();         ///< Frequency of the last frequency record, 0 = none.
+    unsigned long getGroupCount(); ///< Groups decoded.
+
+private:
+    void _group(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4, byte errors);
+
+    RDSParser *_parser;
+    RDSBlockFilter *_filter;
+    receiveCaptureGroupFunction _sendGroup;
+    receiveCaptureFrequencyFunction _sendFrequency;
+    unsigned long _time;
+    unsigned long _groups;
+    uint16_t _pi;
+    word _frequency;
+    bool _valid;
+}; // class RDSCaptureReader
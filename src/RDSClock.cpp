@@ -0,0 +1,177 @@
+/// \file RDSClock.cpp
+/// \brief Local clock disciplined by the clock time (CT) of the RDS 4A groups.
+///
+/// \details
+/// See RDSClock.h.
+/// The clock is an anchor, the UTC at a millis() value, and the drift.
+/// The time at millis() t is the anchor plus (t - anchor) * (1 + drift / 10^6),
+/// the anchor moves to the reception of every accepted CT.
+/// The 4A group starts at the minute and is complete one group later, CT_DELAY is the time of the group.
+/// The drift is measured over the CTs since the clock was set, the delay of the reception cancels out.
+
+#include "RDSClock.h"
+
+#define CT_DELAY 88
+
+
+RDSClock::RDSClock()
+{
+    _drift = 0;
+    _rejects = 0;
+    _offset = 0;
+    clear();
+} // RDSClock()
+
+
+void RDSClock::clear()
+{
+    _valid = false;
+    _candidate = false;
+    _error = 0;
+} // clear()
+
+
+void RDSClock::_set(unsigned long utcSeconds, unsigned long at)
+{
+    _valid = true;
+    _candidate = false;
+    _utc = utcSeconds;
+    _ms = CT_DELAY;
+    _at = at;
+    _lastAt = at;
+    _refAt = at;
+    _refUtc = utcSeconds;
+    _error = 0;
+} // _set()
+
+
+unsigned long RDSClock::_elapsed(unsigned long at)
+{
+    unsigned long e = at - _at;
+    return e + (long)((int64_t)e * _drift / 1000000L);
+} // _elapsed()
+
+
+void RDSClock::update(unsigned long utcSeconds, char halfHoursOffset)
+{
+    update(utcSeconds, halfHoursOffset, millis());
+} // update()
+
+
+void RDSClock::update(unsigned long utcSeconds, char halfHoursOffset, unsigned long at)
+{
+    _offset = halfHoursOffset;
+    if (!_valid)
+    {
+        _set(utcSeconds, at);
+        return;
+    }
+
+    int64_t now = (int64_t)_utc * 1000 + _ms + _elapsed(at);   // ms of the clock at the reception.
+    int64_t received = (int64_t)utcSeconds * 1000 + CT_DELAY;
+    int64_t error = received - now;
+    long tolerance = RDS_CLOCK_TOLERANCE + (at - _lastAt) / 256;
+
+    if ((error > tolerance) || (error < -tolerance))
+    {
+        _rejects++;
+        if (_candidate)
+        {
+            // the clock is wrong when two CTs agree with each other.
+            unsigned long e = at - _candidateAt;
+            int64_t diff = ((int64_t)utcSeconds - (int64_t)_candidateUtc) * 1000
+                           - (e + (int64_t)e * _drift / 1000000L);
+            long limit = RDS_CLOCK_TOLERANCE + e / 256;
+            if ((diff <= limit) && (diff >= -limit))
+            {
+                _set(utcSeconds, at);
+                return;
+            }
+        }
+        _candidate = true;
+        _candidateAt = at;
+        _candidateUtc = utcSeconds;
+        return;
+    }
+
+    _candidate = false;
+    _error = (long)error;
+    now += error / 2;
+    _utc = now / 1000;
+    _ms = now % 1000;
+    _at = at;
+    _lastAt = at;
+
+    unsigned long span = at - _refAt;
+    if (span >= RDS_CLOCK_DRIFT_SPAN)
+    {
+        int64_t drift = (((int64_t)utcSeconds - (int64_t)_refUtc) * 1000 - span) * 1000000L / span;
+        if (drift > RDS_CLOCK_MAX_DRIFT) drift = RDS_CLOCK_MAX_DRIFT;
+        if (drift < -RDS_CLOCK_MAX_DRIFT) drift = -RDS_CLOCK_MAX_DRIFT;
+        _drift = (long)drift;
+    }
+} // update()
+
+
+bool RDSClock::isValid()
+{
+    return _valid;
+} // isValid()
+
+
+unsigned long RDSClock::getUTC(word *millis)
+{
+    if (!_valid)
+    {
+        if (millis) *millis = 0;
+        return 0;
+    }
+    unsigned long t = _ms + _elapsed(::millis());
+    if (millis) *millis = t % 1000;
+    return _utc + t / 1000;
+} // getUTC()
+
+
+unsigned long RDSClock::getLocalTime()
+{
+    return _valid ? getUTC() + _offset * 1800L : 0;
+} // getLocalTime()
+
+
+void RDSClock::getLocalTime(byte *hours, byte *minutes, byte *seconds)
+{
+    unsigned long t = getLocalTime();
+    *seconds = t % 60;
+    *minutes = (t / 60) % 60;
+    *hours = (t / 3600) % 24;
+} // getLocalTime()
+
+
+char RDSClock::getOffset()
+{
+    return _offset;
+} // getOffset()
+
+
+long RDSClock::getDrift()
+{
+    return _drift;
+} // getDrift()
+
+
+long RDSClock::getError()
+{
+    return _error;
+} // getError()
+
+
+unsigned long RDSClock::getAge()
+{
+    return _valid ? millis() - _lastAt : 0;
+} // getAge()
+
+
+unsigned long RDSClock::getRejectCount()
+{
+    return _rejects;
+} // getRejectCount()
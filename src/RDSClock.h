@@ -0,0 +1,84 @@
+///
+/// \file RDSClock.h
+/// \brief Local clock disciplined by the clock time (CT) of the RDS 4A groups.
+///
+/// \details
+/// Stations send the clock time once a minute, at the start of the minute.
+/// The clock keeps the time in between from millis() and answers the current time with a few operations,
+/// without the parser or the radio chip. The time function of the parser passes the CT on:
+///   RDSClock rdsClock;
+///   void onTime(unsigned long utcSeconds, char halfHoursOffset) {
+///     rdsClock.update(utcSeconds, halfHoursOffset);
+///   }
+///   rds.attachTimeCallback(onTime);
+///   ...
+///   if (rdsClock.isValid()) rdsClock.getLocalTime(&hours, &minutes, &seconds);
+/// When the groups are buffered before the parser runs, the time of the reception can be passed to update().
+///
+/// The resonator of a board runs off by up to 0.5%, several seconds in an hour.
+/// The clock measures this drift against the CT over at least RDS_CLOCK_DRIFT_SPAN and corrects the elapsed time with it.
+/// Every CT that fits the clock moves it by half of the difference, so the jitter of the reception is smoothed.
+/// A CT that is off by more than RDS_CLOCK_TOLERANCE plus 0.4% of the time since the last CT is rejected,
+/// some stations send a wrong CT. Two rejected CTs in a row that fit each other set the clock,
+/// e.g. after a wrong first CT. The drift is kept when the clock is cleared or set, it belongs to the board.
+///
+/// History:
+/// --------
+/// * 17.10.2026 created.
+
+#pragma once
+
+#include <Arduino.h>
+
+/// Largest difference in ms between a CT and the clock that is corrected, besides the drift since the last CT.
+#define RDS_CLOCK_TOLERANCE 1000
+
+/// Shortest time in ms between two CTs for a measurement of the drift.
+#define RDS_CLOCK_DRIFT_SPAN 120000UL
+
+/// Largest drift in ppm, a faster or slower resonator is not corrected completely.
+#define RDS_CLOCK_MAX_DRIFT 20000
+
+
+/// Clock with the time of the RDS CT.
+class RDSClock
+{
+public:
+    RDSClock(); ///< create a clock without time.
+
+    void update(unsigned long utcSeconds, char halfHoursOffset); ///< A CT received now.
+    void update(unsigned long utcSeconds, char halfHoursOffset, unsigned long at); ///< A CT received at millis() at.
+    void clear();                ///< Forget the time, e.g. when the station changed.
+
+    bool isValid();              ///< The clock has the time of a CT.
+    unsigned long getUTC(word *millis = NULL); ///< UTC in seconds since 1.1.1970 and the ms of the second.
+    unsigned long getLocalTime(); ///< Local time in seconds since 1.1.1970.
+    void getLocalTime(byte *hours, byte *minutes, byte *seconds); ///< Local time of the day.
+    char getOffset();            ///< Local time offset of the last CT in half hours.
+
+    long getDrift();             ///< Measured drift of millis() in ppm, positive when millis() is slow.
+    long getError();             ///< Difference in ms of the last accepted CT to the clock before it was moved.
+    unsigned long getAge();      ///< ms since the last accepted CT.
+    unsigned long getRejectCount(); ///< Number of rejected CTs.
+
+private:
+    unsigned long _elapsed(unsigned long at);          // ms since the anchor corrected by the drift.
+    void _set(unsigned long utcSeconds, unsigned long at); // set the clock and start a drift measurement.
+
+    bool _valid;
+    char _offset;
+    unsigned long _at;           ///< millis() of the anchor.
+    unsigned long _utc;          ///< UTC seconds at the anchor.
+    word _ms;                    ///< ms of the second at the anchor.
+    long _drift;                 ///< ppm.
+    long _error;
+
+    unsigned long _refAt;        ///< millis() of the first CT of the drift measurement.
+    unsigned long _refUtc;
+    unsigned long _lastAt;       ///< millis() of the last accepted CT.
+
+    bool _candidate;             ///< A rejected CT waits for a second one.
+    unsigned long _candidateAt;
+    unsigned long _candidateUtc;
+    unsigned long _rejects;
+}; // class RDSClock
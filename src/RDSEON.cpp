@@ -0,0 +1,301 @@
+/// \file RDSEON.cpp
+/// \brief Decoder for the Enhanced Other Networks information in 14A and 14B groups.
+///
+/// \details
+/// See RDSEON.h.
+/// Block 4 of both versions is the PI of the other network, bit 4 of block 2 is its TP flag.
+/// 14A groups have the variant in bits 3..0 of block 2 and its information in block 3,
+/// 14B groups have the TA flag of the other network in bit 3 of block 2.
+/// The slots are freed by moving the following networks of the probe sequence back,
+/// so a probe ends at the first unused slot.
+
+#include "RDSEON.h"
+
+#if (RDS_EON_NETWORKS & (RDS_EON_NETWORKS - 1))
+#error RDS_EON_NETWORKS must be a power of 2.
+#endif
+
+#define SLOT_MASK (RDS_EON_NETWORKS - 1)
+
+// flags of a network.
+#define EON_TP       0x01 // traffic program.
+#define EON_TA       0x02 // traffic announcement from variant 13 or 14B groups.
+#define EON_ANNOUNCE 0x04 // traffic announcement started by 14B groups and passed to the traffic function.
+
+#define VARIANT_PS_END 3
+#define VARIANT_AF     4
+#define VARIANT_MAPPED 5
+#define VARIANT_PTY    13
+#define VARIANT_PIN    14
+
+#define AF_CODE_MAX 204
+
+
+RDSEONDecoder::RDSEONDecoder()
+{
+    _sendTraffic = NULL;
+    clear();
+} // RDSEONDecoder()
+
+
+void RDSEONDecoder::clear()
+{
+    for (byte n = 0; n < RDS_EON_NETWORKS; n++)
+        _pi[n] = 0;
+    _count = 0;
+    _tick = 0;
+    _tunedPI = 0;
+} // clear()
+
+
+void RDSEONDecoder::attachTrafficCallback(receiveEONTrafficFunction newFunction)
+{
+    _sendTraffic = newFunction;
+} // attachTrafficCallback()
+
+
+void RDSEONDecoder::decode(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4)
+{
+    if (block1 != _tunedPI)
+    {
+        // groups of an other network are received while it is tuned.
+        if (find(block1) >= 0) return;
+        clear();
+        _tunedPI = block1;
+    }
+    if (!block4 || (block4 == _tunedPI)) return;
+
+    byte n = _add(block4);
+    _heard[n] = ++_tick;
+    _flags[n] = (_flags[n] & ~EON_TP) | ((block2 & 0x0010) ? EON_TP : 0);
+
+    if (block2 & 0x0800)
+    {
+        // 14B: start or end of a traffic announcement.
+        _traffic(n, block2 & 0x0008);
+        return;
+    }
+
+    byte variant = block2 & 0x0F;
+    byte high = block3 >> 8;
+    byte low = block3 & 0xFF;
+
+    if (variant <= VARIANT_PS_END)
+    {
+        _ps[n][2 * variant] = high;
+        _ps[n][2 * variant + 1] = low;
+    }
+    else if (variant == VARIANT_AF)
+    {
+        // other codes like the number of frequencies and fillers are skipped.
+        byte codes[2] = { high, low };
+        for (byte c = 0; c < 2; c++)
+        {
+            if ((codes[c] == 0) || (codes[c] > AF_CODE_MAX)) continue;
+            byte i = 0;
+            while ((i < _afCount[n]) && (_af[n][i] != codes[c])) i++;
+            if ((i == _afCount[n]) && (i < RDS_EON_AF)) _af[n][_afCount[n]++] = codes[c];
+        }
+    }
+    else if (variant < VARIANT_MAPPED + MAPPED)
+    {
+        if ((high == 0) || (high > AF_CODE_MAX) || (low == 0) || (low > AF_CODE_MAX)) return;
+        // update the pair of the tuned frequency, else use a free pair or the one of the variant.
+        byte i = 0;
+        while ((i < MAPPED) && (_mapped[n][i][0] != high)) i++;
+        if (i == MAPPED)
+        {
+            i = 0;
+            while ((i < MAPPED) && _mapped[n][i][0]) i++;
+            if (i == MAPPED) i = variant - VARIANT_MAPPED;
+        }
+        _mapped[n][i][0] = high;
+        _mapped[n][i][1] = low;
+    }
+    else if (variant == VARIANT_PTY)
+    {
+        _pty[n] = block3 >> 11;
+        if (block3 & 0x0001)
+            _flags[n] |= EON_TA;
+        else
+            _traffic(n, false);
+    }
+    else if (variant == VARIANT_PIN)
+    {
+        _pin[n] = block3;
+    }
+} // decode()
+
+
+/// Only 14B groups start an announcement, it ends with the TA flag cleared in both versions.
+void RDSEONDecoder::_traffic(byte n, bool ta)
+{
+    _flags[n] = (_flags[n] & ~EON_TA) | (ta ? EON_TA : 0);
+    if (ta != (bool)(_flags[n] & EON_ANNOUNCE))
+    {
+        _flags[n] ^= EON_ANNOUNCE;
+        if (_sendTraffic) _sendTraffic(_pi[n], ta);
+    }
+} // _traffic()
+
+
+byte RDSEONDecoder::_hash(uint16_t pi)
+{
+    return (byte)(pi ^ (pi >> 8)) & SLOT_MASK;
+} // _hash()
+
+
+int RDSEONDecoder::find(uint16_t pi)
+{
+    if (!pi) return -1;
+    byte s = _hash(pi);
+    for (byte p = 0; (p < RDS_EON_NETWORKS) && _pi[s]; p++)
+    {
+        if (_pi[s] == pi) return s;
+        s = (s + 1) & SLOT_MASK;
+    }
+    return -1;
+} // find()
+
+
+byte RDSEONDecoder::_add(uint16_t pi)
+{
+    int found = find(pi);
+    if (found >= 0) return found;
+
+    if (_count == RDS_EON_NETWORKS)
+    {
+        byte oldest = 0;
+        for (byte n = 1; n < RDS_EON_NETWORKS; n++)
+        {
+            if ((byte)(_tick - _heard[n]) > (byte)(_tick - _heard[oldest])) oldest = n;
+        }
+        _remove(oldest);
+    }
+
+    byte s = _hash(pi);
+    while (_pi[s]) s = (s + 1) & SLOT_MASK;
+    _pi[s] = pi;
+    memset(_ps[s], ' ', sizeof(_ps[s]));
+    _pty[s] = 0;
+    _flags[s] = 0;
+    _pin[s] = 0;
+    _afCount[s] = 0;
+    memset(_mapped[s], 0, sizeof(_mapped[s]));
+    _count++;
+    return s;
+} // _add()
+
+
+/// A network moves into the free slot when the free slot is not before its hash slot in the probe sequence.
+void RDSEONDecoder::_remove(byte n)
+{
+    byte hole = n;
+
+    _pi[hole] = 0;
+    for (byte s = (n + 1) & SLOT_MASK; _pi[s]; s = (s + 1) & SLOT_MASK)
+    {
+        byte home = _hash(_pi[s]);
+        if (((s - home) & SLOT_MASK) >= ((s - hole) & SLOT_MASK))
+        {
+            _copy(hole, s);
+            _pi[s] = 0;
+            hole = s;
+        }
+    }
+    _count--;
+} // _remove()
+
+
+void RDSEONDecoder::_copy(byte to, byte from)
+{
+    _pi[to] = _pi[from];
+    memcpy(_ps[to], _ps[from], sizeof(_ps[to]));
+    _pty[to] = _pty[from];
+    _flags[to] = _flags[from];
+    _pin[to] = _pin[from];
+    _afCount[to] = _afCount[from];
+    memcpy(_af[to], _af[from], sizeof(_af[to]));
+    memcpy(_mapped[to], _mapped[from], sizeof(_mapped[to]));
+    _heard[to] = _heard[from];
+} // _copy()
+
+
+byte RDSEONDecoder::getCount()
+{
+    return _count;
+} // getCount()
+
+
+uint16_t RDSEONDecoder::getPI(byte n)
+{
+    return (n < RDS_EON_NETWORKS) ? _pi[n] : 0;
+} // getPI()
+
+
+void RDSEONDecoder::getServiceName(byte n, char *name)
+{
+    if (getPI(n))
+        memcpy(name, _ps[n], sizeof(_ps[n]));
+    else
+        memset(name, ' ', sizeof(_ps[0]));
+    name[sizeof(_ps[0])] = '\0';
+} // getServiceName()
+
+
+byte RDSEONDecoder::getPTY(byte n)
+{
+    return getPI(n) ? _pty[n] : 0;
+} // getPTY()
+
+
+bool RDSEONDecoder::getTP(byte n)
+{
+    return getPI(n) && (_flags[n] & EON_TP);
+} // getTP()
+
+
+bool RDSEONDecoder::getTA(byte n)
+{
+    return getPI(n) && (_flags[n] & EON_TA);
+} // getTA()
+
+
+uint16_t RDSEONDecoder::getPIN(byte n)
+{
+    return getPI(n) ? _pin[n] : 0;
+} // getPIN()
+
+
+byte RDSEONDecoder::getAFCount(byte n)
+{
+    return getPI(n) ? _afCount[n] : 0;
+} // getAFCount()
+
+
+word RDSEONDecoder::getAF(byte n, byte i)
+{
+    return (i < getAFCount(n)) ? RDS_AF_FREQ(_af[n][i]) : 0;
+} // getAF()
+
+
+word RDSEONDecoder::getFrequency(uint16_t pi, word tuned)
+{
+    int n = find(pi);
+    if (n < 0) return 0;
+
+    if ((tuned > RDS_AF_FREQ(0)) && (tuned <= RDS_AF_FREQ(AF_CODE_MAX)))
+    {
+        byte code = RDS_AF_CODE(tuned);
+        for (byte i = 0; i < MAPPED; i++)
+        {
+            if (_mapped[n][i][0] == code) return RDS_AF_FREQ(_mapped[n][i][1]);
+        }
+    }
+    if (_afCount[n]) return RDS_AF_FREQ(_af[n][0]);
+    for (byte i = 0; i < MAPPED; i++)
+    {
+        if (_mapped[n][i][1]) return RDS_AF_FREQ(_mapped[n][i][1]);
+    }
+    return 0;
+} // getFrequency()
@@ -0,0 +1,107 @@
+///
+/// \file RDSEON.h
+/// \brief Decoder for the Enhanced Other Networks information in 14A and 14B groups.
+///
+/// \details
+/// A station sends information about the other networks (ON) of its broadcaster in 14A groups,
+/// 14B groups tell that a traffic announcement starts or ends on an ON.
+/// The decoder keeps a table of up to RDS_EON_NETWORKS other networks with
+/// * the PS name (variants 0..3) as received,
+/// * the AF list of method A (variant 4), up to RDS_EON_AF frequencies,
+/// * the mapped frequencies (variants 5..8): the frequency of the ON belonging to a frequency of the tuned network,
+/// * the PTY and TA (variant 13), the PIN (variant 14) and the TP of every group.
+/// Mapped AM frequencies (variant 9) and linkage information (variant 12) are ignored.
+///
+/// The decoder is registered for both versions:
+///   RDSEONDecoder eon;
+///   rds.attachGroupDecoder(RDS_GROUP_A(14), &eon);
+///   rds.attachGroupDecoder(RDS_GROUP_B(14), &eon);
+///   eon.attachTrafficCallback(onTraffic);
+///
+/// The traffic function is called when a 14B group starts or ends a traffic announcement on an ON.
+/// The frequency of the ON is known right away from the table, so the radio can switch without a scan:
+///   void onTraffic(uint16_t pi, bool ta) {
+///     if (ta) radio.startTraffic(eon.getFrequency(pi, radio.getFrequency()), pi);
+///   }
+///
+/// The table belongs to the tuned network. It is cleared when a 14A or 14B group of another network arrives
+/// that is not an ON in the table, the groups of an ON, e.g. during a traffic announcement, are ignored.
+/// A reset of the parser keeps the table, so it is still there after the return from an ON.
+///
+/// The fields are kept in separate arrays with a slot per network. The slot is found by a hash of the PI
+/// with linear probing, so a lookup takes a single probe in most cases.
+/// When the table is full the network heard least recently is replaced.
+/// Every network takes 32 bytes of RAM.
+///
+/// History:
+/// --------
+/// * 17.10.2026 created.
+
+#pragma once
+
+#include <Arduino.h>
+#include "RDSParser.h"
+
+/// Number of other networks in the table, a power of 2.
+#define RDS_EON_NETWORKS 8
+
+/// Number of AF codes kept for an other network.
+#define RDS_EON_AF 8
+
+/// callback function for the start and the end of a traffic announcement on an other network.
+extern "C" {
+typedef void(*receiveEONTrafficFunction)(uint16_t pi, bool ta);
+}
+
+
+/// Decoder for the 14A and 14B groups with a table of the other networks.
+/// The slots of the table are numbered 0..RDS_EON_NETWORKS-1, unused slots have the PI 0.
+class RDSEONDecoder : public RDSGroupDecoder
+{
+public:
+    RDSEONDecoder(); ///< create a decoder with an empty table.
+    void decode(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4);
+    void clear(); ///< Forget all other networks.
+
+    void attachTrafficCallback(receiveEONTrafficFunction newFunction); ///< Register function for traffic announcements.
+
+    int find(uint16_t pi);          ///< Slot of an other network or -1.
+    byte getCount();                ///< Number of other networks.
+    uint16_t getPI(byte n);         ///< PI of slot n, 0 = unused.
+    void getServiceName(byte n, char *name); ///< Copy the PS name of slot n into 9 characters, spaces when unknown.
+    byte getPTY(byte n);            ///< Program type of slot n.
+    bool getTP(byte n);             ///< Slot n is a traffic program.
+    bool getTA(byte n);             ///< Slot n sends a traffic announcement.
+    uint16_t getPIN(byte n);        ///< Program item number of slot n.
+    byte getAFCount(byte n);        ///< Number of AFs of slot n.
+    word getAF(byte n, byte i);     ///< AF i of slot n in 10 kHz units.
+
+    /// Frequency of an other network in 10 kHz units: the mapped frequency for the tuned frequency,
+    /// else its first AF or mapped frequency. 0 when the network or its frequency is unknown.
+    word getFrequency(uint16_t pi, word tuned);
+
+private:
+    static const byte MAPPED = 4;   ///< Mapped frequencies of a network, variants 5..8.
+
+    byte _hash(uint16_t pi);        ///< First slot probed for a PI.
+    byte _add(uint16_t pi);         ///< Slot of a network, a new one may replace the least recently heard.
+    void _remove(byte n);           ///< Free a slot and move the networks probed after it.
+    void _copy(byte to, byte from);
+    void _traffic(byte n, bool ta); ///< Set the TA flag of slot n and pass a start or end to the traffic function.
+
+    receiveEONTrafficFunction _sendTraffic; ///< Registered traffic function.
+    uint16_t _tunedPI;              ///< PI of the network the table belongs to, 0 = none.
+    byte _count;                    ///< Number of used slots.
+    byte _tick;                     ///< Counter of the received groups for _heard.
+
+    // the table, one array per field.
+    uint16_t _pi[RDS_EON_NETWORKS];
+    char _ps[RDS_EON_NETWORKS][8];
+    byte _pty[RDS_EON_NETWORKS];
+    byte _flags[RDS_EON_NETWORKS];  ///< TP, TA and the traffic announcement of 14B groups.
+    uint16_t _pin[RDS_EON_NETWORKS];
+    byte _afCount[RDS_EON_NETWORKS];
+    byte _af[RDS_EON_NETWORKS][RDS_EON_AF];      ///< AF codes.
+    byte _mapped[RDS_EON_NETWORKS][MAPPED][2];   ///< AF codes of the tuned network and of the other network.
+    byte _heard[RDS_EON_NETWORKS];  ///< _tick of the last group of the network.
+}; // class RDSEONDecoder
@@ -15,166 +15,802 @@
 
 #include "RDSParser.h"
 
-#define DEBUG_FUNC0(fn)          { Serial.print(fn); Serial.println("()"); }
-
 /// Setup the RDS object and initialize private variables to 0.
+/// Only the decoders the parser owns are referenced, the others are linked when the sketch creates them.
 RDSParser::RDSParser() {
-    memset(this, 0, sizeof(RDSParser));
-    psName=_PSName1;
-    pRdsText=rdsText1;
+    pty = 0;
+    _ptyCandidate = 0;
+    _sendPTY = NULL;
+    _cache = NULL;
+    _pi = 0;
+    _altFreq = NULL;
+    _oda = NULL;
+    memset(_decoders, 0, sizeof(_decoders));
+    _decoders[RDS_GROUP_A(0x0)] = &_serviceName;
+    _decoders[RDS_GROUP_B(0x0)] = &_serviceName;
+    _decoders[RDS_GROUP_A(0x2)] = &_radioText;
+    _decoders[RDS_GROUP_B(0x2)] = &_radioText;
+    _decoders[RDS_GROUP_A(0x4)] = &_clockTime;
 } // RDSParser()
 
 
+/// Reset all registered decoders.
+/// A decoder registered for more than one group code is reset once for each code.
 void RDSParser::init() {
-    strcpy(_PSName1, "--------");
-    strcpy(_PSName2, _PSName1);
-    strcpy(programServiceName, "        ");
-    memset(rdsText1, 0, sizeof(rdsText1));
-    _lastTextIDX = 0;
+    for (byte code = 0; code < RDS_GROUP_CODES; code++) {
+        if (_decoders[code]) _decoders[code]->reset();
+    } // for
 } // init()
 
 
 void RDSParser::attachServicenNameCallback(receiveServicenNameFunction newFunction)
 {
-    _sendServiceName = newFunction;
+    _serviceName.attachServicenNameCallback(newFunction);
 } // attachServicenNameCallback
 
 void RDSParser::attachTextCallback(receiveTextFunction newFunction)
 {
-    _sendText = newFunction;
+    _radioText.attachTextCallback(newFunction);
 } // attachTextCallback
 
+void RDSParser::attachTextSegmentCallback(receiveTextSegmentFunction newFunction)
+{
+    _radioText.attachTextSegmentCallback(newFunction);
+} // attachTextSegmentCallback
+
 
 void RDSParser::attachTimeCallback(receiveTimeFunction newFunction)
 {
-    _sendTime = newFunction;
+    _clockTime.attachTimeCallback(newFunction);
 } // attachTimeCallback
 
 
-void RDSParser::processData(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4)
+void RDSParser::attachPTYCallback(receivePTYFunction newFunction)
+{
+    _sendPTY = newFunction;
+} // attachPTYCallback
+
+
+void RDSParser::_setPTY(byte newPTY)
+{
+    pty = newPTY;
+    if (_sendPTY) _sendPTY(pty);
+} // _setPTY()
+
+
+void RDSParser::attachGroupDecoder(byte groupCode, RDSGroupDecoder *decoder)
 {
-    // DEBUG_FUNC0("process");
-    byte  idx, mins, hours;
-    char halfHoursOffset;
-    unsigned long modJulDayCode=0;
-    unsigned long utcSeconds=0;
+    if (groupCode < RDS_GROUP_CODES)
+        _decoders[groupCode] = decoder;
+} // attachGroupDecoder
 
-    // Serial.print('('); Serial.print(block1, HEX); Serial.print(' '); Serial.print(block2, HEX); Serial.print(' '); Serial.print(block3, HEX); Serial.print(' '); Serial.println(block4, HEX);
 
-    if (block1 == 0) {
-        // reset all the RDS info.
-        init();
-        // Send out empty data
-        if (_sendServiceName) _sendServiceName(programServiceName);
-        if (_sendText)        _sendText("");
+/// The 0A groups pass the AF decoder and go on to the Program Service name.
+void RDSParser::attachAFDecoder(RDSAlternativeFrequencyDecoder *decoder)
+{
+    _altFreq = decoder;
+    if (decoder) decoder->setNextDecoder(&_serviceName);
+    _decoders[RDS_GROUP_A(0x0)] = decoder ? (RDSGroupDecoder *)decoder : &_serviceName;
+} // attachAFDecoder
+
+
+/// A registry that is replaced puts back the decoders it routed.
+void RDSParser::attachODARegistry(RDSODARegistry *registry)
+{
+    if (_oda)
+    {
+        _oda->reset();
+        _oda->setTable(NULL);
+    }
+    _oda = registry;
+    if (registry) registry->setTable(_decoders);
+    _decoders[RDS_GROUP_A(0x3)] = registry;
+} // attachODARegistry
+
+
+RDSRadioTextDecoder *RDSParser::getTextDecoder()
+{
+    return &_radioText;
+} // getTextDecoder
+
+
+void RDSParser::attachStationCache(RDSStationCache *cache)
+{
+    _cache = cache;
+} // attachStationCache
+
+
+/// Information that is not confirmed keeps the value in the cache.
+void RDSParser::_saveStation()
+{
+    if (!_cache || !_pi) return;
+
+    RDS_STATION_INFO *info = _cache->add(_pi);
+    const char *ps = _serviceName.getServiceName();
+
+    info->pty = pty;
+    if (ps[0] && strncmp(ps, "        ", sizeof(info->ps))) memcpy(info->ps, ps, sizeof(info->ps));
+    _radioText.getText(info->rt);
+    if (_altFreq && _altFreq->isComplete())
+    {
+        info->afCount = 0;
+        for (byte n = 0; (n < _altFreq->getAFCount()) && (info->afCount < RDS_CACHE_AF); n++)
+        {
+            if (!_altFreq->isRegional(n)) info->af[info->afCount++] = RDS_AF_CODE(_altFreq->getAF(n));
+        }
+    }
+} // _saveStation()
+
+
+/// The decoders replace the cached information when the received information is confirmed.
+void RDSParser::_loadStation()
+{
+    RDS_STATION_INFO *info = _cache ? _cache->find(_pi) : NULL;
+
+    if (!info) return;
+    _setPTY(info->pty);
+    if (info->ps[0]) _serviceName.setServiceName(info->ps);
+    if (info->rt[0]) _radioText.setText(info->rt);
+    if (_altFreq && info->afCount) _altFreq->setAFList(_pi, info->af, info->afCount);
+} // _loadStation()
+
+
+/// A group with block 1 = 0 tells that the station changed, all RDS info is reset.
+void RDSParser::_reset()
+{
+    _saveStation();
+    _pi = 0;
+    _ptyCandidate = 0;
+    init();
+    // Send out empty data
+    _serviceName.sendServiceName();
+    _radioText.sendText();
+    _setPTY(0);
+} // _reset()
+
+
+/// The group type and the version are the group code in the upper 5 bits of block 2.
+inline void RDSParser::_process(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4)
+{
+    if (block1 == 0)
+    {
+        _reset();
         return;
-    } // if
+    }
+    // the first group of a station.
+    if (!_pi)
+    {
+        _pi = block1;
+        _loadStation();
+    }
+    _pi = block1;
+
+    byte groupPTY = (block2 >> 5) & 0x1F;
+    if ((groupPTY == _ptyCandidate) && (groupPTY != pty)) _setPTY(groupPTY);
+    _ptyCandidate = groupPTY;
+
+    RDSGroupDecoder *decoder = _decoders[block2 >> 11];
+    if (decoder)
+    {
+        decoder->decode(block1, block2, block3, block4);
+    }
+} // _process()
+
+
+void RDSParser::processData(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4)
+{
+    _process(block1, block2, block3, block4);
+} // processData()
+
+
+void RDSParser::processGroups(const uint16_t *blocks, size_t n)
+{
+    for (const uint16_t *end = blocks + 4 * n; blocks < end; blocks += 4)
+    {
+        _process(blocks[0], blocks[1], blocks[2], blocks[3]);
+    }
+} // processGroups()
+
+
+// ----- Program Service name -----
+
+RDSServiceNameDecoder::RDSServiceNameDecoder() {
+    _sendServiceName = NULL;
+    memset(programServiceName, 0, sizeof(programServiceName));
+    memset(_psCandidate, 0, sizeof(_psCandidate));
+    memset(_psConfirm, 0, sizeof(_psConfirm));
+    _psErrors = false;
+} // RDSServiceNameDecoder()
+
+
+void RDSServiceNameDecoder::reset() {
+    strcpy(programServiceName, "        ");
+    memset(_psCandidate, 0, sizeof(_psCandidate));
+    memset(_psConfirm, 0, sizeof(_psConfirm));
+} // reset()
+
+
+void RDSServiceNameDecoder::attachServicenNameCallback(receiveServicenNameFunction newFunction)
+{
+    _sendServiceName = newFunction;
+} // attachServicenNameCallback
+
+
+void RDSServiceNameDecoder::sendServiceName()
+{
+    if (_sendServiceName) _sendServiceName(programServiceName);
+} // sendServiceName()
+
+
+/// The received name is only passed on when it differs from the known name.
+void RDSServiceNameDecoder::setServiceName(const char *name)
+{
+    memcpy(programServiceName, name, 8);
+    programServiceName[8] = '\0';
+    sendServiceName();
+} // setServiceName()
+
+
+const char *RDSServiceNameDecoder::getServiceName()
+{
+    return programServiceName;
+} // getServiceName()
+
+
+/// The 0A group allow to transmit basic data (TA, M/S, DI, C1/C0) as well as Alternatives Frequency (AF) and the name of radio (PS Name).
+/// The 0B group transmits the same without AF, the name is in block 4 in both versions.
+void RDSServiceNameDecoder::decode(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4)
+{
+    (void)block1;
+    (void)block3;
 
-    // analyzing Block 1 = Program Identification Code
-    countryCode=block1>>12;
-    progAreaCoverage=lowByte(block1>>8);
-    progRefNr=lowByte(block1);
+    // The data received is part of the Service Station Name
+    byte idx = block2 & 0x0003;
+    char *segment = &_psCandidate[idx<<1];
 
-    // analyzing Block 2
-    gtype = block2 >> 12;
-    b0 = bitRead(block2, 11);
-    tp = bitRead(block2, 10);
-    pty = (block2>>5) & 0x1F;
-    app = block2 & 0x1F;
+    // new data is 2 chars from block 4
+    char c1 = highByte(block4);
+    char c2 = lowByte(block4);
 
-    if(!b0)
+    if ((segment[0] == c1) && (segment[1] == c2))
     {
-        //A-version
-        switch(gtype)
+        if (_psConfirm[idx] <= PS_CONFIRM) _psConfirm[idx]++;
+    }
+    else
+    {
+        // a single other reception between two of the published segment was an error.
+        char *published = &programServiceName[idx<<1];
+        if ((_psConfirm[idx] == 1) && (published[0] == c1) && (published[1] == c2))
         {
-        case 0x0:
-            //The 0A group allow to transmit basic data (TA, M/S, DI, C1/C0) as well as Alternatives Frequency (AF) and the name of radio (PS Name)
-            // The data received is part of the Service Station Name
-            idx = app & 0x0003;
+            _psErrors = true;
+            _psErrorTime = millis();
+        }
+        // a new or changed segment restarts the confirmation of this segment only.
+        segment[0] = c1;
+        segment[1] = c2;
+        _psConfirm[idx] = 1;
+    }
+
+    if (_psErrors && (millis() - _psErrorTime >= PS_ERROR_TIME)) _psErrors = false;
+    byte confirm = _psErrors ? PS_CONFIRM + 1 : PS_CONFIRM;
+    if (_psConfirm[idx] < confirm) return;
+    for (byte n = 0; n < 4; n++)
+    {
+        if (_psConfirm[n] < confirm) return;
+    }
+    if (strncmp(programServiceName, _psCandidate, sizeof(_psCandidate)))
+    {
+        memcpy(programServiceName, _psCandidate, sizeof(_psCandidate));
+        programServiceName[8] = '\0';
+        sendServiceName();
+    }
+} // decode()
+
+
+// ----- Alternative frequencies -----
+
+RDSAlternativeFrequencyDecoder::RDSAlternativeFrequencyDecoder() {
+    _next = NULL;
+    _sendAFList = NULL;
+    _pi = 0;
+    _frequency = 0;
+    _clear();
+} // RDSAlternativeFrequencyDecoder()
+
+
+void RDSAlternativeFrequencyDecoder::reset() {
+    _clear();
+    if (_next) _next->reset();
+} // reset()
+
+
+void RDSAlternativeFrequencyDecoder::_clear() {
+    _expected = _tuned = _count = 0;
+    _methodB = _changed = _otherList = false;
+    _regional = 0;
+} // _clear()
+
+
+/// The list is cleared by the first start of a received list.
+void RDSAlternativeFrequencyDecoder::setAFList(uint16_t pi, const byte *codes, byte count)
+{
+    _clear();
+    _pi = pi;
+    _count = count < RDS_AF_MAX ? count : RDS_AF_MAX;
+    memcpy(_codes, codes, _count);
+    sendAFList();
+} // setAFList()
+
+
+void RDSAlternativeFrequencyDecoder::attachAFListCallback(receiveAFListFunction newFunction)
+{
+    _sendAFList = newFunction;
+} // attachAFListCallback
+
+
+void RDSAlternativeFrequencyDecoder::setNextDecoder(RDSGroupDecoder *next)
+{
+    _next = next;
+} // setNextDecoder()
+
+
+/// The frequency is kept when the station changes, RADIO::attachAFDecoder() lets the radio set it with every tune.
+void RDSAlternativeFrequencyDecoder::setFrequency(word freq)
+{
+    _frequency = ((freq > RDS_AF_FREQ(0)) && (freq <= RDS_AF_FREQ(204))) ? RDS_AF_CODE(freq) : 0;
+} // setFrequency()
+
+
+byte RDSAlternativeFrequencyDecoder::getAFCount() { return _count; }
+word RDSAlternativeFrequencyDecoder::getAF(byte n) { return n < _count ? RDS_AF_FREQ(_codes[n]) : 0; }
+bool RDSAlternativeFrequencyDecoder::isRegional(byte n) { return n < _count && bitRead(_regional, n); }
+bool RDSAlternativeFrequencyDecoder::isMethodB() { return _methodB; }
+bool RDSAlternativeFrequencyDecoder::isComplete() { return _expected && (_count >= _expected); }
+
+
+/// The frequencies are converted only for the call.
+void RDSAlternativeFrequencyDecoder::sendAFList()
+{
+    word freqs[RDS_AF_MAX];
+    byte count = 0;
+
+    if (!_sendAFList) return;
+    for (byte n = 0; n < _count; n++)
+    {
+        if (!bitRead(_regional, n)) freqs[count++] = RDS_AF_FREQ(_codes[n]);
+    }
+    _sendAFList(_pi, freqs, count);
+} // sendAFList()
+
+
+/// Add a frequency to the list and pass the list on when it is complete.
+void RDSAlternativeFrequencyDecoder::_add(byte code, bool regional)
+{
+    byte n;
+
+    if ((code == 0) || (code >= AF_FILLER)) return;
+    for (n = 0; (n < _count) && (_codes[n] != code); n++);
+    if (n == _count)
+    {
+        if (_count == RDS_AF_MAX) return;
+        _codes[_count++] = code;
+        _changed = true;
+    }
+    if (bitRead(_regional, n) != regional)
+    {
+        bitWrite(_regional, n, regional);
+        _changed = true;
+    }
+    if (_changed && _expected && (_count >= _expected))
+    {
+        _changed = false;
+        sendAFList();
+    }
+} // _add()
+
+
+/// Block 3 of the 0A group carries 2 AF codes, the 0B group repeats the PI there.
+void RDSAlternativeFrequencyDecoder::decode(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4)
+{
+    if (!bitRead(block2, 11))
+    {
+        byte c1 = highByte(block3);
+        byte c2 = lowByte(block3);
 
-            // new data is 2 chars from block 4
-            psName[idx<<1]=highByte(block4);
-            psName[(idx<<1)+1]=lowByte(block4);
+        if (block1 != _pi)
+        {
+            // the list of another station.
+            _pi = block1;
+            _clear();
+        }
 
-            if(idx==3)
+        if ((c1 >= AF_COUNT) && (c1 <= AF_COUNT + RDS_AF_MAX))
+        {
+            // start of a list, the list of the tuned transmitter replaces a list collected before.
+            byte expected = c1 - AF_COUNT;
+            bool tuned = _frequency && (c2 == _frequency);
+            _otherList = _expected && (c2 != _tuned) && !tuned;
+            if (_otherList)
             {
-                if(!strncmp(_PSName1, _PSName2, sizeof(_PSName1)))
-                {
-                    strcpy(programServiceName, _PSName1);
-                    if (_sendServiceName)
-                    {
-                        _sendServiceName(programServiceName);
-                    }
-                }
-                psName = psName==_PSName1 ? _PSName2 : _PSName1;
-                memset(psName, 0, sizeof(_PSName1));
+                // the list of another transmitter follows.
+                _methodB = true;
             }
-            break;
-        case 0x2:
-            //This 2A group allows to transmit data of radiotext, with a maximum of 64 characters
-            _textAB = bitRead(app,4);
-            if (_textAB != _last_textAB) {
-                _last_textAB = _textAB;
-                memset(pRdsText, 0, sizeof(rdsText1));
+            else if ((expected != _expected) || (c2 != _tuned))
+            {
+                // a new or changed list, pairs received before the start may belong to another list.
+                _count = 0;
+                _regional = 0;
+                _expected = expected;
+                _tuned = c2;
+                _add(c2, false);
             }
-            idx = app & 0x000F;
-            pRdsText[idx<<2]=highByte(block3);
-            pRdsText[(idx<<2)+1]=lowByte(block3);
-            pRdsText[(idx<<2)+2]=highByte(block4);
-            pRdsText[(idx<<2)+3]=lowByte(block4);
-            if (!idx)
+        }
+        else if ((c1 != AF_LFMF) && !_otherList)
+        {
+            if (_tuned && ((c1 == _tuned) || (c2 == _tuned)))
             {
-                if( ((strlen(rdsText1)==sizeof(rdsText1)-1) || strchr(rdsText1,'\r')) &&
-                        (strlen(rdsText1)==strlen(rdsText2)) &&
-                        (!strncmp(rdsText1, rdsText2, sizeof(rdsText1))) )
-                {
-                    char* pc;
-                    if(pc=strchr(rdsText1,'\r'))
-                    {
-                        *(pc+1)='\0';
-                    }
-                    strncpy(rdsText, rdsText1, sizeof(rdsText1));
-                    if (_sendText)
-                    {
-                        _sendText(rdsText);
-                    }
-                }
-                pRdsText = pRdsText==rdsText1 ? rdsText2 : rdsText1;
+                // method B: the higher frequency first marks a regional variant.
+                _methodB = true;
+                _add(c1 == _tuned ? c2 : c1, c1 > c2);
             }
-            break;
-        case 0x3:
-            //The group 3A is used to transmit the identification of the applications for free usage (ODA) as well as the groups used for these applications
-            break;
-        case 0x4:
-            //The transmitted clock-time and date shall be accurately set to UTC plus local offset time. Otherwise the
-            //transmitted CT codes shall all be set to zero
-            modJulDayCode = ((block2 & 0x3) << 15) | ((block3 & 0xFFFE) >> 1);
-            mins = (block4 >> 6) & 0x3F;
-            hours =  ((block3 & 0x0001) << 4) | ((block4 >> 12) & 0x0F);
-            //Conversion to UTC from https://en.wikipedia.org/wiki/Julian_day
-            utcSeconds= (modJulDayCode - 40587) * 86400 + hours * 3600 + mins * 60;
-            halfHoursOffset = !bitRead(block4, 5) ? block4 & 0x1F : -(block4 & 0x1F);
-            if(_sendTime)
+            else if (!_methodB)
             {
-                _sendTime(utcSeconds, halfHoursOffset);
-            } // if
-            break;
-        case 0x8:
-            //The 8A group can be used for Open Data Architecture (ODA) or for Traffic Message Chanel (TMC)
-            break;
-        case 0xE:
-            //The 14A group is used to send EON (Enhanced Other Network) information
-            break;
-        default:
-            //Serial.println(gtype);
-            break;
+                _add(c1, false);
+                _add(c2, false);
+            }
         }
     }
+    if (_next) _next->decode(block1, block2, block3, block4);
+} // decode()
+
+
+// ----- RadioText -----
+
+RDSRadioTextDecoder::RDSRadioTextDecoder() {
+    _sendText = NULL;
+    _sendTextSegment = NULL;
+    _textAB = _versionB = false;
+    _message = 0;
+    _clear();
+} // RDSRadioTextDecoder()
+
+
+void RDSRadioTextDecoder::reset() {
+    _clear();
+} // reset()
+
+
+void RDSRadioTextDecoder::_clear() {
+    memset(_text, ' ', sizeof(_text) - 1);
+    _text[sizeof(_text) - 1] = '\0';
+    _segments = 0;
+    _confirmed = 0;
+    _complete = false;
+    _message++;
+} // _clear()
+
+
+void RDSRadioTextDecoder::attachTextCallback(receiveTextFunction newFunction)
+{
+    _sendText = newFunction;
+} // attachTextCallback
+
+
+void RDSRadioTextDecoder::attachTextSegmentCallback(receiveTextSegmentFunction newFunction)
+{
+    _sendTextSegment = newFunction;
+} // attachTextSegmentCallback
+
+
+void RDSRadioTextDecoder::sendText()
+{
+    _send(_sendText, NULL, _complete ? _length() : 0, 0);
+} // sendText()
+
+
+/// The known text fills the segments that are not received yet.
+void RDSRadioTextDecoder::setText(const char *text)
+{
+    byte length;
+
+    _clear();
+    for (length = 0; (length < sizeof(_text) - 1) && text[length]; length++) _text[length] = text[length];
+    _send(_sendText, NULL, length, 0);
+} // setText()
+
+
+byte RDSRadioTextDecoder::getText(char *text)
+{
+    if (!_complete) return 0;
+    byte length = _length();
+    memset(text, 0, sizeof(_text) - 1);
+    memcpy(text, _text, length);
+    return length;
+} // getText()
+
+
+const char *RDSRadioTextDecoder::getBuffer()
+{
+    return _text;
+} // getBuffer()
+
+
+bool RDSRadioTextDecoder::isConfirmed(byte start, byte length)
+{
+    byte chars = _versionB ? 2 : 4;
+    if (!length || (start + length > 16 * chars)) return false;
+    for (byte seg = start / chars; seg <= (start + length - 1) / chars; seg++)
+    {
+        if (!bitRead(_confirmed, seg)) return false;
+    }
+    return true;
+} // isConfirmed()
+
+
+byte RDSRadioTextDecoder::getMessage()
+{
+    return _message;
+} // getMessage()
+
+
+/// Pass the first length characters of the buffer as a string.
+/// The character after the text is only replaced by the terminating 0 during the call.
+void RDSRadioTextDecoder::_send(receiveTextFunction fn, receiveTextSegmentFunction segmentFn, byte length, byte segment)
+{
+    char c = _text[length];
+    _text[length] = '\0';
+    if (fn) fn(_text);
+    if (segmentFn) segmentFn(_text, segment);
+    _text[length] = c;
+} // _send()
+
+
+/// Returns the length of the message including the '\r' when all its segments are confirmed, else 0.
+byte RDSRadioTextDecoder::_length()
+{
+    byte chars = _versionB ? 2 : 4;
+    for (byte seg = 0; seg < 16; seg++)
+    {
+        if (!bitRead(_confirmed, seg)) return 0;
+        for (byte n = seg * chars; n < (seg + 1) * chars; n++)
+        {
+            if (_text[n] == '\r') return n + 1;
+        }
+    }
+    return 16 * chars;
+} // _length()
+
+
+/// The 2A group allows to transmit data of radiotext, with a maximum of 64 characters, 4 per group.
+/// The 2B group allows a maximum of 32 characters, 2 per group in block 4.
+void RDSRadioTextDecoder::decode(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4)
+{
+    (void)block1;
+    bool versionB = bitRead(block2, 11);
+    bool textAB = bitRead(block2, 4);
+    byte idx = block2 & 0x000F;
+    char chars[4];
+    byte count;
+
+    if ((textAB != _textAB) || (versionB != _versionB)) {
+        _textAB = textAB;
+        _versionB = versionB;
+        // a known text is kept until segments are received.
+        if (_segments) _clear();
+    }
+    if (versionB)
+    {
+        chars[0] = highByte(block4);
+        chars[1] = lowByte(block4);
+        count = 2;
+    }
     else
     {
-        //B-version
-        //Serial.println(gtype);
+        chars[0] = highByte(block3);
+        chars[1] = lowByte(block3);
+        chars[2] = highByte(block4);
+        chars[3] = lowByte(block4);
+        count = 4;
     }
-} // processData()
+
+    char *p = &_text[idx * count];
+    if (bitRead(_segments, idx) && !memcmp(p, chars, count))
+    {
+        // repeated segment.
+        if (bitRead(_confirmed, idx)) return;
+        bitSet(_confirmed, idx);
+    }
+    else
+    {
+        memcpy(p, chars, count);
+        bitSet(_segments, idx);
+        bitClear(_confirmed, idx);
+        _complete = false;
+    }
+
+    byte length = _complete ? 0 : _length();
+    if (_sendTextSegment && !bitRead(_confirmed, idx))
+    {
+        // the text so far ends at the message end or after the last received segment.
+        byte end = length;
+        if (!end)
+        {
+            for (byte seg = 0; seg < 16; seg++) if (bitRead(_segments, seg)) end = (seg + 1) * count;
+            for (byte n = 0; n < end; n++) if (_text[n] == '\r') { end = n + 1; break; }
+        }
+        _send(NULL, _sendTextSegment, end, idx);
+    }
+    if (length)
+    {
+        _complete = true;
+        _send(_sendText, NULL, length, 0);
+    }
+} // decode()
+
+
+// ----- Open Data Applications -----
+
+/// Group codes that may carry the data of an ODA: 3B, 4B, 5A..7B, 8A, 9A, 9B, 10B and 11A..13B.
+#define ODA_GROUP_CODES 0x0FEDFE80UL
+
+/// Announced group code 0 is an application without data groups, 31 is a temporary fault of the encoder.
+#define ODA_NO_GROUP    0
+#define ODA_FAULT_GROUP 31
+
+RDSODARegistry::RDSODARegistry() {
+    _table = NULL;
+    _sendODA = NULL;
+    _count = 0;
+    _decoderCount = 0;
+} // RDSODARegistry()
+
+
+/// The decoders are reset here, they are not in the dispatch table any more.
+void RDSODARegistry::reset() {
+    for (byte d = 0; d < _decoderCount; d++) {
+        _unroute(d);
+        _decoders[d]->reset();
+    }
+    _count = 0;
+} // reset()
+
+
+bool RDSODARegistry::attachDecoder(uint16_t aid, RDSODADecoder *decoder)
+{
+    byte d = 0;
+    while ((d < _decoderCount) && (_decoderAids[d] != aid)) d++;
+
+    if (d < _decoderCount) {
+        _unroute(d);
+        if (!decoder) {
+            // move the last decoder into the gap.
+            _decoderCount--;
+            _decoderAids[d] = _decoderAids[_decoderCount];
+            _decoders[d] = _decoders[_decoderCount];
+            _routes[d] = _routes[_decoderCount];
+            _replaced[d] = _replaced[_decoderCount];
+            return true;
+        }
+    } else {
+        if (!decoder) return true;
+        if (_decoderCount == RDS_ODA_DECODERS) return false;
+        _decoderCount++;
+        _decoderAids[d] = aid;
+        _routes[d] = NO_ROUTE;
+    }
+    _decoders[d] = decoder;
+    byte code = getGroupCode(aid);
+    if (code < RDS_GROUP_CODES) _route(d, code);
+    return true;
+} // attachDecoder()
+
+
+void RDSODARegistry::attachODACallback(receiveODAFunction newFunction)
+{
+    _sendODA = newFunction;
+} // attachODACallback
+
+
+void RDSODARegistry::setTable(RDSGroupDecoder **decoders)
+{
+    _table = decoders;
+} // setTable()
+
+
+byte RDSODARegistry::getCount() { return _count; }
+uint16_t RDSODARegistry::getAID(byte n) { return n < _count ? _aids[n] : 0; }
+
+
+byte RDSODARegistry::getGroupCode(uint16_t aid)
+{
+    for (byte n = 0; n < _count; n++) {
+        if (_aids[n] == aid) return _codes[n];
+    }
+    return RDS_GROUP_CODES;
+} // getGroupCode()
+
+
+/// Block 2 has the announced group code in bits 4..0, block 3 the message bits and block 4 the AID.
+void RDSODARegistry::decode(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4)
+{
+    (void)block1;
+    byte code = block2 & 0x1F;
+    uint16_t aid = block4;
+
+    if (!aid || (code == ODA_FAULT_GROUP)) return;
+
+    byte n = 0;
+    while ((n < _count) && (_aids[n] != aid)) n++;
+    if ((n == _count) && (_count < RDS_ODA_MAX)) {
+        _aids[_count++] = aid;
+        _codes[n] = NO_ROUTE;
+    }
+    if ((n < _count) && (_codes[n] != code)) {
+        _codes[n] = code;
+        if (_sendODA) _sendODA(aid, code, block3);
+    }
+
+    for (byte d = 0; d < _decoderCount; d++) {
+        if (_decoderAids[d] == aid) {
+            _route(d, code);
+            _decoders[d]->announce(code, block3);
+            break;
+        }
+    }
+} // decode()
+
+
+/// A group code that is not allowed for an ODA or routed to another application is not routed.
+void RDSODARegistry::_route(byte d, byte groupCode)
+{
+    if (_routes[d] == groupCode) return;
+    _unroute(d);
+    if ((groupCode == ODA_NO_GROUP) || !bitRead(ODA_GROUP_CODES, groupCode)) return;
+    for (byte o = 0; o < _decoderCount; o++) {
+        if (_routes[o] == groupCode) return;
+    }
+    _replaced[d] = _table[groupCode];
+    _table[groupCode] = _decoders[d];
+    _routes[d] = groupCode;
+} // _route()
+
+
+void RDSODARegistry::_unroute(byte d)
+{
+    if (_routes[d] == NO_ROUTE) return;
+    _table[_routes[d]] = _replaced[d];
+    _routes[d] = NO_ROUTE;
+} // _unroute()
+
+
+// ----- Clock time -----
+
+RDSClockTimeDecoder::RDSClockTimeDecoder() {
+    _sendTime = NULL;
+} // RDSClockTimeDecoder()
+
+
+void RDSClockTimeDecoder::attachTimeCallback(receiveTimeFunction newFunction)
+{
+    _sendTime = newFunction;
+} // attachTimeCallback
+
+
+/// The transmitted clock-time and date shall be accurately set to UTC plus local offset time. Otherwise the
+/// transmitted CT codes shall all be set to zero
+void RDSClockTimeDecoder::decode(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4)
+{
+    (void)block1;
+    unsigned long modJulDayCode = ((unsigned long)(block2 & 0x3) << 15) | ((block3 & 0xFFFE) >> 1);
+    byte mins = (block4 >> 6) & 0x3F;
+    byte hours =  ((block3 & 0x0001) << 4) | ((block4 >> 12) & 0x0F);
+    //Conversion to UTC from https://en.wikipedia.org/wiki/Julian_day
+    unsigned long utcSeconds= (modJulDayCode - 40587) * 86400 + hours * 3600UL + mins * 60;
+    char halfHoursOffset = !bitRead(block4, 5) ? block4 & 0x1F : -(block4 & 0x1F);
+    if(_sendTime)
+    {
+        _sendTime(utcSeconds, halfHoursOffset);
+    } // if
+} // decode()
 
 // End.
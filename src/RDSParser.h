@@ -8,6 +8,24 @@
 /// See http://www.mathertel.de/License.aspx
 /// 
 /// \details
+/// The groups are dispatched by their group code to the registered decoders.
+/// The group code is the upper 5 bits of block 2: group type number * 2 + version (0 = A, 1 = B).
+/// The parser registers its own decoders for the Program Service name (0A, 0B),
+/// the RadioText (2A, 2B) and the clock time (4A).
+/// The decoder of the alternative frequencies and the registry of the Open Data Applications are created
+/// by the sketch when it needs them and attached with attachAFDecoder() and attachODARegistry(),
+/// so their code and RAM is only used then.
+/// More decoders can be implemented by deriving from RDSGroupDecoder and registered with attachGroupDecoder().
+/// RDSTMCDecoder in RDSTMC.h decodes the traffic messages of 8A groups this way.
+/// RDSEONDecoder in RDSEON.h decodes the other networks of 14A and 14B groups.
+/// Open Data Applications are announced in 3A groups with their application identification (AID)
+/// and the group type carrying their data. Decoders for an ODA are registered by the AID with RDSODARegistry::attachDecoder(),
+/// the group type is routed to them when a station announces it:
+///   RDSODARegistry oda;
+///   rds.attachODARegistry(&oda);
+///   oda.attachDecoder(0xCD46, &tmc);
+/// The program type (PTY) of block 2 is published when 2 groups in a row carry a new one.
+/// With a RDSStationCache attached the information of a station received before is published with its first group.
 ///
 /// More documentation and source code is available at http://www.mathertel.de/Arduino
 ///
@@ -16,6 +34,16 @@
 /// * 01.09.2014 created and RDS sender name working.
 /// * 01.11.2014 RDS time added.
 /// * 27.03.2015 Reset RDS data by sending a 0 in blockA in the case the frequency changes.
+/// * 17.10.2026 table driven group dispatch, PS from 0B and RadioText from 2B groups.
+/// * 17.10.2026 PS name is confirmed per segment and published as soon as all segments are confirmed.
+/// * 17.10.2026 RadioText in a single buffer, delivered per segment and as complete message.
+/// * 17.10.2026 AF lists of method A and B from 0A groups.
+/// * 17.10.2026 station cache for publishing known stations right away.
+/// * 17.10.2026 Open Data Applications from 3A groups routed to registered decoders.
+/// * 17.10.2026 processGroups() for recorded groups, no debug output in the group path.
+/// * 17.10.2026 AF decoder and ODA registry attached by the sketch, the parser takes about 182 bytes of RAM on AVR.
+/// * 17.10.2026 PTY function, the cached PTY is published with PS and RadioText.
+/// * 17.10.2026 PS segments need one more confirmation while the reception has errors.
 /// 
 
 
@@ -23,14 +51,247 @@
 #define __RDSPARSER_H__
 
 #include <Arduino.h>
+#include "RDSStationCache.h"
 
 /// callback function for passing a ServicenName 
 extern "C" {
 typedef void(*receiveServicenNameFunction)(const char *name);
 typedef void(*receiveTextFunction)(const char *name);
+typedef void(*receiveTextSegmentFunction)(const char *text, byte segment);
 typedef void(*receiveTimeFunction)(unsigned long utcSeconds, char halfHoursOffset);
+typedef void(*receivePTYFunction)(byte pty);
+typedef void(*receiveAFListFunction)(uint16_t pi, const word *freqs, byte count);
+typedef void(*receiveODAFunction)(uint16_t aid, byte groupCode, uint16_t message);
 }
 
+/// Group code of a group type number and version.
+#define RDS_GROUP_A(type) ((byte)((type) << 1))
+#define RDS_GROUP_B(type) ((byte)(((type) << 1) | 1))
+
+/// Number of group codes.
+#define RDS_GROUP_CODES 32
+
+/// Maximum number of frequencies in an AF list.
+#define RDS_AF_MAX 25
+
+/// Number of Open Data Applications of a station that are kept.
+#define RDS_ODA_MAX 8
+
+/// Number of decoders for Open Data Applications.
+#define RDS_ODA_DECODERS 4
+
+/// Frequency in 10 kHz units of an AF code 1..204.
+#define RDS_AF_FREQ(code) (8750 + (word)(code) * 10)
+
+/// AF code of a frequency in 10 kHz units.
+#define RDS_AF_CODE(freq) ((byte)(((freq) - 8750) / 10))
+
+
+/// Interface of a decoder for one or more RDS group types.
+class RDSGroupDecoder
+{
+public:
+    /// Decode a group. block2 contains the group code, the version and the common fields.
+    virtual void decode(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4) = 0;
+
+    /// Forget all data, the station has changed.
+    virtual void reset() {}
+}; // RDSGroupDecoder
+
+
+/// Interface of a decoder for an Open Data Application.
+class RDSODADecoder : public RDSGroupDecoder
+{
+public:
+    /// The application is announced in a 3A group with the group code of its data and the message bits of block 3.
+    virtual void announce(byte groupCode, uint16_t message) { (void)groupCode; (void)message; }
+}; // RDSODADecoder
+
+
+/// Decoder for the Program Service name from 0A and 0B groups.
+/// Each of the 4 segments of 2 characters is confirmed on its own by receiving it PS_CONFIRM times in a row.
+/// A segment of the published name that is received once with other characters shows errors of the reception,
+/// the same error can arrive twice. Then a segment needs one more equal reception for PS_ERROR_TIME msec.
+/// Names that change, e.g. scrolling text, do not go back to the published segment after a single reception.
+/// The errors are kept by reset() for this time, they belong to the reception and not to the station.
+/// The name is published when all segments are confirmed and it differs from the last published name.
+class RDSServiceNameDecoder : public RDSGroupDecoder
+{
+public:
+    static const byte PS_CONFIRM = 2; ///< Number of equal receptions that confirm a segment.
+    static const word PS_ERROR_TIME = 10000; ///< Time in msec after an error until PS_CONFIRM receptions are enough again.
+
+    RDSServiceNameDecoder();
+    void decode(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4);
+    void reset();
+
+    void attachServicenNameCallback(receiveServicenNameFunction newFunction); ///< Register function for displaying a new Service Name.
+    void sendServiceName(); ///< Pass the current Service Name to the registered function.
+    void setServiceName(const char *name); ///< Publish the 8 characters of a known name until the received one is confirmed.
+    const char *getServiceName(); ///< The last published name.
+
+private:
+    receiveServicenNameFunction _sendServiceName; ///< Registered ServiceName function.
+    char programServiceName[10];    // found station name or empty. Is max. 8 character long.
+    char _psCandidate[8];           // last received characters of each segment.
+    byte _psConfirm[4];             // number of times the segment was received unchanged.
+    bool _psErrors;                 // a segment error was received less than PS_ERROR_TIME ago.
+    unsigned long _psErrorTime;     // millis() of the last segment error.
+}; // RDSServiceNameDecoder
+
+
+/// Decoder for the alternative frequencies in block 3 of 0A groups.
+/// The list belongs to the PI of the station and is cleared when the PI changes.
+/// A list starts with a pair of the number of frequencies and the first frequency.
+/// Method A sends the other frequencies in pairs.
+/// Method B pairs every frequency with the tuned frequency, the order of the pair marks regional variants.
+/// A method B station sends the lists of all its transmitters. The list that starts with the frequency
+/// given to setFrequency() is collected, without a frequency the first list that is received.
+/// A radio sets the frequency after every tune when the decoder is attached to it:
+///   radio.attachAFDecoder(&af);
+/// The list without regional variants is passed to the AF list function when it is complete and whenever it grows.
+/// The group is passed on to the next decoder, the parser sets its decoder of the Program Service name.
+///   RDSAlternativeFrequencyDecoder af;
+///   rds.attachAFDecoder(&af);
+///   af.attachAFListCallback(onAFList);
+class RDSAlternativeFrequencyDecoder : public RDSGroupDecoder
+{
+public:
+    RDSAlternativeFrequencyDecoder();
+    void decode(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4);
+    void reset();
+
+    void attachAFListCallback(receiveAFListFunction newFunction); ///< Register function for a new AF list.
+    void setNextDecoder(RDSGroupDecoder *next); ///< Decoder receiving the groups afterwards.
+    void setFrequency(word freq); ///< The tuned frequency in 10 kHz units, 0 = unknown. Selects the method B list.
+    void sendAFList(); ///< Pass the current AF list to the registered function.
+    void setAFList(uint16_t pi, const byte *codes, byte count); ///< Publish a known list until the received list starts.
+
+    byte getAFCount();           ///< Number of frequencies received so far, including regional variants.
+    word getAF(byte n);          ///< Frequency n in 10 kHz units.
+    bool isRegional(byte n);     ///< Frequency n carries a regional variant of the program.
+    bool isMethodB();            ///< The station uses method B.
+    bool isComplete();           ///< All announced frequencies are received.
+
+private:
+    static const byte AF_COUNT = 224;  // code of an empty list, 225..249 announce 1..25 frequencies.
+    static const byte AF_FILLER = 205; // filler code.
+    static const byte AF_LFMF = 250;   // the next code is a LF/MF frequency.
+
+    void _clear();
+    void _add(byte code, bool regional);
+
+    RDSGroupDecoder *_next;             ///< Decoder receiving the group afterwards.
+    receiveAFListFunction _sendAFList;  ///< Registered AF list function.
+    uint16_t _pi;               // PI the list belongs to.
+    byte _expected;             // announced number of frequencies, 0 = no list start received.
+    byte _tuned;                // first code of the list, the tuned frequency for method B.
+    byte _frequency;            // AF code of the frequency the radio is tuned to, 0 = unknown.
+    bool _methodB;              // pairs with the tuned frequency were received.
+    bool _changed;              // the list changed since it was passed on.
+    bool _otherList;            // the pairs belong to the list of another transmitter.
+    byte _count;                // number of codes in the list.
+    uint32_t _regional;         // bitmap of the regional variants in the list.
+    byte _codes[RDS_AF_MAX];    // AF codes 1..204.
+}; // RDSAlternativeFrequencyDecoder
+
+
+/// Decoder for the RadioText from 2A groups (64 characters) and 2B groups (32 characters).
+/// The text is collected in one buffer, a bitmap marks the 16 segments that are received.
+/// Every segment that changes the text is passed to the segment function with the text so far,
+/// missing segments are filled with spaces.
+/// A segment is confirmed when it is received twice with the same characters.
+/// The message is complete when all segments up to the one with the terminating '\r' are confirmed,
+/// or all 16 segments when there is no '\r'. It is passed once to the text function.
+/// A change of the A/B flag or the version starts a new message.
+/// Decoders that refer to the text, like RT+, read the buffer and the confirmed segments directly.
+class RDSRadioTextDecoder : public RDSGroupDecoder
+{
+public:
+    RDSRadioTextDecoder();
+    void decode(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4);
+    void reset();
+
+    void attachTextCallback(receiveTextFunction newFunction); ///< Register the function for displaying a rds text.
+    void attachTextSegmentCallback(receiveTextSegmentFunction newFunction); ///< Register the function for a partial text.
+    void sendText(); ///< Pass the complete text or an empty text to the registered function.
+    void setText(const char *text); ///< Publish a known text of up to 64 characters until segments are received.
+    byte getText(char *text); ///< Copy the complete text into 64 characters filled up with 0, returns its length or 0.
+    const char *getBuffer();  ///< The 64 characters of the text as received so far, missing segments are spaces.
+    bool isConfirmed(byte start, byte length); ///< All characters from start on are in confirmed segments.
+    byte getMessage();        ///< Number of the message in the buffer, it changes with every new message.
+
+private:
+    void _clear();              // start a new message.
+    byte _length();             // length of the complete message or 0.
+    void _send(receiveTextFunction fn, receiveTextSegmentFunction segmentFn, byte length, byte segment);
+
+    receiveTextFunction _sendText;               ///< Registered Text function.
+    receiveTextSegmentFunction _sendTextSegment; ///< Registered Text segment function.
+    bool _textAB;               // A/B-flag for radio text.
+    bool _versionB;             // The text is sent in 2B groups.
+    bool _complete;             // The message was passed to the text function.
+    uint16_t _segments;         // Bitmap of the received segments.
+    uint16_t _confirmed;        // Bitmap of the confirmed segments.
+    byte _message;              // Number of the message, counted by _clear().
+    char _text[64 + 1];
+}; // RDSRadioTextDecoder
+
+
+/// Decoder for the clock time from 4A groups.
+class RDSClockTimeDecoder : public RDSGroupDecoder
+{
+public:
+    RDSClockTimeDecoder();
+    void decode(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4);
+
+    void attachTimeCallback(receiveTimeFunction newFunction); ///< Register function for displaying a new time
+
+private:
+    receiveTimeFunction _sendTime; ///< Registered Time function.
+}; // RDSClockTimeDecoder
+
+
+/// Decoder for the announcements of Open Data Applications in 3A groups.
+/// The group code announced for an AID is kept for up to RDS_ODA_MAX applications of the station.
+/// A decoder registered for the AID is put into the dispatch table of the parser for this group code
+/// and gets every 3A group of its AID through announce().
+/// Only the group types that may carry an ODA are routed, a decoder that was registered for the group code
+/// before is put back when the station changes or announces another group type.
+/// The groups of an application without a decoder find no decoder in the dispatch table.
+class RDSODARegistry : public RDSGroupDecoder
+{
+public:
+    RDSODARegistry(); ///< create a registry, it routes into the dispatch table of the parser it is attached to.
+    void decode(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4);
+    void reset();
+
+    bool attachDecoder(uint16_t aid, RDSODADecoder *decoder); ///< Register or remove the decoder of an application, false when full.
+    void attachODACallback(receiveODAFunction newFunction); ///< Register function for a new or changed announcement.
+    void setTable(RDSGroupDecoder **decoders); ///< Dispatch table to route into, NULL when detached.
+
+    byte getCount();                  ///< Number of applications announced by the station.
+    uint16_t getAID(byte n);          ///< AID of application n.
+    byte getGroupCode(uint16_t aid);  ///< Group code of an application, RDS_GROUP_CODES when it is not announced.
+
+private:
+    static const byte NO_ROUTE = RDS_GROUP_CODES;
+
+    void _route(byte d, byte groupCode);  // route the group code to decoder d.
+    void _unroute(byte d);                // put back the decoder that was replaced by decoder d.
+
+    RDSGroupDecoder **_table;             ///< Dispatch table of the parser.
+    receiveODAFunction _sendODA;          ///< Registered ODA function.
+    byte _count;                          // number of announced applications.
+    uint16_t _aids[RDS_ODA_MAX];          // announced applications.
+    byte _codes[RDS_ODA_MAX];             // group codes of the announced applications.
+    byte _decoderCount;                   // number of registered decoders.
+    uint16_t _decoderAids[RDS_ODA_DECODERS];
+    RDSODADecoder *_decoders[RDS_ODA_DECODERS];
+    byte _routes[RDS_ODA_DECODERS];       // group code routed to the decoder or NO_ROUTE.
+    RDSGroupDecoder *_replaced[RDS_ODA_DECODERS]; // decoder of the group code before the routing.
+}; // RDSODARegistry
+
 
 /// Library for parsing RDS data values and extracting information.
 class RDSParser
@@ -44,32 +305,50 @@ public:
     /// Pass all available RDS data through this function.
     void processData(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4);
 
+    /// Pass n groups of 4 blocks each, e.g. from a recorded log, like n calls of processData().
+    void processGroups(const uint16_t *blocks, size_t n);
+
     void attachServicenNameCallback(receiveServicenNameFunction newFunction); ///< Register function for displaying a new Service Name.
     void attachTextCallback(receiveTextFunction newFunction); ///< Register the function for displaying a rds text.
+    void attachTextSegmentCallback(receiveTextSegmentFunction newFunction); ///< Register the function for displaying a partial rds text.
     void attachTimeCallback(receiveTimeFunction newFunction); ///< Register function for displaying a new time
+    void attachPTYCallback(receivePTYFunction newFunction); ///< Register function for a new program type.
+
+    /// Register a decoder for a group code, replacing the decoder registered before. NULL ignores the group.
+    void attachGroupDecoder(byte groupCode, RDSGroupDecoder *decoder);
+
+    /// Decode the alternative frequencies of the 0A groups with decoder, NULL for none.
+    void attachAFDecoder(RDSAlternativeFrequencyDecoder *decoder);
+
+    /// Route the Open Data Applications announced in 3A groups by registry, NULL for none.
+    void attachODARegistry(RDSODARegistry *registry);
+
+    RDSRadioTextDecoder *getTextDecoder(); ///< The decoder of the RadioText for decoders that refer to the text.
+
+    /// Keep the information of the stations in a cache, NULL for no cache.
+    void attachStationCache(RDSStationCache *cache);
 
 private:
-    // ----- actual RDS values
-    byte gtype, pty, countryCode, progAreaCoverage, progRefNr, app, _lastTextIDX;
-    bool
-    b0,//message version A or B
-    tp,//traffic program
-    _textAB, _last_textAB;// A/B-flag for radio text.
-
-    // Program Service Name
-    char _PSName1[9]; // including trailing '\00' character.
-    char _PSName2[9]; // including trailing '\00' character.
-    char* psName;
-    char programServiceName[10];    // found station name or empty. Is max. 8 character long.
-    char rdsText1[64 + 1];
-    char rdsText2[64 + 1];
-    char* pRdsText;
-    char rdsText[64+1];
-    receiveServicenNameFunction _sendServiceName; ///< Registered ServiceName function.
-    receiveTimeFunction _sendTime; ///< Registered Time function.
-    receiveTextFunction _sendText;
-    unsigned long ulTimeStamp=0;
+    void _saveStation(); // keep the confirmed information of the station in the cache.
+    void _loadStation(); // publish the cached information of the station.
+    void _reset();       // the station changed.
+    void _process(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4);
+
+    void _setPTY(byte newPTY); // publish a program type.
+
+    byte pty;            ///< Published program type.
+    byte _ptyCandidate;  ///< Program type of the last group.
+    receivePTYFunction _sendPTY; ///< Registered PTY function.
+
+    RDSGroupDecoder *_decoders[RDS_GROUP_CODES]; ///< Decoders by group code.
+    RDSStationCache *_cache; ///< Cache of the stations or NULL.
+    uint16_t _pi;            ///< PI of the last group, 0 after a reset.
+    RDSAlternativeFrequencyDecoder *_altFreq; ///< Attached AF decoder or NULL.
+    RDSODARegistry *_oda;    ///< Attached ODA registry or NULL.
 
+    RDSServiceNameDecoder _serviceName;
+    RDSRadioTextDecoder _radioText;
+    RDSClockTimeDecoder _clockTime;
 }; //RDSParser
 
 #endif //__RDSPARSER_H__
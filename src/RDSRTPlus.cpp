@@ -0,0 +1,174 @@
+/// \file RDSRTPlus.cpp
+/// \brief Decoder for the RadioText Plus (RT+) Open Data Application.
+///
+/// \details
+/// See RDSRTPlus.h.
+/// The 37 bits of an RT+ group start in bit 4 of block 2: the item toggle bit, the item running bit
+/// and two tags. A tag is a content type of 6 bits, a start of 6 bits and a length of 6 bits for the first
+/// and of 5 bits for the second tag. The length is sent as the number of characters after the first one.
+/// The RadioText groups are passed on to the RadioText decoder like the AF decoder passes the 0A groups on,
+/// after each of them the waiting tags are checked again.
+
+#include "RDSRTPlus.h"
+
+/// Content types up to this one describe the running item.
+#define ITEM_TYPES RDS_RTP_ITEM_GENRE
+
+#define TEXT_LENGTH 64
+
+
+RDSRTPlusDecoder::RDSRTPlusDecoder(RDSParser *parser)
+{
+    _text = parser->getTextDecoder();
+    _sendTag = NULL;
+    _groups = 0;
+    reset();
+} // RDSRTPlusDecoder()
+
+
+/// The RadioText decoder is not in the dispatch table when the RadioText groups are passed through this decoder.
+void RDSRTPlusDecoder::reset()
+{
+    _text->reset();
+    _toggle = 0xFF;
+    _running = false;
+    _waiting = false;
+    _clear();
+    _groupMessage = _message;
+} // reset()
+
+
+void RDSRTPlusDecoder::_clear()
+{
+    _count = 0;
+    _sent = 0;
+    _message = _text->getMessage();
+} // _clear()
+
+
+/// The tags are dropped when a new message starts, only the tags waiting for it are kept.
+void RDSRTPlusDecoder::_checkMessage()
+{
+    if (_message == _text->getMessage()) return;
+    if (_waiting)
+    {
+        _waiting = false;
+        _message = _text->getMessage();
+    }
+    else
+    {
+        _clear();
+    }
+} // _checkMessage()
+
+
+void RDSRTPlusDecoder::attachTagCallback(receiveRTPlusFunction newFunction)
+{
+    _sendTag = newFunction;
+} // attachTagCallback()
+
+
+unsigned long RDSRTPlusDecoder::getGroupCount()
+{
+    return _groups;
+} // getGroupCount()
+
+
+const char *RDSRTPlusDecoder::getText()
+{
+    return _text->getBuffer();
+} // getText()
+
+
+bool RDSRTPlusDecoder::isItemRunning()
+{
+    return _running;
+} // isItemRunning()
+
+
+bool RDSRTPlusDecoder::getTag(byte contentType, byte *start, byte *length)
+{
+    if (_waiting || (_message != _text->getMessage())) return false;
+    for (byte n = 0; n < _count; n++)
+    {
+        if ((_types[n] == contentType) && _text->isConfirmed(_starts[n], _lengths[n]))
+        {
+            *start = _starts[n];
+            *length = _lengths[n];
+            return true;
+        }
+    }
+    return false;
+} // getTag()
+
+
+/// The data is only sent in version A groups.
+void RDSRTPlusDecoder::decode(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4)
+{
+    byte groupCode = block2 >> 11;
+    if ((groupCode == RDS_GROUP_A(2)) || (groupCode == RDS_GROUP_B(2)))
+    {
+        _text->decode(block1, block2, block3, block4);
+        _checkMessage();
+        _send();
+        return;
+    }
+    if (bitRead(block2, 11)) return;
+    _groups++;
+
+    byte toggle = bitRead(block2, 4);
+    byte message = _text->getMessage();
+    _running = bitRead(block2, 3);
+    if (toggle != _toggle)
+    {
+        // the tags of a new item belong to the next message, unless it started since the last RT+ group.
+        _waiting = (_toggle != 0xFF) && (message == _groupMessage);
+        _toggle = toggle;
+        _clear();
+    }
+    else
+    {
+        _checkMessage();
+    }
+    _groupMessage = message;
+
+    _add(((block2 & 0x07) << 3) | (block3 >> 13), (block3 >> 7) & 0x3F, ((block3 >> 1) & 0x3F) + 1);
+    _add(((block3 & 0x01) << 5) | (block4 >> 11), (block4 >> 5) & 0x3F, (block4 & 0x1F) + 1);
+    _send();
+} // decode()
+
+
+/// A tag replaces the tag of the same content type, a changed tag is passed on again.
+void RDSRTPlusDecoder::_add(byte contentType, byte start, byte length)
+{
+    if ((contentType == RDS_RTP_DUMMY) || (start + length > TEXT_LENGTH)) return;
+    if ((contentType <= ITEM_TYPES) && !_running) return;
+
+    byte n = 0;
+    while ((n < _count) && (_types[n] != contentType)) n++;
+    if (n == _count)
+    {
+        if (_count == RDS_RTP_TAGS) return;
+        _count++;
+    }
+    else if ((_starts[n] == start) && (_lengths[n] == length))
+    {
+        return;
+    }
+    _types[n] = contentType;
+    _starts[n] = start;
+    _lengths[n] = length;
+    bitClear(_sent, n);
+} // _add()
+
+
+void RDSRTPlusDecoder::_send()
+{
+    if (_waiting) return;
+    for (byte n = 0; n < _count; n++)
+    {
+        if (bitRead(_sent, n) || !_text->isConfirmed(_starts[n], _lengths[n])) continue;
+        bitSet(_sent, n);
+        if (_sendTag) _sendTag(_types[n], _text->getBuffer(), _starts[n], _lengths[n]);
+    }
+} // _send()
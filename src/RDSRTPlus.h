@@ -0,0 +1,114 @@
+///
+/// \file RDSRTPlus.h
+/// \brief Decoder for the RadioText Plus (RT+) Open Data Application.
+///
+/// \details
+/// RT+ marks parts of the RadioText with content types like the title and the artist of the running item.
+/// It is an Open Data Application with the AID 0x4BD7, the decoder is registered with the parser it reads the text from.
+/// The RadioText groups are registered as well, the decoder passes them on to the RadioText decoder of the parser
+/// and sees when the characters of a tag are confirmed:
+///   RDSRTPlusDecoder rtplus(&rds);
+///   oda.attachDecoder(RDS_RTP_AID, &rtplus);
+///   rds.attachGroupDecoder(RDS_GROUP_A(2), &rtplus);
+///   rds.attachGroupDecoder(RDS_GROUP_B(2), &rtplus);
+///   rtplus.attachTagCallback(onTag);
+///
+/// Every RT+ group carries two tags of a content type, the start and the length in the RadioText.
+/// A tag is passed to the tag function once, as soon as the characters it marks are confirmed by the RadioText decoder.
+/// Without the RadioText groups this is checked with the next RT+ group only.
+/// The function gets the text buffer of the RadioText decoder with the start and the length of the tag,
+/// the text is not copied and not terminated behind the tag:
+///   void onTag(byte contentType, const char *text, byte start, byte length) {
+///     if (contentType == RDS_RTP_ITEM_TITLE) display.print(text + start, length);
+///   }
+///
+/// The tags belong to the message of the RadioText they were received with, a new message drops them.
+/// A change of the item toggle bit starts a new item and drops all tags, the tags of the new item wait
+/// for the next message of the RadioText when it did not start before, stations change the A/B flag of the RadioText with the item.
+/// the item tags are ignored while the item running bit is cleared.
+/// Nothing is allocated, the decoder keeps up to RDS_RTP_TAGS tags of different content types.
+///
+/// History:
+/// --------
+/// * 17.10.2026 created.
+
+#pragma once
+
+#include <Arduino.h>
+#include "RDSParser.h"
+
+/// Application identification of RT+.
+#define RDS_RTP_AID 0x4BD7
+
+/// Number of tags kept for the current item.
+#define RDS_RTP_TAGS 6
+
+/// Content types of the RT+ tags.
+#define RDS_RTP_DUMMY            0
+#define RDS_RTP_ITEM_TITLE       1
+#define RDS_RTP_ITEM_ALBUM       2
+#define RDS_RTP_ITEM_TRACKNUMBER 3
+#define RDS_RTP_ITEM_ARTIST      4
+#define RDS_RTP_ITEM_COMPOSITION 5
+#define RDS_RTP_ITEM_MOVEMENT    6
+#define RDS_RTP_ITEM_CONDUCTOR   7
+#define RDS_RTP_ITEM_COMPOSER    8
+#define RDS_RTP_ITEM_BAND        9
+#define RDS_RTP_ITEM_COMMENT     10
+#define RDS_RTP_ITEM_GENRE       11
+#define RDS_RTP_INFO_NEWS        12
+#define RDS_RTP_INFO_WEATHER     25
+#define RDS_RTP_INFO_TRAFFIC     26
+#define RDS_RTP_INFO_URL         29
+#define RDS_RTP_STATIONNAME_LONG 32
+#define RDS_RTP_PROGRAMME_NOW    33
+#define RDS_RTP_PROGRAMME_NEXT   34
+#define RDS_RTP_PROGRAMME_HOST   36
+#define RDS_RTP_PHONE_HOTLINE    41
+#define RDS_RTP_PHONE_STUDIO     42
+
+
+/// callback function for a tag of the RadioText.
+extern "C" {
+typedef void(*receiveRTPlusFunction)(byte contentType, const char *text, byte start, byte length);
+}
+
+
+/// Decoder for the RT+ groups.
+class RDSRTPlusDecoder : public RDSODADecoder
+{
+public:
+    RDSRTPlusDecoder(RDSParser *parser); ///< create a decoder for the RadioText of parser.
+    void decode(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4);
+    void reset();
+
+    void attachTagCallback(receiveRTPlusFunction newFunction); ///< Register function for the tags.
+
+    /// Start and length of the confirmed tag of a content type in getText(). Returns false when there is none.
+    bool getTag(byte contentType, byte *start, byte *length);
+    const char *getText();   ///< The text buffer of the RadioText decoder.
+    bool isItemRunning();    ///< The item running bit of the last group.
+    unsigned long getGroupCount(); ///< Number of RT+ groups decoded.
+
+private:
+    void _clear();           // drop all tags.
+    void _add(byte contentType, byte start, byte length);
+    void _send();            // pass the tags with confirmed characters on.
+    void _checkMessage();    // drop the tags when the RadioText starts a new message.
+
+    RDSRadioTextDecoder *_text;
+    receiveRTPlusFunction _sendTag;
+    unsigned long _groups;
+    byte _message;           ///< Message of the RadioText the tags belong to.
+    byte _groupMessage;      ///< Message of the RadioText at the last RT+ group.
+    byte _toggle;            ///< Item toggle bit, 0xFF before the first group.
+    bool _running;
+    bool _waiting;           ///< The tags of a new item wait for the next message of the RadioText.
+
+    // the tags of the current item.
+    byte _count;
+    byte _types[RDS_RTP_TAGS];
+    byte _starts[RDS_RTP_TAGS];
+    byte _lengths[RDS_RTP_TAGS];
+    uint8_t _sent;           ///< Bitmap of the tags passed to the tag function.
+}; // class RDSRTPlusDecoder
@@ -0,0 +1,56 @@
+/// \file RDSStationCache.cpp
+/// \brief Cache of the RDS information of the last received stations.
+///
+/// \details
+/// See RDSStationCache.h.
+/// The entries are kept in the order of their use, so a hit moves its entry to index 0.
+
+#include "RDSStationCache.h"
+
+
+RDSStationCache::RDSStationCache()
+{
+    clear();
+} // RDSStationCache()
+
+
+void RDSStationCache::clear()
+{
+    memset(_stations, 0, sizeof(_stations));
+} // clear()
+
+
+RDS_STATION_INFO *RDSStationCache::find(uint16_t pi)
+{
+    for (byte n = 0; (n < RDS_CACHE_SIZE) && _stations[n].pi; n++)
+    {
+        if (_stations[n].pi == pi)
+            return _front(n);
+    }
+    return NULL;
+} // find()
+
+
+/// A new entry is empty except for the PI.
+RDS_STATION_INFO *RDSStationCache::add(uint16_t pi)
+{
+    RDS_STATION_INFO *info = find(pi);
+
+    if (!info)
+    {
+        info = _front(RDS_CACHE_SIZE - 1);
+        memset(info, 0, sizeof(RDS_STATION_INFO));
+        info->pi = pi;
+    }
+    return info;
+} // add()
+
+
+RDS_STATION_INFO *RDSStationCache::_front(byte n)
+{
+    RDS_STATION_INFO info = _stations[n];
+
+    memmove(&_stations[1], &_stations[0], n * sizeof(RDS_STATION_INFO));
+    _stations[0] = info;
+    return &_stations[0];
+} // _front()
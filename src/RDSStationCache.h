@@ -0,0 +1,56 @@
+///
+/// \file RDSStationCache.h
+/// \brief Cache of the RDS information of the last received stations.
+///
+/// \details
+/// The RDS parser stores the confirmed PS, PTY, RadioText and AF list of a station
+/// by its PI when the station is left, that is when clearRDS() is called after tuning.
+/// When the first group of a cached PI is received they are published right away and
+/// replaced by the received information as soon as it is confirmed:
+///   RDSStationCache stationCache;
+///   rds.attachStationCache(&stationCache);
+///
+/// The entry used least recently is replaced by a new station.
+/// Every entry takes 88 bytes of RAM.
+///
+/// History:
+/// --------
+/// * 17.10.2026 created.
+
+#pragma once
+
+#include <Arduino.h>
+
+/// Number of stations in the cache.
+#define RDS_CACHE_SIZE 4
+
+/// Number of alternative frequencies kept for a station.
+#define RDS_CACHE_AF 12
+
+
+/// The RDS information of a station.
+typedef struct RDS_STATION_INFO {
+    uint16_t pi;            ///< Program Identification, 0 = unused entry.
+    byte pty;               ///< Program Type.
+    byte afCount;           ///< Number of AF codes.
+    char ps[8];             ///< Program Service name, empty when the first character is 0.
+    char rt[64];            ///< RadioText as passed to the text function, filled up with 0.
+    byte af[RDS_CACHE_AF];  ///< AF codes without the regional variants.
+} RDS_STATION_INFO;
+
+
+/// Stations ordered from the most recently to the least recently used one.
+class RDSStationCache
+{
+public:
+    RDSStationCache(); ///< create an empty cache.
+
+    RDS_STATION_INFO *find(uint16_t pi); ///< Entry of a station moved to the front or NULL.
+    RDS_STATION_INFO *add(uint16_t pi);  ///< Entry of a station moved to the front, a new one replaces the last one.
+    void clear();                        ///< Forget all stations.
+
+private:
+    RDS_STATION_INFO *_front(byte n);    ///< Move entry n to the front.
+
+    RDS_STATION_INFO _stations[RDS_CACHE_SIZE];
+}; // class RDSStationCache
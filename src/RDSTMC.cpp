@@ -0,0 +1,325 @@
+/// \file RDSTMC.cpp
+/// \brief Decoder and event store for the Traffic Message Channel in 8A groups.
+///
+/// \details
+/// See RDSTMC.h.
+/// Block 2 of an 8A group has the T flag in bit 4 and the F flag in bit 3,
+/// bits 2..0 are the duration of a single group message or the continuity index of a multi group message.
+/// The first group of a multi group message has bit 15 of block 3 set, the other groups carry
+/// the second group flag in bit 14, the group sequence identifier in bits 13..12
+/// and 28 bits of optional content in the rest of block 3 and in block 4.
+
+#include "RDSTMC.h"
+
+/// Minutes an event is kept for its duration and persistence code.
+static const uint16_t PERSISTENCE[8] PROGMEM = { 15, 15, 30, 60, 120, 180, 240, 1440 };
+
+/// Bits of the data behind the labels of the optional content, labels 14 and 15 end the decoding.
+static const byte LABEL_BITS[16] PROGMEM = { 3, 3, 5, 5, 5, 8, 8, 8, 8, 11, 16, 16, 16, 16, 0, 0 };
+
+#define LABEL_DURATION  0
+#define LABEL_CONTROL   1
+#define LABEL_SEPARATOR 14
+
+#define CONTROL_DIRECTIONALITY 2
+#define CONTROL_DIVERSION      5
+#define CONTROL_EXTENT_8       6
+#define CONTROL_EXTENT_16      7
+
+#define CONTENT_BITS 28
+
+
+// ----- store -----
+
+RDSTMCStore::RDSTMCStore()
+{
+    _minute = 0;
+    _tick = millis();
+    clear();
+} // RDSTMCStore()
+
+
+void RDSTMCStore::clear()
+{
+    _count = 0;
+    _expired = getMinute();
+} // clear()
+
+
+/// The minutes are counted from the differences of millis(), so they continue when millis() wraps around.
+uint16_t RDSTMCStore::getMinute()
+{
+    while (millis() - _tick >= 60000UL)
+    {
+        _tick += 60000UL;
+        _minute++;
+    }
+    return _minute;
+} // getMinute()
+
+
+byte RDSTMCStore::getCount()
+{
+    return _count;
+} // getCount()
+
+
+const RDS_TMC_EVENT *RDSTMCStore::get(byte n)
+{
+    return (n < _count) ? &_events[n] : NULL;
+} // get()
+
+
+int RDSTMCStore::find(uint16_t location)
+{
+    byte n = _lower(location);
+    return ((n < _count) && (_events[n].location == location)) ? n : -1;
+} // find()
+
+
+byte RDSTMCStore::_lower(uint16_t location)
+{
+    byte low = 0, high = _count;
+
+    while (low < high)
+    {
+        byte mid = (low + high) >> 1;
+        if (_events[mid].location < location)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+} // _lower()
+
+
+void RDSTMCStore::_remove(byte n)
+{
+    _count--;
+    memmove(&_events[n], &_events[n + 1], (_count - n) * sizeof(RDS_TMC_EVENT));
+} // _remove()
+
+
+/// The events that are kept move together, so the order stays intact.
+byte RDSTMCStore::expire()
+{
+    uint16_t now = getMinute();
+    byte kept = 0;
+
+    for (byte n = 0; n < _count; n++)
+    {
+        if ((int16_t)(_events[n].expires - now) > 0)
+            _events[kept++] = _events[n];
+    }
+    byte removed = _count - kept;
+    _count = kept;
+    _expired = now;
+    return removed;
+} // expire()
+
+
+bool RDSTMCStore::add(RDS_TMC_EVENT *event)
+{
+    uint16_t now = getMinute();
+    if (now != _expired)
+        expire();
+
+    event->expires = now + pgm_read_word(&PERSISTENCE[event->duration & 0x07]);
+    event->count = 1;
+
+    byte n = _lower(event->location);
+    for (byte e = n; (e < _count) && (_events[e].location == event->location); e++)
+    {
+        RDS_TMC_EVENT *stored = &_events[e];
+        if ((stored->event == event->event) && !((stored->flags ^ event->flags) & RDS_TMC_NEGATIVE))
+        {
+            bool changed = (stored->extent != event->extent) || (stored->flags != event->flags)
+                           || (stored->duration != event->duration);
+            if (stored->count < 255) stored->count++;
+            event->count = stored->count;
+            *stored = *event;
+            return changed;
+        }
+    }
+
+    if (_count == RDS_TMC_EVENTS)
+    {
+        // replace the event that expires first.
+        byte first = 0;
+        for (byte e = 1; e < _count; e++)
+        {
+            if ((int16_t)(_events[e].expires - _events[first].expires) < 0) first = e;
+        }
+        _remove(first);
+        if (first < n) n--;
+    }
+    memmove(&_events[n + 1], &_events[n], (_count - n) * sizeof(RDS_TMC_EVENT));
+    _events[n] = *event;
+    _count++;
+    return true;
+} // add()
+
+
+// ----- decoder -----
+
+RDSTMCDecoder::RDSTMCDecoder(RDSTMCStore *store)
+{
+    _store = store;
+    _sendEvent = NULL;
+    _messages = _drops = 0;
+    reset();
+} // RDSTMCDecoder()
+
+
+/// A message being collected is dropped, the store is kept.
+void RDSTMCDecoder::reset()
+{
+    memset(_lastBlocks, 0, sizeof(_lastBlocks));
+    _ci = 0;
+    _groups = 0;
+    _remaining = 0;
+} // reset()
+
+
+void RDSTMCDecoder::attachEventCallback(receiveTMCEventFunction newFunction)
+{
+    _sendEvent = newFunction;
+} // attachEventCallback()
+
+
+unsigned long RDSTMCDecoder::getMessageCount()
+{
+    return _messages;
+} // getMessageCount()
+
+
+unsigned long RDSTMCDecoder::getDropCount()
+{
+    return _drops;
+} // getDropCount()
+
+
+void RDSTMCDecoder::decode(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4)
+{
+    (void)block1;
+
+    // stations repeat the groups of a message.
+    if ((block2 == _lastBlocks[0]) && (block3 == _lastBlocks[1]) && (block4 == _lastBlocks[2])) return;
+    _lastBlocks[0] = block2;
+    _lastBlocks[1] = block3;
+    _lastBlocks[2] = block4;
+
+    // tuning information.
+    if (block2 & 0x0010) return;
+
+    if (block2 & 0x0008)
+    {
+        // single group message.
+        RDS_TMC_EVENT event;
+        event.location = block4;
+        event.event = block3 & 0x07FF;
+        event.extent = (block3 >> 11) & 0x07;
+        event.flags = ((block3 & 0x4000) ? RDS_TMC_NEGATIVE : 0) | ((block3 & 0x8000) ? RDS_TMC_DIVERSION : 0);
+        event.duration = block2 & 0x07;
+        _message(&event);
+        return;
+    }
+
+    byte ci = block2 & 0x07;
+    if (block3 & 0x8000)
+    {
+        // first group of a multi group message, continuity index 0 is not used.
+        if (_ci) _drops++;
+        _ci = ci;
+        _groups = 0;
+        _multi.location = block4;
+        _multi.event = block3 & 0x07FF;
+        _multi.extent = (block3 >> 11) & 0x07;
+        _multi.flags = ((block3 & 0x4000) ? RDS_TMC_NEGATIVE : 0) | RDS_TMC_MULTIGROUP;
+        _multi.duration = 0;
+        return;
+    }
+
+    if (!_ci || (ci != _ci)) return;
+
+    // the second group tells the number of groups that follow, it counts down to 0.
+    bool second = block3 & 0x4000;
+    byte gsi = (block3 >> 12) & 0x03;
+    if (second ? (_groups != 0) : ((_groups == 0) || (_groups == MULTI_GROUPS) || (gsi + 1 != _remaining)))
+    {
+        _drops++;
+        _ci = 0;
+        return;
+    }
+    _content[_groups++] = ((uint32_t)(block3 & 0x0FFF) << 16) | block4;
+    _remaining = gsi;
+    if (gsi == 0)
+    {
+        _optionalContent(&_multi);
+        _message(&_multi);
+        _ci = 0;
+    }
+} // decode()
+
+
+void RDSTMCDecoder::_message(RDS_TMC_EVENT *event)
+{
+    _messages++;
+    if (!event->event) return;
+    if (!_store)
+    {
+        event->count = 1;
+        event->expires = 0;
+    }
+    if ((!_store || _store->add(event)) && _sendEvent) _sendEvent(event);
+} // _message()
+
+
+uint16_t RDSTMCDecoder::_bits(byte pos, byte count)
+{
+    uint16_t value = 0;
+
+    for (byte n = 0; n < count; n++, pos++)
+    {
+        byte bit = CONTENT_BITS - 1 - (pos % CONTENT_BITS);
+        value = (value << 1) | ((_content[pos / CONTENT_BITS] >> bit) & 1);
+    }
+    return value;
+} // _bits()
+
+
+/// The unused bits at the end are 0.
+void RDSTMCDecoder::_optionalContent(RDS_TMC_EVENT *event)
+{
+    byte length = _groups * CONTENT_BITS;
+    byte pos = 0;
+
+    while (pos + 4 <= length)
+    {
+        bool padding = true;
+        for (byte p = pos; padding && (p < length); p += 16)
+        {
+            padding = !_bits(p, (length - p < 16) ? length - p : 16);
+        }
+        if (padding) break;
+
+        byte label = _bits(pos, 4);
+        byte size = pgm_read_byte(&LABEL_BITS[label]);
+        pos += 4;
+        if ((label >= LABEL_SEPARATOR) || (pos + size > length)) break;
+
+        uint16_t value = _bits(pos, size);
+        pos += size;
+        if (label == LABEL_DURATION)
+        {
+            event->duration = value;
+        }
+        else if (label == LABEL_CONTROL)
+        {
+            if (value == CONTROL_DIRECTIONALITY) event->flags ^= RDS_TMC_DIRECTIONALITY;
+            else if (value == CONTROL_DIVERSION) event->flags |= RDS_TMC_DIVERSION;
+            else if (value == CONTROL_EXTENT_8) event->extent += 8;
+            else if (value == CONTROL_EXTENT_16) event->extent += 16;
+        }
+    }
+} // _optionalContent()
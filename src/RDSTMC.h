@@ -0,0 +1,134 @@
+///
+/// \file RDSTMC.h
+/// \brief Decoder and event store for the Traffic Message Channel in 8A groups.
+///
+/// \details
+/// TMC messages (ISO 14819-1) name an event code of the event list and a location code of the location table
+/// of the service. The tables are not part of the library, the codes are passed on as numbers.
+/// The decoder is registered for the 8A groups and adds the messages to a store, without a store
+/// every message is passed to the event function:
+///   RDSTMCStore tmcStore;
+///   RDSTMCDecoder tmc(&tmcStore);
+///   rds.attachGroupDecoder(RDS_GROUP_A(8), &tmc);
+/// TMC is an Open Data Application with the AID 0xCD46, the decoder can be registered for it instead
+/// with the ODA registry of the parser and gets the 8A groups only from stations that announce TMC in 3A groups:
+///   oda.attachDecoder(0xCD46, &tmc);
+///
+/// * A single group message is complete with its group.
+/// * The groups of a multi group message (up to 5 groups) are collected by their continuity index,
+///   the message is dropped when a group is missing.
+///   The optional content is decoded for the duration (label 0) and the control codes (label 1)
+///   for directionality, diversion and extent. Other labels and the information after a separator are skipped.
+/// * Groups with tuning information (T = 1) are ignored.
+/// * An immediate repetition of a group is ignored.
+///
+/// The store keeps up to RDS_TMC_EVENTS events sorted by location code, find() is a binary search.
+/// A message with the location, direction and event code of a stored event updates this event.
+/// An event expires after the time given by its duration and persistence code for dynamic events
+/// is over without a repetition: 0, 1 = 15 min, 2 = 30 min, 3 = 1 h, 4 = 2 h, 5 = 3 h, 6 = 4 h, 7 = 24 h.
+/// When the store is full the event that expires first is replaced.
+/// The events are kept when the station changes.
+///
+/// Nothing is allocated, an event takes 10 bytes of RAM. Adding a message costs a binary search
+/// and a move of at most RDS_TMC_EVENTS events, far less than the 88 ms between two groups.
+///
+/// History:
+/// --------
+/// * 17.10.2026 created.
+
+#pragma once
+
+#include <Arduino.h>
+#include "RDSParser.h"
+
+/// Number of events in the store.
+#define RDS_TMC_EVENTS 16
+
+/// Flags of an event.
+#define RDS_TMC_NEGATIVE       0x01 ///< The event extends in the negative direction of the location table.
+#define RDS_TMC_DIVERSION      0x02 ///< A diversion is advised.
+#define RDS_TMC_DIRECTIONALITY 0x04 ///< The directionality is the opposite of the one in the event list.
+#define RDS_TMC_MULTIGROUP     0x08 ///< The event was sent as a multi group message.
+
+
+/// A traffic event.
+typedef struct RDS_TMC_EVENT {
+    uint16_t location;  ///< Location code.
+    uint16_t event;     ///< Event code 1..2047.
+    byte extent;        ///< Number of locations the event extends over, 0..31.
+    byte flags;         ///< RDS_TMC_NEGATIVE, RDS_TMC_DIVERSION, RDS_TMC_DIRECTIONALITY, RDS_TMC_MULTIGROUP.
+    byte duration;      ///< Duration and persistence code 0..7.
+    byte count;         ///< Number of receptions up to 255, set by the store.
+    uint16_t expires;   ///< Minute of RDSTMCStore::getMinute() the event expires, set by the store.
+} RDS_TMC_EVENT;
+
+
+/// callback function for a new or changed event.
+extern "C" {
+typedef void(*receiveTMCEventFunction)(const RDS_TMC_EVENT *event);
+}
+
+
+/// Events sorted by location code.
+class RDSTMCStore
+{
+public:
+    RDSTMCStore(); ///< create an empty store.
+
+    /// Add an event or update the stored event with the same location, direction and event code.
+    /// The count and the expiry time of event are set like in the store.
+    /// Returns true when the event is new or its extent, flags or duration changed.
+    bool add(RDS_TMC_EVENT *event);
+    byte expire();              ///< Remove the expired events, returns their number. add() does this every minute.
+    void clear();               ///< Forget all events.
+
+    byte getCount();            ///< Number of events.
+    const RDS_TMC_EVENT *get(byte n); ///< Event n in the order of the location codes.
+    int find(uint16_t location); ///< Index of the first event at a location or -1.
+    uint16_t getMinute();       ///< The clock of the expiry times in minutes.
+
+private:
+    byte _lower(uint16_t location); ///< Index of the first event with a location code not below location.
+    void _remove(byte n);
+
+    RDS_TMC_EVENT _events[RDS_TMC_EVENTS];
+    byte _count;
+    uint16_t _minute;           ///< Minutes counted by getMinute().
+    unsigned long _tick;        ///< millis() at the start of _minute.
+    uint16_t _expired;          ///< Minute of the last expire().
+}; // class RDSTMCStore
+
+
+/// Decoder for the TMC messages in 8A groups.
+class RDSTMCDecoder : public RDSODADecoder
+{
+public:
+    RDSTMCDecoder(RDSTMCStore *store); ///< create a decoder adding the messages to store.
+    void decode(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4);
+    void reset();
+
+    void attachEventCallback(receiveTMCEventFunction newFunction); ///< Register function for new or changed events.
+
+    unsigned long getMessageCount(); ///< Number of messages decoded.
+    unsigned long getDropCount();    ///< Number of multi group messages dropped because of a missing group.
+
+private:
+    static const byte MULTI_GROUPS = 4; ///< Groups with optional content after the first group.
+
+    void _message(RDS_TMC_EVENT *event);
+    void _optionalContent(RDS_TMC_EVENT *event);
+    uint16_t _bits(byte pos, byte count); ///< Bits of the optional content, MSB first.
+
+    RDSTMCStore *_store;
+    receiveTMCEventFunction _sendEvent;
+    uint16_t _lastBlocks[3];    ///< Blocks 2, 3 and 4 of the last group for ignoring repetitions.
+    unsigned long _messages;
+    unsigned long _drops;
+
+    // the multi group message being collected
+    RDS_TMC_EVENT _multi;       ///< Contents of the first group.
+    byte _ci;                   ///< Continuity index, 0 = no message.
+    byte _groups;               ///< Number of groups with optional content received.
+    byte _remaining;            ///< Group sequence identifier of the last group, it counts down to 0.
+    uint32_t _content[MULTI_GROUPS]; ///< 28 bits of optional content per group.
+}; // class RDSTMCDecoder
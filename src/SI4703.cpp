@@ -25,6 +25,7 @@ SI4703::SI4703(RadioInterface* prf, byte resetPin, byte sdioPin):
 
 // initialize all internals.
 bool SI4703::init() {
+    RADIO_BUS_OPERATION(RADIO_OP_INIT);
     pinMode(_resetPin, OUTPUT);
     pinMode(_sdioPin, OUTPUT);
     digitalWrite(_sdioPin, LOW);
@@ -38,6 +39,7 @@ bool SI4703::init() {
     {
         return false;
     }
+    _shadowValid=false;
     _readRegisters(); //Read the current register set
     registers[TEST1] = 0x8100; //Enable the oscillator, from AN230 page 9, rev 0.61 (works)
     if(!_saveRegisters())
@@ -56,20 +58,20 @@ bool SI4703::init() {
     }
     delay(110); //Max powerup time, from datasheet page 13
 
-    _readRegisters(); //Read the current register set
+    _shadowValid=false;
+    _readRegisters(); //Read the current register set after powerup
     bitSet(registers[SYSCONFIG1], RDS); //Enable RDS
     bitSet(registers[SYSCONFIG1], DE); //de-emphasis 50µs
     bitSet(registers[POWERCFG], RDSM); //RDS in verbose mode
-    if(!_saveRegisters())
-    {
-        return false;
-    }
 
+    // Collect the setup in the shadow registers and write them with a single transaction.
+    _batching=true;
     setBand(RADIO_BAND_FMWORLD);
     setChannelSpacing(KHz100);
     setVolume(1);
     setSeekParams(SK_GOOD_Q_ONLY);
-    return true;
+    _batching=false;
+    return _saveRegisters();
 }
 
 // switch the power off
@@ -82,11 +84,8 @@ void SI4703::term()
 // ----- Volume control -----
 void SI4703::setVolume(byte newVolume)
 {
+    RADIO_BUS_OPERATION(RADIO_OP_SETTINGS);
     RADIO::setVolume(newVolume);
-    if(!_readRegisters())
-    {
-        return;
-    }
     registers[SYSCONFIG2] &= 0xFFF0;
     registers[SYSCONFIG2] |= _volume;
     _saveRegisters(); //Update
@@ -96,11 +95,8 @@ void SI4703::setVolume(byte newVolume)
 // Mono / Stereo
 void SI4703::setMono(bool switchOn)
 {
+    RADIO_BUS_OPERATION(RADIO_OP_SETTINGS);
     RADIO::setMono(switchOn);
-    if(!_readRegisters())
-    {
-        return;
-    }
     if (switchOn)
     {
         bitSet(registers[POWERCFG], MONO);
@@ -116,11 +112,8 @@ void SI4703::setMono(bool switchOn)
 /// Switch mute mode.
 void SI4703::setMute(bool switchOn)
 {
+    RADIO_BUS_OPERATION(RADIO_OP_SETTINGS);
     RADIO::setMute(switchOn);
-    if(!_readRegisters())
-    {
-        return;
-    }
     if (switchOn)
     {
         bitClear(registers[POWERCFG],DMUTE);
@@ -137,11 +130,8 @@ void SI4703::setMute(bool switchOn)
 /// Switch soft mute mode.
 void SI4703::setSoftMute(bool switchOn)
 {
+    RADIO_BUS_OPERATION(RADIO_OP_SETTINGS);
     RADIO::setSoftMute(switchOn);
-    if(!_readRegisters())
-    {
-        return;
-    }
     if (switchOn)
     {
         bitClear(registers[POWERCFG],DSMUTE);
@@ -158,11 +148,8 @@ void SI4703::setSoftMute(bool switchOn)
 // tune to new band.
 void SI4703::setBand(RADIO_BAND newBand)
 {
+    RADIO_BUS_OPERATION(RADIO_OP_SETTINGS);
     RADIO::setBand(newBand);
-    if(!_readRegisters())
-    {
-        return;
-    }
     switch(_band)
     {
     case RADIO_BAND_FM:
@@ -181,10 +168,7 @@ void SI4703::setBand(RADIO_BAND newBand)
 
 void SI4703::setChannelSpacing(SPACINGS sp)
 {
-    if(!_readRegisters())
-    {
-        return;
-    }
+    RADIO_BUS_OPERATION(RADIO_OP_SETTINGS);
     bitWrite(registers[SYSCONFIG2], SPACE1, bitRead(sp,1));
     bitWrite(registers[SYSCONFIG2], SPACE0, bitRead(sp,0));
     switch (sp)
@@ -209,7 +193,8 @@ void SI4703::setChannelSpacing(SPACINGS sp)
 * @return RADIO_FREQ the current frequency.
 */
 RADIO_FREQ SI4703::getFrequency() {
-    if(!_readRegisters())
+    RADIO_BUS_OPERATION(RADIO_OP_GET_FREQUENCY);
+    if(!_readRegisters(READ_CHANNEL))
     {
         return false;
     }
@@ -219,47 +204,177 @@ RADIO_FREQ SI4703::getFrequency() {
 }
 
 /**
-* @brief Change the frequency in the chip.
+* @brief Change the frequency in the chip and wait until tuning is complete.
 * @param newF
-* @return void
+* @return true when the chip reported seek/tune complete.
 */
 bool SI4703::setFrequency(RADIO_FREQ newF)
 {
+    RADIO_BUS_OPERATION(RADIO_OP_SET_FREQUENCY);
+    return startFrequency(newF) && _waitTune();
+}
+
+// start seek mode upwards
+bool SI4703::seekUp(bool toNextSender)
+{
+    RADIO_BUS_OPERATION(RADIO_OP_SEEK);
+    return startSeek(true) && _waitTune();
+}
+
+
+// start seek mode downwards
+bool SI4703::seekDown(bool toNextSender)
+{
+    RADIO_BUS_OPERATION(RADIO_OP_SEEK);
+    return startSeek(false) && _waitTune();
+}
+
+
+/**
+* @brief Start tuning to a new frequency, pollTune() has to be called until it is complete.
+* @param newF
+* @return false when the chip could not be written.
+*/
+bool SI4703::startFrequency(RADIO_FREQ newF)
+{
+    RADIO_BUS_OPERATION(RADIO_OP_SET_FREQUENCY);
     RADIO::setFrequency(newF);
-    if(!_readRegisters())
-    {
-        return false;
-    }
     int channel = (_freq - _freqLow) / _freqSteps;
 
+    _stopTune();
     //These steps come from AN230 page 20 rev 0.5
     registers[CHANNEL] &= 0xFC00; //Clear out the channel bits
     registers[CHANNEL] |= channel; //Mask in the new channel
     bitSet(registers[CHANNEL], TUNE); //Set the TUNE bit to start
-    _saveRegisters();
-    return _waitEnd();
+    if(!_saveRegisters())
+    {
+        _tuneDone(false);
+        return false;
+    }
+    _tuneStart(TUNE_WAIT_STC, 50);
+    return true;
 }
 
-// start seek mode upwards
-bool SI4703::seekUp(bool toNextSender)
+
+/**
+* @brief Start a seek, pollTune() has to be called until it is complete.
+* @param seekUp direction of the seek.
+* @return false when the chip could not be written.
+*/
+bool SI4703::startSeek(bool seekUp)
 {
-    return _seek(true);
+    RADIO_BUS_OPERATION(RADIO_OP_SEEK);
+    _stopTune();
+    if(seekUp)
+    {
+        bitSet(registers[POWERCFG], SEEKUP);
+    }
+    else
+    {
+        bitClear(registers[POWERCFG], SEEKUP);
+    }
+    bitSet(registers[POWERCFG], SKMODE);
+    bitSet(registers[POWERCFG], SEEK);
+    if(!_saveRegisters())
+    {
+        _tuneDone(false);
+        return false;
+    }
+    _tuneStart(TUNE_WAIT_STC, 50);
+    return true;
 }
 
 
-// start seek mode downwards
-bool SI4703::seekDown(bool toNextSender)
+/**
+* @brief Advance a running tune or seek by polling the STC bit.
+* After STC is set the TUNE and SEEK bits are cleared and the chip clears STC again.
+* @return true when no tune or seek is running any more.
+*/
+bool SI4703::pollTune()
 {
-    return _seek(false);
+    RADIO_BUS_OPERATION(RADIO_OP_POLL_TUNE);
+    if(_tuneState==TUNE_IDLE)
+    {
+        return true;
+    }
+    if(!_tuneDue())
+    {
+        return false;
+    }
+    if(!_readRegisters(_tuneState==TUNE_WAIT_STC ? READ_STATUS : READ_CHANNEL))
+    {
+        _tuned=false;
+        _stopTune();
+        _tuneDone(false);
+        return true;
+    }
+    bool complete=bitRead(registers[STATUSRSSI], STC);
+    if(_tuneState==TUNE_WAIT_STC)
+    {
+        if(!complete && ++_tunePolls<100)
+        {
+            _tuneInterval=60;  //Seek/Tune Time (datasheet Table 8.)
+            return false;
+        }
+        _tuned = complete && !bitRead(registers[STATUSRSSI], SFBL);
+        _stopTune();
+        _tuneStart(TUNE_WAIT_CLEAR, 0);
+        return false;
+    }
+    if(complete && ++_tunePolls<100)
+    {
+        _tuneInterval=10;
+        return false;
+    }
+    _freq = ((registers[READCHAN] & 0x03FF) * _freqSteps) + _freqLow;
+    _tuneDone(_tuned);
+    return true;
+}
+
+
+/**
+* @brief Let the chip pulse GPIO2 when RDS data is ready or a tune or seek is complete.
+* checkRDS() and pollTune() then only read the chip after an interrupt.
+* @param intPin the pin GPIO2 is connected to, it must support interrupts.
+* @return false when the pin has no interrupt or the chip could not be written.
+*/
+bool SI4703::enableInterrupt(byte intPin)
+{
+    RADIO_BUS_OPERATION(RADIO_OP_SETTINGS);
+    if(!_attachInterruptPin(intPin))
+    {
+        return false;
+    }
+    bitSet(registers[SYSCONFIG1], RDSIEN);
+    bitSet(registers[SYSCONFIG1], STCIEN);
+    registers[SYSCONFIG1] = (registers[SYSCONFIG1] & ~GPIO2_MASK) | GPIO2_INT;
+    if(!_saveRegisters())
+    {
+        disableInterrupt();
+        return false;
+    }
+    return true;
+}
+
+
+void SI4703::disableInterrupt()
+{
+    RADIO_BUS_OPERATION(RADIO_OP_SETTINGS);
+    RADIO::disableInterrupt();
+    bitClear(registers[SYSCONFIG1], RDSIEN);
+    bitClear(registers[SYSCONFIG1], STCIEN);
+    registers[SYSCONFIG1] &= ~GPIO2_MASK;
+    _saveRegisters();
 }
 
 
 /// Retrieve all the information related to the current radio receiving situation.
 bool SI4703::getRadioInfo(RADIO_INFO *info)
 {
+    RADIO_BUS_OPERATION(RADIO_OP_GET_INFO);
     RADIO::getRadioInfo(info); // all settings to last current settings
 
-    if(!_readRegisters())
+    if(!_readRegisters(READ_STATUS))
     {
         return false;
     }
@@ -276,9 +391,10 @@ bool SI4703::getRadioInfo(RADIO_INFO *info)
 /// Return current audio settings.
 void SI4703::getAudioInfo(AUDIO_INFO *info)
 {
+    RADIO_BUS_OPERATION(RADIO_OP_GET_INFO);
     RADIO::getAudioInfo(info);
 
-    _readRegisters();
+    // only writable registers are used, the local shadow is authoritative.
     if (!bitRead(registers[POWERCFG],DMUTE))
     {
         info->mute = true;
@@ -294,33 +410,35 @@ void SI4703::getAudioInfo(AUDIO_INFO *info)
 
 bool SI4703::checkRDS()
 {
+    RADIO_BUS_OPERATION(RADIO_OP_CHECK_RDS);
     if (!_sendRDS)
     {
         return false;
     }
-    if(millis()<rdsPollTime+50)
+    if(!_rdsDue())
     {
-    return false;
+        return false;
     }
-    rdsPollTime=millis();
-    _readRegisters();
-    if(bitRead(registers[STATUSRSSI], RDSS))
+    if(!_readRegisters(READ_RDS))
     {
-        Serial.println("RDS syncro");
+        return false;
     }
     if(bitRead(registers[STATUSRSSI], RDSR))
     {
-        _sendRDS(registers[RDSA], registers[RDSB], registers[RDSC], registers[RDSD]);
+        byte errors = (((registers[STATUSRSSI] >> BLERA) & 0x03) << 6) | ((registers[READCHAN] >> BLERD) & 0x3F);
+        _receiveRDS(registers[RDSA], registers[RDSB], registers[RDSC], registers[RDSD], errors);
+        return true;
     }
+    return false;
 }
 
 void SI4703::setSeekParams(SEEK_PARAMS sk)
 {
+    RADIO_BUS_OPERATION(RADIO_OP_SETTINGS);
     if(sk >= SK_MAX)
     {
         return;
     }
-    _readRegisters();
     registers[SYSCONFIG2]|= (SEEKTH_MIN + seekParams[sk].seekth) & SEEKTH_MASK;
     registers[SYSCONFIG3]|= (SKSNR_MIN + seekParams[sk].sksnr) & SKSNR_MASK;
     registers[SYSCONFIG3]|= (SKCNT_MIN + seekParams[sk].skcnt) & SKCNT_MASK;
@@ -332,6 +450,7 @@ void SI4703::setSeekParams(SEEK_PARAMS sk)
 /// Send the current values of all registers to the Serial port.
 void SI4703::debugStatus()
 {
+    RADIO_BUS_OPERATION(RADIO_OP_DEBUG);
     _readRegisters();
      for (int x = 0 ; x < 16 ; x++)
      {
@@ -341,89 +460,81 @@ void SI4703::debugStatus()
     }
 }
 
-bool SI4703::_seek(bool seekUp)
+/// Clear the TUNE and SEEK bits of a previous tune or seek.
+void SI4703::_stopTune()
 {
-    bool tuned;
-    _readRegisters();
-    if(bitRead(registers[POWERCFG], SEEK))
-    {
-        bitClear(registers[POWERCFG], SEEK);
-        _saveRegisters();
-    }
-    if(seekUp)
-    {
-        bitSet(registers[POWERCFG], SEEKUP);
-    }
-    else
-    {
-        bitClear(registers[POWERCFG], SEEKUP);
-    }
-    bitSet(registers[POWERCFG], SKMODE);
-    bitSet(registers[POWERCFG], SEEK);
+    bitClear(registers[POWERCFG], SEEK);
+    bitClear(registers[CHANNEL], TUNE);
     _saveRegisters();
-    return _waitEnd();
 }
 
-bool SI4703::_waitEnd()
+
+// ----- internal functions -----
+/// Write the dirty writable registers back to the chip.
+/// The chip always starts writing at register 0x02, so the write covers 0x02 up to the highest dirty register.
+bool SI4703::_saveRegisters()
 {
-    bool bResult=false;
-    _tuned=false;
-    delay(50);
-    for(byte i=0;i<100;i++)
+    byte data[12];
+    byte last=0;
+    if(_batching)
     {
-        if(!_readRegisters())
-        {
-            return false;
-        }
-        if(bitRead(registers[STATUSRSSI], STC))
+        return true;
+    }
+    for (byte i=POWERCFG;i<=TEST1;i++)
+    {
+        if(registers[i]!=_savedRegisters[i])
         {
-            bResult=true;
-            break;
+            last=i;
         }
-        delay(60);  //Seek/Tune Time (datasheet Table 8.)
-    };
-    _tuned = bitRead(registers[STATUSRSSI], SFBL)? false : true;
-    bitClear(registers[POWERCFG], SEEK);
-    bitClear(registers[CHANNEL], TUNE);
-    if(!_saveRegisters())
+    }
+    if(!last)
     {
-        return false;
+        return true; // nothing changed
     }
-    while(bitRead(registers[STATUSRSSI], STC))
+    for (byte i=POWERCFG;i<=last;i++)
     {
-        if(!_readRegisters())
-        {
-            return false;
-        }
-        delay(10);
+        registerToArray(registers[i], &data[(i-POWERCFG)<<1]);
     }
-    return bResult;
-}
-
-
-// ----- internal functions -----
-bool SI4703::_saveRegisters()
-{
-    byte data[12];
-    for (byte i=2;i<=7;i++)
+    if(!_pRadio->send(SI4703_ADR, data, (last-POWERCFG+1)<<1))
     {
-        registerToArray(registers[i], &data[(i-2)<<1]);
+        return false;
+    }
+    for (byte i=POWERCFG;i<=last;i++)
+    {
+        _savedRegisters[i]=registers[i];
     }
-    return _pRadio->send(SI4703_ADR, data, sizeof(data));
+    return true;
 }
 
-bool SI4703::_readRegisters()
+/// Read count registers starting at 0x0A.
+/// Once the shadow is valid the writable registers 0x02..0x07 are authoritative locally and are not overwritten.
+/// Until then the complete register set is read.
+bool SI4703::_readRegisters(byte count)
 {
     //Si4703 begins reading from register upper register of 0x0A and reads to 0x0F, then loops to 0x00.
-    //We want to read the entire register set from 0x0A to 0x09 = 32 bytes.
+    //The polling paths only need the first registers, the entire register set from 0x0A to 0x09 = 32 bytes.
     byte data[32];
-    if(!_pRadio->receive(SI4703_ADR, data, sizeof(data)))
+    if(!_shadowValid || count>READ_ALL)
+    {
+        count=READ_ALL;
+    }
+    if(!_pRadio->receive(SI4703_ADR, data, count<<1))
     {
         return false;
     }
-    for(byte i=0;i<16;i++)
+    for(byte k=0;k<count;k++)
+    {
+        byte i=(STATUSRSSI+k)&0x0F;
+        if(_shadowValid && i>=POWERCFG && i<=TEST1)
+        {
+            continue;
+        }
+        registers[i] = arrayToRegister(&data[k<<1]);
+    }
+    if(!_shadowValid)
     {
-        registers[i] = arrayToRegister(&data[((i+6)%16)<<1]);
+        memcpy(_savedRegisters, registers, sizeof(_savedRegisters));
+        _shadowValid=true;
     }
     return true;
 }
@@ -14,6 +14,11 @@
 /// History:
 /// --------
 /// * 05.08.2014 created.
+/// * 17.10.2026 write-back shadow of the writable registers, setters no longer read the chip first.
+/// * 17.10.2026 partial status reads for the polling paths.
+/// * 17.10.2026 setup in init() is written to the chip in one transaction.
+/// * 17.10.2026 non-blocking tune and seek.
+/// * 17.10.2026 RDS and seek/tune complete interrupts on GPIO2.
 
 
 #pragma once
@@ -70,8 +75,15 @@ public:
     bool seekUp(bool toNextSender = true);   // start seek mode upwards
     bool seekDown(bool toNextSender = true); // start seek mode downwards
 
+    bool startFrequency(RADIO_FREQ newF);    // start tuning, returns immediately
+    bool startSeek(bool seekUp = true);      // start seek, returns immediately
+    bool pollTune();                         // advance a running tune or seek
+
     bool checkRDS(); // read RDS data from the current station and process when data available.
 
+    bool enableInterrupt(byte intPin); // use GPIO2 of the chip connected to intPin, call after init().
+    void disableInterrupt();
+
     // ----- combined status functions -----
 
     virtual bool getRadioInfo(RADIO_INFO *info); ///< Retrieve some information about the current radio function of the chip.
@@ -80,7 +92,6 @@ public:
 
     // ----- debug Helpers send information to Serial port
 
-    void  debugScan();               // Scan all frequencies and report a status
     void  debugStatus();             // Report Info about actual Station
 
     // ----- read/write registers of the chip
@@ -121,8 +132,12 @@ private:
     static const byte TUNE = 15;
 
     //Register 0x04 - SYSCONFIG1
+    static const byte RDSIEN = 15; ///< RDS Interrupt Enable
+    static const byte STCIEN = 14; ///< Seek/Tune Complete Interrupt Enable
     static const byte RDS = 12;
     static const byte DE = 11;
+    static const word GPIO2_MASK = 0x000C;
+    static const word GPIO2_INT  = 0x0004; ///< GPIO2 is the active low interrupt output, 5 msec pulse.
 
     //Register 0x05 - SYSCONFIG2
     static const word SEEKTH_MASK = 0x7F00;
@@ -148,19 +163,34 @@ private:
     static const word RDSS   = 0x0800; ///<RDS syncronized
     static const word ST     = 8; ///< Stereo Indicator
     static const byte RSSI   = 0x00FF;
+    static const byte BLERA  = 9; ///< Block A error level in verbose mode, 2 bits.
+
+    //Register 0x0B - READCHAN
+    static const byte BLERD  = 10; ///< Block B..D error levels in verbose mode, 2 bits each with block D lowest.
 
     // store the current values of the 16 chip internal 16-bit registers
     uint16_t registers[16];
 
+    // Copy of the writable registers 0x02..0x07 as they were last written to the chip.
+    // Registers that differ from this copy are dirty and will be written by _saveRegisters().
+    uint16_t _savedRegisters[TEST1 + 1];
+    bool _shadowValid=false; ///< The writable registers in registers[] are authoritative locally.
+    bool _batching=false;    ///< _saveRegisters() only collects the changes in the shadow.
+
+    // Number of registers to read, starting at 0x0A and wrapping around after 0x0F.
+    static const byte READ_STATUS  = 1;  ///< STATUSRSSI only, 2 bytes.
+    static const byte READ_CHANNEL = 2;  ///< STATUSRSSI and READCHAN, 4 bytes.
+    static const byte READ_RDS     = 6;  ///< STATUSRSSI, READCHAN and RDSA..RDSD, 12 bytes.
+    static const byte READ_ALL     = 16; ///< the complete register set, 32 bytes.
+
     // ----- low level communication to the chip using I2C bus
-    bool  _readRegisters();  // read all status & data registers
-    bool  _saveRegisters();  // Save writable registers back to the chip
+    bool  _readRegisters(byte count = READ_ALL);  // read status & data registers starting at 0x0A
+    bool  _saveRegisters();  // Save dirty writable registers back to the chip
 
     void registerToArray(word regIn, byte* dataOut);
     word arrayToRegister(byte* dataIn);
 
-    bool _seek(bool seekUp = true);
-    bool _waitEnd();
+    void _stopTune();
     byte _resetPin;
     byte _sdioPin;
     bool _tuned=false;
@@ -63,6 +63,7 @@ uint8_t RADIO::getVolume() {
 /// @param switchOn true to switch bassBoost mode on, false to switch bassBoost mode off.
 bool RADIO::setBassBoost(bool switchOn) {
     _bassBoost = switchOn;
+    return(true);
 } // setBassBoost()
 
 
@@ -139,6 +140,7 @@ bool RADIO::setFrequency(RADIO_FREQ newFreq) {
     if (newFreq < _freqLow)  newFreq = _freqLow;
     if (newFreq > _freqHigh) newFreq = _freqHigh;
     _freq = newFreq;
+    return(true);
 } // setFrequency()
 
 
@@ -148,8 +150,101 @@ void RADIO::setBandFrequency(RADIO_BAND newBand, RADIO_FREQ newFreq) {
 } // setBandFrequency()
 
 
-bool RADIO::seekUp(bool)   {}
-bool RADIO::seekDown(bool) {}
+bool RADIO::seekUp(bool)   { return(false); }
+bool RADIO::seekDown(bool) { return(false); }
+
+
+// ----- non-blocking tune and seek -----
+
+/// Start tuning to a new frequency.
+/// Chips without a non-blocking implementation tune by using the blocking setFrequency() and complete immediately.
+bool RADIO::startFrequency(RADIO_FREQ newF) {
+    _tuneDone(setFrequency(newF));
+    return(_tuneResult);
+} // startFrequency()
+
+
+/// Start a seek.
+/// Chips without a non-blocking implementation seek by using the blocking seekUp() and seekDown() and complete immediately.
+bool RADIO::startSeek(bool up) {
+    _tuneDone(up ? seekUp() : seekDown());
+    return(_tuneResult);
+} // startSeek()
+
+
+/// Advance a running tune or seek.
+/// The base implementation has nothing to do.
+bool RADIO::pollTune() {
+    return(_tuneState == TUNE_IDLE);
+} // pollTune()
+
+
+bool RADIO::isTuneComplete() { return(_tuneState == TUNE_IDLE); }
+bool RADIO::getTuneResult()  { return(_tuneResult); }
+
+
+void RADIO::attachTuneComplete(tuneCompleteFunction newFunction) {
+    _sendTuneComplete = newFunction;
+} // attachTuneComplete()
+
+
+void RADIO::_tuneStart(TUNE_STATE state, word interval) {
+    _tuneState = state;
+    _tuneTime = millis();
+    _tuneInterval = interval;
+    _tunePolls = 0;
+    _tuneIntSeen = _intCount;
+} // _tuneStart()
+
+
+/// Return true when the interval since the last step has passed and schedule the next poll.
+/// With an interrupt pin the chip is only read for the seek/tune complete flag when it signaled,
+/// the interval is extended to INT_TUNE_FALLBACK for a lost interrupt.
+bool RADIO::_tuneDue() {
+    unsigned long now = millis();
+    word interval = _tuneInterval;
+
+    if ((_intPin != NO_PIN) && (_tuneState == TUNE_WAIT_STC)) {
+        byte count = _intCount;
+        if (count != _tuneIntSeen) {
+            _tuneIntSeen = count;
+            _tuneTime = now;
+            return(true);
+        } // if
+        if (interval < INT_TUNE_FALLBACK)
+            interval = INT_TUNE_FALLBACK;
+    } // if
+
+    if (now - _tuneTime < interval)
+        return(false);
+    _tuneTime = now;
+    return(true);
+} // _tuneDue()
+
+
+/// The tunes of the AF follow mode and of the traffic switch are not reported, the program stays the same.
+/// The AF decoder gets the frequency of every tune, the RDS data is only passed on from the tuned program.
+void RADIO::_tuneDone(bool result) {
+    _tuneState = TUNE_IDLE;
+    _tuneResult = result;
+    if (_afDecoder)
+        _afDecoder->setFrequency(_freq);
+    if (_sendTuneComplete && (_afState <= AF_MONITOR) && (_taState == TA_IDLE))
+        _sendTuneComplete(_freq, result);
+} // _tuneDone()
+
+
+/// The blocking tune and seek functions are implemented by waiting for the state machine.
+bool RADIO::_waitTune() {
+    while (!pollTune()) {
+        unsigned long passed = millis() - _tuneTime;
+        if ((_intPin != NO_PIN) && (_tuneState == TUNE_WAIT_STC))
+            delay(1); // pollTune() reads the chip only after an interrupt.
+        else if (passed < _tuneInterval)
+            delay(_tuneInterval - passed);
+    } // while
+    return(_tuneResult);
+} // _waitTune()
 
 RADIO_BAND RADIO::getBand()         { return(_band); }
 RADIO_FREQ RADIO::getFrequency()    { return(_freq); }
@@ -158,6 +253,439 @@ RADIO_FREQ RADIO::getMaxFrequency() { return(_freqHigh); }
 RADIO_FREQ RADIO::getFrequencyStep(){ return(_freqSteps); }
 
 
+// ----- scanning the band -----
+
+/// Start a scan of the current band from getMinFrequency() to getMaxFrequency().
+/// The scan either uses the seek function of the chip or tunes every channel when stepped is set.
+/// Found stations are stored into the stations array, the scan ends when the band is covered,
+/// the list is full, the timeBudget in msec is exhausted or abortScan() is called.
+/// After a station is found the scan stays dwellTime msec on it, so stereo and RDS synchronization can be detected.
+/// Stations below minRssi are skipped. Stepped scans need a useful minRssi for the chip.
+/// Without a list for at least one station no scan is started.
+bool RADIO::startScan(RADIO_STATION *stations, uint8_t maxStations, unsigned long timeBudget,
+                      bool stepped, word dwellTime, uint8_t minRssi) {
+    if (!stations || !maxStations)
+        return(false);
+    _scanStations = stations;
+    _scanMax = maxStations;
+    _scanCount = 0;
+    _scanStepped = stepped;
+    _scanDwell = dwellTime;
+    _scanMinRssi = minRssi;
+    _scanBudget = timeBudget;
+    _scanStart = millis();
+    _scanDuration = 0;
+    _scanState = SCAN_START;
+    _scanFreq = getMinFrequency();
+    if (!startFrequency(_scanFreq)) {
+        _scanEnd();
+        return(false);
+    } // if
+    return(true);
+} // startScan()
+
+
+/// Advance a running scan.
+/// Call this function from the loop until it returns true.
+bool RADIO::pollScan() {
+    RADIO_INFO info;
+
+    if (_scanState == SCAN_IDLE)
+        return(true);
+
+    if (_scanState != SCAN_DWELL) {
+        if (!pollTune())
+            return(false);
+        bool found = getTuneResult();
+        if (_scanState == SCAN_START && !_scanStepped) {
+            // seeking starts from the lower band limit, the limit itself is no station.
+            _scanFreq = _freq;
+            return(!_scanNext());
+        } // if
+        // stepped scans look at every channel, seeks stop on stations only.
+        // A seek that fails or wraps around ends the scan.
+        if (!_scanStepped && (!found || _freq <= _scanFreq)) {
+            _scanEnd();
+            return(true);
+        } // if
+        if (!_scanStepped)
+            _scanFreq = _freq;
+        if (!found)
+            return(!_scanNext());
+        _scanState = SCAN_DWELL;
+        _scanDwellStart = millis();
+        return(false);
+    } // if
+
+    // SCAN_DWELL
+    if (millis() - _scanDwellStart < _scanDwell)
+        return(false);
+    if ((_scanCount < _scanMax) && getRadioInfo(&info) && info.tuned && info.rssi >= _scanMinRssi) {
+        RADIO_STATION *s = &_scanStations[_scanCount++];
+        s->freq = _freq;
+        s->rssi = info.rssi;
+        s->stereo = info.stereo;
+        s->rdsSync = info.rds;
+    } // if
+    _scanNext();
+    return(_scanState == SCAN_IDLE);
+} // pollScan()
+
+
+/// Start the next step of the scan or end the scan when the band is covered, the list is full or the time is over.
+bool RADIO::_scanNext() {
+    if ((_scanCount >= _scanMax) || (millis() - _scanStart >= _scanBudget)
+        || (_scanStepped && _scanFreq + getFrequencyStep() > getMaxFrequency())) {
+        _scanEnd();
+        return(false);
+    } // if
+    _scanState = SCAN_TUNING;
+    if (_scanStepped)
+        _scanFreq += getFrequencyStep();
+    if (!(_scanStepped ? startFrequency(_scanFreq) : startSeek(true))) {
+        _scanEnd();
+        return(false);
+    } // if
+    return(true);
+} // _scanNext()
+
+
+void RADIO::_scanEnd() {
+    _scanState = SCAN_IDLE;
+    _scanDuration = millis() - _scanStart;
+} // _scanEnd()
+
+
+/// Stop the scan. A tune or seek that is still running completes by calling pollTune().
+void RADIO::abortScan() {
+    if (_scanState != SCAN_IDLE)
+        _scanEnd();
+} // abortScan()
+
+
+/// Scan the band like startScan() and wait until the scan is complete.
+/// @return the number of stations found.
+uint8_t RADIO::scan(RADIO_STATION *stations, uint8_t maxStations, unsigned long timeBudget,
+                    bool stepped, word dwellTime, uint8_t minRssi) {
+    if (!startScan(stations, maxStations, timeBudget, stepped, dwellTime, minRssi))
+        return(0);
+    while (!pollScan())
+        delay(1);
+    return(_scanCount);
+} // scan()
+
+
+bool          RADIO::isScanComplete()  { return(_scanState == SCAN_IDLE); }
+uint8_t       RADIO::getScanCount()    { return(_scanCount); }
+unsigned long RADIO::getScanDuration() { return(_scanDuration); }
+
+
+/// Scan the band and send the list of stations to the Serial port.
+void RADIO::debugScan() {
+    RADIO_STATION stations[32];
+    uint8_t count = scan(stations, 32, 120000, false, 500);
+
+    for (uint8_t n = 0; n < count; n++) {
+        Serial.print(stations[n].freq);
+        Serial.print(" RSSI:");    Serial.print(stations[n].rssi);
+        Serial.print(stations[n].stereo ? " stereo" : " mono");
+        Serial.println(stations[n].rdsSync ? " RDS" : "");
+    } // for
+    Serial.print(count); Serial.print(" stations in "); Serial.print(_scanDuration); Serial.println("ms");
+} // debugScan()
+
+
+// ----- following the alternative frequencies -----
+
+/// The decoder selects the method B list of the transmitter the radio is tuned to by the frequency.
+void RADIO::attachAFDecoder(RDSAlternativeFrequencyDecoder *decoder) {
+    _afDecoder = decoder;
+    if (decoder)
+        decoder->setFrequency(_freq);
+} // attachAFDecoder()
+
+
+/// Set the alternative frequencies of the current program, e.g. from the AF list of the RDS parser.
+/// The tuned frequency is skipped, the sampled RSSI of frequencies already known is kept.
+/// A new list is ignored while an AF is checked or the radio is on another network for a traffic announcement.
+void RADIO::setAFList(const RADIO_FREQ *freqs, byte count) {
+    RADIO_FREQ oldList[RADIO_AF_MAX];
+    uint8_t oldRssi[RADIO_AF_MAX];
+    byte oldCount = _afCount;
+
+    if ((_afState > AF_MONITOR) || (_taState != TA_IDLE))
+        return;
+    memcpy(oldList, _afList, sizeof(oldList));
+    memcpy(oldRssi, _afRssi, sizeof(oldRssi));
+    _afCount = 0;
+    for (byte n = 0; (n < count) && (_afCount < RADIO_AF_MAX); n++) {
+        if (freqs[n] == _freq)
+            continue;
+        _afList[_afCount] = freqs[n];
+        _afRssi[_afCount] = 0;
+        for (byte o = 0; o < oldCount; o++) {
+            if (oldList[o] == freqs[n])
+                _afRssi[_afCount] = oldRssi[o];
+        } // for
+        _afCount++;
+    } // for
+    _afIndex = 0;
+} // setAFList()
+
+
+/// Switch on or off the AF follow mode.
+/// The RSSI of the tuned frequency is checked every AF_CHECK_TIME msec by pollAF().
+/// While it is less than AF_SAMPLE_MARGIN above minRssi the AFs are sampled one by one every AF_SAMPLE_TIME msec.
+/// When it is below minRssi AF_LOW_CHECKS times in a row the AFs are tried by their sampled RSSI.
+/// An AF is taken when the first RDS group received there carries the PI of the program.
+/// The PI is taken from the RDS groups so attachReceiveRDS() is required.
+/// The audio is muted while the radio is on an AF that is not confirmed.
+void RADIO::setAFFollow(bool switchOn, uint8_t minRssi) {
+    _afMinRssi = minRssi;
+    if (switchOn && (_afState == AF_OFF)) {
+        _afState = AF_MONITOR;
+        _afLow = 0;
+        _afWait = AF_CHECK_TIME;
+        _afTime = _afSampleTime = millis();
+    } else if (!switchOn && (_afState != AF_OFF)) {
+        if (_afState > AF_MONITOR)
+            setFrequency(_afHome);
+        _afEnd();
+        _afState = AF_OFF;
+    } // if
+} // setAFFollow()
+
+
+/// Advance the AF follow mode, call this function from the loop.
+bool RADIO::pollAF() {
+    RADIO_BUS_OPERATION(RADIO_OP_AF);
+    RADIO_INFO info;
+    unsigned long now = millis();
+
+    switch (_afState) {
+    case AF_MONITOR:
+        if ((_tuneState != TUNE_IDLE) || (_scanState != SCAN_IDLE) || (_taState != TA_IDLE) || (now - _afTime < _afWait))
+            break;
+        _afTime = now;
+        _afWait = AF_CHECK_TIME;
+        if (!getRadioInfo(&info))
+            break;
+        _afHomeRssi = info.rssi;
+        if (info.rssi >= _afMinRssi)
+            _afLow = 0;
+        else if (_afLow++ == 0)
+            _afStart = now;
+
+        if (!_afCount || !_afPI)
+            break;
+        _afHome = _freq;
+        if (_afLow >= AF_LOW_CHECKS) {
+            _afTried = 0;
+            _afNext();
+        } else if ((info.rssi < _afMinRssi + AF_SAMPLE_MARGIN) && (now - _afSampleTime >= AF_SAMPLE_TIME)) {
+            _afSampleTime = now;
+            _afTried = 0;
+            _afTune((_afIndex + 1) % _afCount, AF_SAMPLE);
+        } // if
+        break;
+
+    case AF_SAMPLE:
+        if (!pollTune())
+            break;
+        _afRssi[_afIndex] = (getTuneResult() && getRadioInfo(&info)) ? info.rssi : 0;
+        _afState = AF_RETURN;
+        startFrequency(_afHome);
+        break;
+
+    case AF_TUNE:
+        if (!pollTune())
+            break;
+        _afRssi[_afIndex] = (getTuneResult() && getRadioInfo(&info)) ? info.rssi : 0;
+        if (_afRssi[_afIndex] < _afMinRssi) {
+            // no need to wait for RDS on a weak frequency.
+            _afNext();
+        } else {
+            _afState = AF_CHECK_PI;
+            _afCheckPI = 0;
+            _afTime = now;
+        } // if
+        break;
+
+    case AF_CHECK_PI:
+        checkRDS();
+        if (_afCheckPI == _afPI) {
+            // the program continues here, the old frequency becomes an AF.
+            _afList[_afIndex] = _afHome;
+            _afRssi[_afIndex] = _afHomeRssi;
+            _afSwitchTime = now - _afStart;
+            _afMuteTime = _afMuted ? now - _afMuteStart : 0;
+            _afLow = 0;
+            _afEnd();
+            return(true);
+        } // if
+        if (_afCheckPI) {
+            // another program, it is tried last from now on.
+            _afRssi[_afIndex] = 0;
+            _afNext();
+        } else if (now - _afTime >= AF_PI_TIME) {
+            _afNext();
+        } // if
+        break;
+
+    case AF_RETURN:
+        if (!pollTune())
+            break;
+        if (_afTried)
+            _afMuteTime = _afMuted ? now - _afMuteStart : 0;
+        _afEnd();
+        break;
+
+    default:
+        break;
+    } // switch
+    return(false);
+} // pollAF()
+
+
+unsigned long RADIO::getAFSwitchTime() { return(_afSwitchTime); }
+unsigned long RADIO::getAFMuteTime()   { return(_afMuteTime); }
+
+
+/// The audio stays muted until _afEnd(), a mute set by the application is kept.
+void RADIO::_afTune(byte n, AF_STATE state) {
+    if (!_afMuted && !_mute) {
+        setMute(true);
+        _afMuted = true;
+        _afMuteStart = millis();
+    } // if
+    _afIndex = n;
+    _afState = state;
+    startFrequency(_afList[n]);
+} // _afTune()
+
+
+/// Try the untried AF with the highest sampled RSSI.
+/// When all AFs are tried go back to the program frequency and wait AF_RETRY_TIME msec before trying again.
+void RADIO::_afNext() {
+    byte best = RADIO_AF_MAX;
+
+    for (byte n = 0; n < _afCount; n++) {
+        if (!bitRead(_afTried, n) && ((best == RADIO_AF_MAX) || (_afRssi[n] > _afRssi[best])))
+            best = n;
+    } // for
+    if (best != RADIO_AF_MAX) {
+        bitSet(_afTried, best);
+        _afTune(best, AF_TUNE);
+    } else {
+        _afLow = 0;
+        _afWait = AF_RETRY_TIME;
+        _afState = AF_RETURN;
+        startFrequency(_afHome);
+    } // if
+} // _afNext()
+
+
+void RADIO::_afEnd() {
+    if (_afMuted) {
+        setMute(false);
+        _afMuted = false;
+    } // if
+    _afState = AF_MONITOR;
+    _afTime = millis();
+} // _afEnd()
+
+
+// ----- switching to traffic announcements of other networks -----
+
+/// Tune to the other network pi on freq, e.g. when RDSEONDecoder reports the start of a traffic announcement there.
+/// The frequency is tuned directly, there is no scan and no RSSI check.
+/// The network is taken when the first RDS group received there carries pi, otherwise the radio goes back.
+/// It stays there while the groups 0A, 0B and 15B of the network have the TA flag set,
+/// the AF follow mode pauses and new AF lists are ignored meanwhile.
+/// Returns false when another switch, a tune, a scan or an AF check is running.
+bool RADIO::startTraffic(RADIO_FREQ freq, uint16_t pi) {
+    if ((_taState != TA_IDLE) || (_tuneState != TUNE_IDLE) || (_scanState != SCAN_IDLE) || (_afState > AF_MONITOR))
+        return(false);
+    if (!pi || (freq < _freqLow) || (freq > _freqHigh) || (freq == _freq))
+        return(false);
+
+    _taPI = pi;
+    _taHome = _freq;
+    _taStart = millis();
+    _taState = TA_TUNE;
+    _resetRDS();
+    startFrequency(freq);
+    return(true);
+} // startTraffic()
+
+
+/// Advance the traffic switch, call this function from the loop.
+bool RADIO::pollTraffic() {
+    unsigned long now = millis();
+
+    switch (_taState) {
+    case TA_TUNE:
+        if (!pollTune())
+            break;
+        if (!getTuneResult()) {
+            _taReturn();
+            break;
+        } // if
+        _taState = TA_CHECK_PI;
+        _taCheckPI = 0;
+        _taTime = now;
+        break;
+
+    case TA_CHECK_PI:
+        checkRDS();
+        if (_taCheckPI == _taPI) {
+            _taState = TA_ANNOUNCE;
+            _taEnd = 0;
+            _taTime = now;
+            _taSwitchTime = now - _taStart;
+            return(true);
+        } // if
+        if (_taCheckPI || (now - _taTime >= TA_PI_TIME))
+            _taReturn();
+        break;
+
+    case TA_ANNOUNCE:
+        if ((_taEnd >= TA_END_GROUPS) || (now - _taTime >= TA_LOST_TIME)) {
+            _taReturn();
+            break;
+        } // if
+        return(true);
+
+    case TA_RETURN:
+        if (pollTune())
+            _taState = TA_IDLE;
+        break;
+
+    default:
+        break;
+    } // switch
+    return(false);
+} // pollTraffic()
+
+
+/// A running switch is given up as well.
+void RADIO::endTraffic() {
+    if ((_taState != TA_IDLE) && (_taState != TA_RETURN))
+        _taReturn();
+} // endTraffic()
+
+
+unsigned long RADIO::getTrafficSwitchTime() { return(_taSwitchTime); }
+
+
+/// The AF list of the program is kept for the return.
+void RADIO::_taReturn() {
+    _taState = TA_RETURN;
+    _resetRDS();
+    startFrequency(_taHome);
+} // _taReturn()
+
+
 /// Return all the Radio settings.
 /// This implementation only knows some values from the last settings.
 bool RADIO::getRadioInfo(RADIO_INFO *info) {
@@ -169,7 +697,7 @@ bool RADIO::getRadioInfo(RADIO_INFO *info) {
 
     // use current settings
     info->mono = _mono;
-
+    return(true);
 } // getRadioInfo()
 
 
@@ -191,10 +719,104 @@ void RADIO::getAudioInfo(AUDIO_INFO *info) {
 
 /// Send a 0.0.0.0 to the RDS receiver if there is any attached.
 /// This is to point out that there is a new situation and all existing data should be invalid from now on.
+/// Buffered data of the old station is discarded, its PI and AF list are forgotten.
 void RADIO::clearRDS() { 
+    _afCount = 0;
+    _afPI = 0;
+    _resetRDS();
+} // clearRDS()
+
+
+void RADIO::_resetRDS() {
+    if (_rdsFilter)
+        _rdsFilter->reset();
+    if (_rdsBuffer)
+        _rdsBuffer->flush();
     if (_sendRDS)
         _sendRDS(0, 0, 0, 0);
-} // clearRDS()
+} // _resetRDS()
+
+
+// ----- interrupt driven operation -----
+
+RADIO *RADIO::_isrRadio = NULL;
+
+
+/// Chips that have no interrupt line keep polling.
+bool RADIO::enableInterrupt(byte) {
+    return(false);
+} // enableInterrupt()
+
+
+void RADIO::disableInterrupt() {
+    _detachInterruptPin();
+} // disableInterrupt()
+
+
+/// The interrupt line of the chips is active low and needs a pull up.
+/// Only one radio can use an interrupt pin at a time.
+bool RADIO::_attachInterruptPin(byte intPin) {
+    int num = digitalPinToInterrupt(intPin);
+    if (num < 0)
+        return(false);
+    _detachInterruptPin();
+    _isrRadio = this;
+    _rdsIntSeen = _tuneIntSeen = _intCount;
+    pinMode(intPin, INPUT_PULLUP);
+    attachInterrupt(num, _isr, FALLING);
+    _intPin = intPin;
+    return(true);
+} // _attachInterruptPin()
+
+
+void RADIO::_detachInterruptPin() {
+    if (_intPin != NO_PIN) {
+        detachInterrupt(digitalPinToInterrupt(_intPin));
+        _intPin = NO_PIN;
+        _isrRadio = NULL;
+    } // if
+} // _detachInterruptPin()
+
+
+/// Only count, the chip is read later outside of the interrupt.
+void RADIO::_isr() {
+    if (_isrRadio)
+        _isrRadio->_intCount++;
+} // _isr()
+
+
+/// Return true when the RDS registers should be read.
+/// Without an interrupt pin the chip is polled every 50 msec,
+/// with an interrupt pin only after an interrupt or INT_FALLBACK msec without one.
+bool RADIO::_rdsDue() {
+    unsigned long now = millis();
+    word interval = 50;
+
+    if (_intPin != NO_PIN) {
+        byte count = _intCount;
+        if (count != _rdsIntSeen) {
+            _rdsIntSeen = count;
+            rdsPollTime = now;
+            return(true);
+        } // if
+        interval = INT_FALLBACK;
+    } // if
+
+    if (now - rdsPollTime < interval)
+        return(false);
+    rdsPollTime = now;
+    return(true);
+} // _rdsDue()
+
+
+/// Prints a register as 4 character hexadecimal code with leading zeros.
+void RADIO::_printHex4(uint16_t val)
+{
+    if (val <= 0x000F) Serial.print('0');
+    if (val <= 0x00FF) Serial.print('0');
+    if (val <= 0x0FFF) Serial.print('0');
+    Serial.print(val, HEX);
+} // _printHex4()
 
 
 // send valid and good data to the RDS processor via newFunction
@@ -204,6 +826,86 @@ void RADIO::attachReceiveRDS(receiveRDSFunction newFunction)
     _sendRDS = newFunction;
 } // attachReceiveRDS()
 
+
+/// Use a buffer between reading the chip and the RDS processor.
+/// checkRDS() then only puts the data into the buffer and processRDS() has to be called from the main loop.
+void RADIO::attachRDSBuffer(RDSBuffer *buffer)
+{
+    _rdsBuffer = buffer;
+} // attachRDSBuffer()
+
+
+/// Check the error levels of the blocks with a filter before the data is buffered or passed on.
+void RADIO::attachRDSFilter(RDSBlockFilter *filter)
+{
+    _rdsFilter = filter;
+} // attachRDSFilter()
+
+
+/// Pass up to maxGroups buffered RDS groups to the RDS processor function.
+/// Returns the number of groups passed.
+byte RADIO::processRDS(byte maxGroups)
+{
+    uint16_t block1, block2, block3, block4;
+    byte count = 0;
+
+    if (!_rdsBuffer)
+        return(0);
+
+    while ((count < maxGroups) && (_rdsBuffer->get(&block1, &block2, &block3, &block4))) {
+        if (_sendRDS)
+            _sendRDS(block1, block2, block3, block4);
+        count++;
+    } // while
+    return(count);
+} // processRDS()
+
+
+/// Called by the chip implementations with new RDS data.
+/// The data is put into the buffer when one is attached, otherwise it is passed on directly.
+void RADIO::_receiveRDS(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4, byte errors)
+{
+    if (_afState > AF_MONITOR) {
+        // the data of an AF is not passed on, only a PI with at most 2 corrected errors is checked.
+        if ((_afState == AF_CHECK_PI) && ((errors & 0xC0) < 0x80))
+            _afCheckPI = block1;
+        return;
+    } // if
+    if ((_taState != TA_IDLE) && (_taState != TA_ANNOUNCE)) {
+        // the same for the other network of a traffic announcement.
+        if ((_taState == TA_CHECK_PI) && ((errors & 0xC0) < 0x80))
+            _taCheckPI = block1;
+        return;
+    } // if
+
+    if (_rdsFilter) {
+        if (!_rdsFilter->filter(&block1, &block2, &block3, &block4, errors))
+            return;
+    } else if (((errors & 0xC0) == 0xC0) || ((errors & 0x30) == 0x30)) {
+        // PI or group type not correctable.
+        return;
+    } // if
+    if (_taState == TA_ANNOUNCE) {
+        // TA flag in bit 4 of the groups 0A, 0B and 15B of the other network.
+        byte groupCode = block2 >> 11;
+        if ((block1 == _taPI) && ((groupCode <= 1) || (groupCode == 31))) {
+            if (block2 & 0x0010) {
+                _taEnd = 0;
+                _taTime = millis();
+            } else {
+                _taEnd++;
+            } // if
+        } // if
+    } else if (_afState == AF_MONITOR) {
+        _afPI = block1;
+    } // if
+
+    if (_rdsBuffer)
+        _rdsBuffer->put(block1, block2, block3, block4);
+    else if (_sendRDS)
+        _sendRDS(block1, block2, block3, block4);
+} // _receiveRDS()
+
 // The End.
 
 
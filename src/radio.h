@@ -27,6 +27,14 @@
 /// * 31.08.2014 Doxygen style comments added.
 /// * 05.02.2015 mainpage content added.
 /// * 29.04.2015 clear RDS function, need to clear RDS info after tuning.
+/// * 17.10.2026 non-blocking tune and seek with completion callback.
+/// * 17.10.2026 full band scan engine with station list.
+/// * 17.10.2026 RDS groups can be buffered and parsed later from the main loop.
+/// * 17.10.2026 interrupt driven RDS and tune complete detection.
+/// * 17.10.2026 AF follow mode switching to alternative frequencies of the program.
+/// * 17.10.2026 RDS groups pass the block error levels of the chip to a filter.
+/// * 17.10.2026 switching to traffic announcements of other networks.
+/// * 17.10.2026 the tuned frequency is passed to an attached AF decoder.
 ///
 /// TODO:
 /// --------
@@ -53,6 +61,9 @@
 
 #include <Arduino.h>
 #include "radiointerface.h"
+#include "RDSBuffer.h"
+#include "RDSBlockFilter.h"
+#include "RDSParser.h"
 
 // The DEBUG_xxx Macros enable Information to the Serial port.
 // They can be enabled by setting the _debugEnabled variable to true disabled by using the debugEnable function.
@@ -89,6 +100,12 @@ extern "C" {
   typedef void(*receiveRDSFunction)(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4);
 }
 
+/// callback function for a completed tune or seek.
+/// freq is the frequency the chip ended on, tuned is false when the seek failed or reached the band limit.
+extern "C" {
+  typedef void(*tuneCompleteFunction)(word freq, bool tuned);
+}
+
 
 // ----- type definitions -----
 
@@ -128,6 +145,20 @@ typedef struct RADIO_INFO {
 };
 
 
+/// A station found by a scan.
+/// Packed into 4 bytes so a list of stations fits into the RAM of small boards.
+typedef struct RADIO_STATION {
+  RADIO_FREQ freq;     ///< Frequency of the station.
+  uint8_t rssi;        ///< Radio Station Strength Information.
+  uint8_t stereo  : 1; ///< Stereo audio is available.
+  uint8_t rdsSync : 1; ///< RDS information is available.
+} RADIO_STATION;
+
+
+/// Maximum number of alternative frequencies used by the AF follow mode.
+#define RADIO_AF_MAX 12
+
+
 /// a structure that contains information about the audio features
 typedef struct AUDIO_INFO {
   uint8_t volume;
@@ -180,6 +211,29 @@ public:
   virtual bool       seekUp(bool toNextSender = true);   ///< Start a seek upwards from the current frequency.
   virtual bool       seekDown(bool toNextSender = true); ///< Start a seek downwards from the current frequency.
 
+  // ----- Non-blocking tune and seek -----
+
+  virtual bool       startFrequency(RADIO_FREQ newF);   ///< Start tuning to a new frequency and return immediately.
+  virtual bool       startSeek(bool seekUp = true);     ///< Start a seek and return immediately.
+  virtual bool       pollTune();                        ///< Advance a running tune or seek, returns true when it is complete.
+  bool               isTuneComplete();                  ///< Return true when no tune or seek is running.
+  bool               getTuneResult();                   ///< Return true when the last tune or seek ended on a station.
+  void               attachTuneComplete(tuneCompleteFunction newFunction); ///< Register a function called when a tune or seek is complete.
+
+  // ----- Scanning the band -----
+
+  bool          startScan(RADIO_STATION *stations, uint8_t maxStations, unsigned long timeBudget,
+                          bool stepped = false, word dwellTime = 100, uint8_t minRssi = 0); ///< Start a scan of the current band.
+  bool          pollScan();                 ///< Advance a running scan, returns true when it is complete.
+  void          abortScan();                ///< Stop a running scan, the stations found so far are kept.
+  uint8_t       scan(RADIO_STATION *stations, uint8_t maxStations, unsigned long timeBudget,
+                     bool stepped = false, word dwellTime = 100, uint8_t minRssi = 0); ///< Scan the band and wait for the result.
+  bool          isScanComplete();           ///< Return true when no scan is running.
+  uint8_t       getScanCount();             ///< Number of stations found by the last scan.
+  unsigned long getScanDuration();          ///< Duration of the last scan in msec.
+
+  void          debugScan();                ///< Scan all frequencies and report the stations to the Serial port.
+
   virtual void       setMono(bool switchOn);   ///< Control the mono mode of the radio chip.
   virtual bool       getMono();                ///< Retrieve the current mono mode setting.
 
@@ -194,6 +248,30 @@ public:
   virtual bool checkRDS()=0; ///< Check if RDS Data is available and good.
   virtual void clearRDS(); ///< Clear RDS data in the attached RDS Receiver by sending 0,0,0,0.
   virtual void attachReceiveRDS(receiveRDSFunction newFunction); ///< Register a RDS processor function.
+  void attachRDSBuffer(RDSBuffer *buffer); ///< Collect the RDS data in a buffer instead of passing it on directly.
+  byte processRDS(byte maxGroups = 0xFF);  ///< Pass buffered RDS data to the RDS processor function.
+  void attachRDSFilter(RDSBlockFilter *filter); ///< Check the block error levels of the RDS data with a filter.
+
+  // ----- Interrupt driven operation -----
+
+  virtual bool enableInterrupt(byte intPin); ///< Read the chip only when it signals new data or a completed tune on intPin.
+  virtual void disableInterrupt();           ///< Go back to polling the chip.
+
+  // ----- Following the alternative frequencies of a program -----
+
+  void          setAFList(const RADIO_FREQ *freqs, byte count); ///< Set the alternative frequencies of the current program.
+  void          setAFFollow(bool switchOn, uint8_t minRssi = 20); ///< Switch to an alternative frequency when the RSSI drops below minRssi.
+  bool          pollAF();           ///< Advance the AF follow mode, returns true when it switched to an alternative frequency.
+  void          attachAFDecoder(RDSAlternativeFrequencyDecoder *decoder); ///< Pass the frequency of every tune to the AF decoder of the RDS parser.
+  unsigned long getAFSwitchTime();  ///< Time in msec from the first weak RSSI to the last switch.
+  unsigned long getAFMuteTime();    ///< Time in msec the audio was muted for the last switch.
+
+  // ----- Switching to traffic announcements of other networks -----
+
+  bool          startTraffic(RADIO_FREQ freq, uint16_t pi); ///< Tune to the other network pi on freq for its traffic announcement.
+  bool          pollTraffic();         ///< Advance the traffic switch, returns true while the radio is on the other network.
+  void          endTraffic();          ///< Go back to the program before the traffic announcement.
+  unsigned long getTrafficSwitchTime(); ///< Time in msec from startTraffic() to the confirmed PI of the other network.
 
   // ----- Utilitys -----
 
@@ -214,6 +292,138 @@ protected:
   RADIO_FREQ _freqSteps=10;  ///< Resolution of the tuner.
 
   receiveRDSFunction _sendRDS; ///< Registered RDS Function that is called on new available data.
+  RDSBuffer *_rdsBuffer = NULL; ///< Buffer for RDS data, NULL to pass the data on directly.
+  RDSBlockFilter *_rdsFilter = NULL; ///< Filter for the RDS data, NULL to drop only groups with an uncorrectable block A or B.
+  RDSAlternativeFrequencyDecoder *_afDecoder = NULL; ///< AF decoder that gets the tuned frequency, or NULL.
+
+  /// Pass RDS data from the chip on, errors are the error levels of the blocks, see RDS_BLER().
+  void _receiveRDS(uint16_t block1, uint16_t block2, uint16_t block3, uint16_t block4, byte errors = 0);
+
+  /// States of a running tune or seek.
+  enum TUNE_STATE {
+    TUNE_IDLE = 0,    ///< No tune or seek is running.
+    TUNE_WAIT_STC,    ///< Waiting for the seek/tune complete flag.
+    TUNE_WAIT_CLEAR   ///< Waiting for the chip to clear the seek/tune complete flag.
+  };
+
+  TUNE_STATE    _tuneState = TUNE_IDLE; ///< State of the running tune or seek.
+  unsigned long _tuneTime;      ///< millis() of the last step of the tune state machine.
+  word          _tuneInterval;  ///< Time in msec until the next poll of the chip.
+  byte          _tunePolls;     ///< Number of polls in the current state.
+  bool          _tuneResult;    ///< Result of the last tune or seek.
+  tuneCompleteFunction _sendTuneComplete = NULL; ///< Registered function called when a tune or seek is complete.
+
+  void _tuneStart(TUNE_STATE state, word interval); ///< Enter a state of the tune state machine.
+  bool _tuneDue();                                  ///< Return true when the next poll of the chip is due.
+  void _tuneDone(bool result);                      ///< Finish the tune or seek and report it.
+  bool _waitTune();                                 ///< Block until the running tune or seek is complete.
+
+  /// States of a running scan.
+  enum SCAN_STATE {
+    SCAN_IDLE = 0,  ///< No scan is running.
+    SCAN_START,     ///< Waiting for the tune to the start of the band.
+    SCAN_TUNING,    ///< Waiting for a tune or seek to complete.
+    SCAN_DWELL      ///< Waiting on a frequency before the station is measured.
+  };
+
+  SCAN_STATE     _scanState = SCAN_IDLE; ///< State of the running scan.
+  RADIO_STATION *_scanStations;  ///< List receiving the found stations.
+  uint8_t        _scanMax;       ///< Capacity of the station list.
+  uint8_t        _scanCount;     ///< Number of stations found.
+  bool           _scanStepped;   ///< Tune every channel instead of seeking.
+  uint8_t        _scanMinRssi;   ///< Minimal RSSI of a station.
+  word           _scanDwell;     ///< Time in msec to stay on a frequency before measuring.
+  unsigned long  _scanStart;     ///< millis() when the scan was started.
+  unsigned long  _scanBudget;    ///< Time in msec the scan may take.
+  unsigned long  _scanDuration;  ///< Duration of the last scan in msec.
+  unsigned long  _scanDwellStart; ///< millis() when the dwell time started.
+  RADIO_FREQ     _scanFreq;      ///< Frequency reached by the last step of the scan.
+
+  bool _scanNext();            ///< Start the tune or seek to the next frequency.
+  void _scanEnd();             ///< Finish the scan.
+
+  static const byte NO_PIN = 0xFF;     ///< No interrupt pin is used.
+  static const word INT_FALLBACK = 1000; ///< Time in msec for reading the chip anyway in case an interrupt got lost.
+  static const word INT_TUNE_FALLBACK = 250; ///< Same for a running tune or seek.
+
+  byte          _intPin = NO_PIN;  ///< Pin connected to the interrupt line of the chip.
+  volatile byte _intCount = 0;     ///< Number of interrupts, only written by the interrupt routine.
+  byte          _rdsIntSeen;       ///< _intCount when the RDS data was read the last time.
+  byte          _tuneIntSeen;      ///< _intCount when the tune state was read the last time.
+
+  bool _attachInterruptPin(byte intPin); ///< Start counting the interrupts on intPin.
+  void _detachInterruptPin();            ///< Stop using the interrupt pin.
+  bool _rdsDue();                        ///< Return true when the RDS data of the chip should be read.
+
+  static RADIO *_isrRadio;  ///< The radio using the interrupt routine.
+  static void _isr();       ///< Interrupt routine for the interrupt line of the chip.
+
+  /// States of the AF follow mode.
+  enum AF_STATE {
+    AF_OFF = 0,    ///< AF follow mode is off.
+    AF_MONITOR,    ///< Checking the RSSI of the tuned frequency.
+    AF_SAMPLE,     ///< Tuning to an AF to sample its RSSI.
+    AF_TUNE,       ///< Tuning to an AF to switch to it.
+    AF_CHECK_PI,   ///< Waiting for the PI on the AF.
+    AF_RETURN      ///< Tuning back to the frequency of the program.
+  };
+
+  static const word AF_CHECK_TIME = 200;   ///< Time in msec between RSSI checks of the tuned frequency.
+  static const byte AF_LOW_CHECKS = 2;     ///< Number of weak RSSI checks in a row that start a switch.
+  static const byte AF_SAMPLE_MARGIN = 10; ///< The AFs are sampled while the RSSI is less than this above minRssi.
+  static const word AF_SAMPLE_TIME = 3000; ///< Time in msec between two AF samples.
+  static const word AF_PI_TIME = 500;      ///< Time in msec to wait for the PI on an AF.
+  static const word AF_RETRY_TIME = 5000;  ///< Time in msec before a failed switch is tried again.
+
+  AF_STATE      _afState = AF_OFF;      ///< State of the AF follow mode.
+  RADIO_FREQ    _afList[RADIO_AF_MAX];  ///< Alternative frequencies of the program.
+  uint8_t       _afRssi[RADIO_AF_MAX];  ///< Last sampled RSSI of the alternative frequencies, 0 = not sampled or another program.
+  byte          _afCount = 0;   ///< Number of alternative frequencies.
+  byte          _afIndex;       ///< AF that is sampled or tried.
+  uint16_t      _afTried;       ///< Bitmap of the AFs tried by the running switch.
+  uint8_t       _afMinRssi;     ///< RSSI below that the program is switched.
+  uint8_t       _afHomeRssi;    ///< Last RSSI of the tuned frequency.
+  byte          _afLow;         ///< Number of weak RSSI checks in a row.
+  word          _afWait;        ///< Time in msec until the next RSSI check.
+  uint16_t      _afPI = 0;      ///< PI of the program.
+  uint16_t      _afCheckPI;     ///< PI received on the AF, 0 = none.
+  RADIO_FREQ    _afHome;        ///< Frequency of the program before tuning to an AF.
+  bool          _afMuted;       ///< The audio is muted by the AF follow mode.
+  unsigned long _afTime;        ///< millis() of the last RSSI check or of the start of the PI check.
+  unsigned long _afSampleTime;  ///< millis() of the last AF sample.
+  unsigned long _afStart;       ///< millis() of the first weak RSSI check.
+  unsigned long _afMuteStart;   ///< millis() when the audio was muted.
+  unsigned long _afSwitchTime = 0; ///< Duration of the last switch.
+  unsigned long _afMuteTime = 0;   ///< Mute time of the last switch.
+
+  void _afTune(byte n, AF_STATE state); ///< Mute and start tuning to AF n.
+  void _afNext();                       ///< Try the untried AF with the best RSSI or go back.
+  void _afEnd();                        ///< Unmute and continue monitoring.
+
+  /// States of the traffic switch.
+  enum TA_STATE {
+    TA_IDLE = 0,   ///< On the program.
+    TA_TUNE,       ///< Tuning to the other network.
+    TA_CHECK_PI,   ///< Waiting for the PI of the other network.
+    TA_ANNOUNCE,   ///< On the other network during its traffic announcement.
+    TA_RETURN      ///< Tuning back to the program.
+  };
+
+  static const word TA_PI_TIME = 1000;  ///< Time in msec to wait for the PI of the other network.
+  static const word TA_LOST_TIME = 3000; ///< Time in msec without a group with TA set that ends the announcement.
+  static const byte TA_END_GROUPS = 2;  ///< Number of groups with TA cleared in a row that end the announcement.
+
+  TA_STATE      _taState = TA_IDLE;  ///< State of the traffic switch.
+  uint16_t      _taPI;          ///< PI of the other network.
+  uint16_t      _taCheckPI;     ///< PI received on the other network, 0 = none.
+  RADIO_FREQ    _taHome;        ///< Frequency of the program.
+  byte          _taEnd;         ///< Number of groups with TA cleared in a row.
+  unsigned long _taTime;        ///< millis() of the start of the PI check or of the last group with TA set.
+  unsigned long _taStart;       ///< millis() of startTraffic().
+  unsigned long _taSwitchTime = 0; ///< Duration of the last switch.
+
+  void _taReturn();   ///< Start tuning back to the program.
+  void _resetRDS();   ///< Discard the RDS data of the old frequency and reset the RDS receiver.
 
   void _printHex4(uint16_t val); ///> Prints a register as 4 character hexadecimal code with leading zeros.
   RadioInterface* _pRadio;
@@ -0,0 +1,128 @@
+/// \file radiointerface.cpp
+/// \brief Implementation of the bus transactions for the radio chip interfaces.
+///
+/// \details
+/// The RadioInterface is implemented by the sketches for the bus they use.
+/// Only the batching of operations is shared and implemented here.
+
+#include "radiointerface.h"
+
+
+/// Run the queued operations one by one.
+/// A write that is followed by a read from the same address is executed with a repeated start by sendReceive().
+bool RadioInterface::transfer(RadioTransaction& transaction)
+{
+    for (byte i=0;i<transaction.count();i++)
+    {
+        RadioTransaction::OPERATION& op=transaction.operation(i);
+        if(op.read)
+        {
+            if(!receive(op.address, op.data, op.length))
+            {
+                return false;
+            }
+            continue;
+        }
+        if(i+1<transaction.count())
+        {
+            RadioTransaction::OPERATION& next=transaction.operation(i+1);
+            if(next.read && next.address==op.address)
+            {
+                if(!sendReceive(op.address, op.data, op.length, next.data, next.length))
+                {
+                    return false;
+                }
+                i++;
+                continue;
+            }
+        }
+        if(!send(op.address, op.data, op.length))
+        {
+            return false;
+        }
+    }
+    return true;
+} // transfer()
+
+
+RadioTransaction::RadioTransaction(RadioInterface* pRadio):
+    _pRadio(pRadio)
+{
+    clear();
+} // RadioTransaction()
+
+
+void RadioTransaction::clear()
+{
+    _count=0;
+    _dataLength=0;
+    _ok=true;
+} // clear()
+
+
+/// Make room for a new operation and length bytes of write data.
+/// The queued operations are flushed when the capacity is exhausted.
+bool RadioTransaction::_reserve(byte length)
+{
+    if(length>MAX_DATA)
+    {
+        return false;
+    }
+    if(_count==MAX_OPERATIONS || _dataLength+length>MAX_DATA)
+    {
+        bool ok=_ok && _pRadio->transfer(*this);
+        clear();
+        _ok=ok;
+    }
+    return true;
+} // _reserve()
+
+
+bool RadioTransaction::send(byte address, byte* data, byte length)
+{
+    if(!_reserve(length))
+    {
+        _ok=false;
+        return false;
+    }
+    OPERATION& op=_operations[_count++];
+    op.address=address;
+    op.read=false;
+    op.length=length;
+    op.data=&_data[_dataLength];
+    memcpy(op.data, data, length);
+    _dataLength+=length;
+    return true;
+} // send()
+
+
+bool RadioTransaction::receive(byte address, byte* data, byte length)
+{
+    if(!_reserve(0))
+    {
+        _ok=false;
+        return false;
+    }
+    OPERATION& op=_operations[_count++];
+    op.address=address;
+    op.read=true;
+    op.length=length;
+    op.data=data;
+    return true;
+} // receive()
+
+
+/// Submit all queued operations to the interface.
+/// Returns false when any of the operations since the last flush() failed.
+bool RadioTransaction::flush()
+{
+    bool ok=_ok;
+    if(_count)
+    {
+        ok=_pRadio->transfer(*this) && ok;
+    }
+    clear();
+    return ok;
+} // flush()
+
+// End.
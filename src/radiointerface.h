@@ -2,6 +2,29 @@
 
 #include "Arduino.h"
 
+// Uncomment to attribute the bus traffic of the drivers to their operations, see RadioInterfaceStats.
+// When not defined the RADIO_BUS_OPERATION() markers in the drivers compile to nothing.
+// The counters of a RadioInterfaceStats take about 510 bytes of RAM on AVR, too much for an ATmega328 with RDS.
+//#define RADIO_BUS_STATS
+
+class RadioTransaction;
+
+/// Operations of the radio drivers the bus traffic is attributed to.
+enum RADIO_OPERATION {
+    RADIO_OP_OTHER = 0,     ///< Not marked by the driver.
+    RADIO_OP_INIT,          ///< init()
+    RADIO_OP_SETTINGS,      ///< Audio and band settings like setVolume() or setBand().
+    RADIO_OP_SET_FREQUENCY, ///< setFrequency() and startFrequency()
+    RADIO_OP_SEEK,          ///< seekUp(), seekDown() and startSeek()
+    RADIO_OP_POLL_TUNE,     ///< pollTune()
+    RADIO_OP_GET_FREQUENCY, ///< getFrequency()
+    RADIO_OP_GET_INFO,      ///< getRadioInfo() and getAudioInfo()
+    RADIO_OP_CHECK_RDS,     ///< checkRDS()
+    RADIO_OP_DEBUG,         ///< debug functions
+    RADIO_OP_AF,            ///< pollAF() including its tunes and RDS checks
+    RADIO_OP_MAX
+};
+
 class RadioInterface
 {
 public:
@@ -10,4 +33,74 @@ public:
     virtual bool send(byte address, byte* data, byte length)=0;
     virtual bool sendReceive(byte address, byte* wData, byte wLength, byte* rData, byte rLength)=0;
     virtual bool receive(byte address, byte* data, byte length)=0;
+
+    /// Execute all queued operations of a transaction.
+    /// This implementation runs them one by one, a write followed by a read from the same address is executed by sendReceive().
+    /// Backends that support combined transfers should override this and execute the transaction as one bus operation.
+    virtual bool transfer(RadioTransaction& transaction);
+
+    byte operation = RADIO_OP_OTHER; ///< Driver operation causing the current bus traffic, see RADIO_BUS_OPERATION().
+};
+
+
+#ifdef RADIO_BUS_STATS
+/// Marks the bus traffic of a driver function with an operation until the function returns.
+/// Nested functions keep the operation of the outermost marked function.
+class RadioBusOperation
+{
+public:
+    RadioBusOperation(RadioInterface* pRadio, byte op): _pRadio(pRadio), _previous(pRadio->operation)
+    {
+        if(_previous==RADIO_OP_OTHER)
+        {
+            _pRadio->operation=op;
+        }
+    }
+    ~RadioBusOperation() { _pRadio->operation=_previous; }
+private:
+    RadioInterface* _pRadio;
+    byte _previous;
+};
+#define RADIO_BUS_OPERATION(op) RadioBusOperation _busOperation(_pRadio, op)
+#else
+#define RADIO_BUS_OPERATION(op)
+#endif
+
+
+/// A batch of bus operations that is submitted to a RadioInterface with one flush().
+/// Written data is copied into the transaction, read data is stored into the buffers of the caller when flush() returns.
+/// When the capacity is exhausted the queued operations are flushed automatically.
+class RadioTransaction
+{
+public:
+    static const byte MAX_OPERATIONS = 8;   ///< max. number of queued operations.
+    static const byte MAX_DATA = 32;        ///< max. number of queued bytes to write.
+
+    /// A single queued bus operation.
+    typedef struct {
+        byte address;   ///< I2C address of the device.
+        bool read;      ///< true for a read, false for a write.
+        byte length;    ///< number of bytes to transfer.
+        byte* data;     ///< data to write or buffer for the data to read.
+    } OPERATION;
+
+    RadioTransaction(RadioInterface* pRadio);
+
+    bool send(byte address, byte* data, byte length);    ///< Queue a write.
+    bool receive(byte address, byte* data, byte length); ///< Queue a read, data must stay valid until flush().
+    bool flush();                                        ///< Submit all queued operations.
+    void clear();                                        ///< Drop all queued operations.
+
+    byte count() { return _count; }                      ///< Number of queued operations.
+    OPERATION& operation(byte n) { return _operations[n]; } ///< Access a queued operation.
+
+private:
+    bool _reserve(byte length);
+
+    RadioInterface* _pRadio;
+    OPERATION _operations[MAX_OPERATIONS];
+    byte _data[MAX_DATA];
+    byte _count;
+    byte _dataLength;
+    bool _ok;
 };
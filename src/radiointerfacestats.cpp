@@ -0,0 +1,187 @@
+/// \file radiointerfacestats.cpp
+/// \brief RadioInterface decorator that collects statistics of the bus traffic.
+///
+/// \details
+/// See radiointerfacestats.h.
+
+#include "radiointerfacestats.h"
+
+
+RadioInterfaceStats::RadioInterfaceStats(RadioInterface* pRadio):
+    _pRadio(pRadio)
+{
+    reset();
+} // RadioInterfaceStats()
+
+
+void RadioInterfaceStats::init()
+{
+    _pRadio->init();
+} // init()
+
+
+bool RadioInterfaceStats::isDetected(byte address)
+{
+    unsigned long start=micros();
+    bool ok=_pRadio->isDetected(address);
+    _count(address, 0, 0, ok, start);
+    return ok;
+} // isDetected()
+
+
+bool RadioInterfaceStats::send(byte address, byte* data, byte length)
+{
+    unsigned long start=micros();
+    bool ok=_pRadio->send(address, data, length);
+    _count(address, length, 0, ok, start);
+    return ok;
+} // send()
+
+
+bool RadioInterfaceStats::sendReceive(byte address, byte* wData, byte wLength, byte* rData, byte rLength)
+{
+    unsigned long start=micros();
+    bool ok=_pRadio->sendReceive(address, wData, wLength, rData, rLength);
+    _count(address, wLength, rLength, ok, start);
+    return ok;
+} // sendReceive()
+
+
+bool RadioInterfaceStats::receive(byte address, byte* data, byte length)
+{
+    unsigned long start=micros();
+    bool ok=_pRadio->receive(address, data, length);
+    _count(address, 0, length, ok, start);
+    return ok;
+} // receive()
+
+
+/// The transaction is passed on as a whole, so combined transfers of the backend are kept.
+/// It is counted as one call for the address of its first operation.
+bool RadioInterfaceStats::transfer(RadioTransaction& transaction)
+{
+    byte written=0;
+    byte read=0;
+    for (byte i=0;i<transaction.count();i++)
+    {
+        RadioTransaction::OPERATION& op=transaction.operation(i);
+        if(op.read)
+        {
+            read+=op.length;
+        }
+        else
+        {
+            written+=op.length;
+        }
+    }
+    unsigned long start=micros();
+    bool ok=_pRadio->transfer(transaction);
+    _count(transaction.count() ? transaction.operation(0).address : 0, written, read, ok, start);
+    return ok;
+} // transfer()
+
+
+void RadioInterfaceStats::_count(byte address, byte written, byte read, bool ok, unsigned long start)
+{
+    unsigned long duration=micros()-start;
+    byte n=0;
+    while (n<MAX_ADDRESSES-1 && _stats.address[n] && _stats.address[n]!=address)
+    {
+        n++;
+    }
+    _stats.address[n]=address;
+    _add(&_stats.byAddress[n], written, read, ok, duration);
+    _add(&_stats.byOperation[operation<RADIO_OP_MAX ? operation : (byte)RADIO_OP_OTHER], written, read, ok, duration);
+} // _count()
+
+
+void RadioInterfaceStats::_add(RADIO_BUS_COUNTERS* c, byte written, byte read, bool ok, unsigned long duration)
+{
+    byte bucket=0;
+    unsigned long limit=128;
+    while (bucket<7 && duration>=limit)
+    {
+        bucket++;
+        limit<<=1;
+    }
+    c->transactions++;
+    c->bytesWritten+=written;
+    c->bytesRead+=read;
+    c->micros+=duration;
+    if(!ok)
+    {
+        c->failures++;
+    }
+    if(c->histogram[bucket]<0xFFFF)
+    {
+        c->histogram[bucket]++;
+    }
+} // _add()
+
+
+void RadioInterfaceStats::snapshot(RADIO_BUS_STATISTICS* stats)
+{
+    memcpy(stats, &_stats, sizeof(_stats));
+} // snapshot()
+
+
+void RadioInterfaceStats::reset()
+{
+    memset(&_stats, 0, sizeof(_stats));
+} // reset()
+
+
+const char* RadioInterfaceStats::operationName(byte op)
+{
+    static const char* const names[RADIO_OP_MAX]={
+        "other", "init", "settings", "setFrequency", "seek", "pollTune",
+        "getFrequency", "getInfo", "checkRDS", "debug", "af"
+    };
+    return op<RADIO_OP_MAX ? names[op] : "?";
+} // operationName()
+
+
+/// Print one line per address and per operation with traffic:
+/// label n=calls w=bytes written r=bytes read f=failures us=total usec h=histogram buckets.
+void RadioInterfaceStats::dump()
+{
+    char label[8];
+    for (byte n=0;n<MAX_ADDRESSES;n++)
+    {
+        if(_stats.byAddress[n].transactions)
+        {
+            sprintf(label, "@0x%02X", _stats.address[n]);
+            _print(label, &_stats.byAddress[n]);
+        }
+    }
+    for (byte op=0;op<RADIO_OP_MAX;op++)
+    {
+        if(_stats.byOperation[op].transactions)
+        {
+            _print(operationName(op), &_stats.byOperation[op]);
+        }
+    }
+} // dump()
+
+
+void RadioInterfaceStats::_print(const char* label, RADIO_BUS_COUNTERS* c)
+{
+    Serial.print(label);
+    Serial.print(" n=");  Serial.print(c->transactions);
+    Serial.print(" w=");  Serial.print(c->bytesWritten);
+    Serial.print(" r=");  Serial.print(c->bytesRead);
+    Serial.print(" f=");  Serial.print(c->failures);
+    Serial.print(" us="); Serial.print(c->micros);
+    Serial.print(" h=");
+    for (byte b=0;b<8;b++)
+    {
+        if(b)
+        {
+            Serial.print(',');
+        }
+        Serial.print(c->histogram[b]);
+    }
+    Serial.println();
+} // _print()
+
+// End.
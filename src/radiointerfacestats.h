@@ -0,0 +1,66 @@
+///
+/// \file radiointerfacestats.h
+/// \brief RadioInterface decorator that collects statistics of the bus traffic.
+///
+/// \details
+/// Put a RadioInterfaceStats between the driver and the bus interface:
+///   RadioInterfaceI2c radi2c;
+///   RadioInterfaceStats stats(&radi2c);
+///   SI4703 radio(&stats, resetPin, sdioPin);
+///
+/// All calls are counted per device address and per driver operation.
+/// The operations are only known when RADIO_BUS_STATS is defined in radiointerface.h,
+/// otherwise all traffic is counted as RADIO_OP_OTHER.
+/// The counters take 507 bytes of RAM on AVR, 36 bytes for each of the 3 addresses and the 11 operations.
+
+#pragma once
+
+#include "radiointerface.h"
+
+/// Counters of the bus traffic.
+typedef struct RADIO_BUS_COUNTERS {
+    unsigned long transactions; ///< Number of bus calls.
+    unsigned long bytesWritten; ///< Bytes sent to the device.
+    unsigned long bytesRead;    ///< Bytes received from the device.
+    unsigned long failures;     ///< Calls that failed, e.g. by a NACK.
+    unsigned long micros;       ///< Total time of the calls in usec.
+    word histogram[8];          ///< Calls by latency: <128us, <256us, <512us, <1ms, <2ms, <4ms, <8ms, >=8ms.
+} RADIO_BUS_COUNTERS;
+
+
+/// A copy of all counters.
+typedef struct RADIO_BUS_STATISTICS {
+    byte address[3];                             ///< Device addresses seen, 0 = unused.
+    RADIO_BUS_COUNTERS byAddress[3];             ///< Counters by device address.
+    RADIO_BUS_COUNTERS byOperation[RADIO_OP_MAX]; ///< Counters by driver operation.
+} RADIO_BUS_STATISTICS;
+
+
+class RadioInterfaceStats : public RadioInterface
+{
+public:
+    static const byte MAX_ADDRESSES = 3; ///< Traffic of more devices is counted for the last address.
+
+    RadioInterfaceStats(RadioInterface* pRadio);
+
+    void init();
+    bool isDetected(byte address);
+    bool send(byte address, byte* data, byte length);
+    bool sendReceive(byte address, byte* wData, byte wLength, byte* rData, byte rLength);
+    bool receive(byte address, byte* data, byte length);
+    bool transfer(RadioTransaction& transaction);
+
+    void snapshot(RADIO_BUS_STATISTICS* stats); ///< Copy all counters.
+    void reset();                               ///< Clear all counters.
+    void dump();                                ///< Print the counters in a compact format to the Serial port.
+
+    static const char* operationName(byte op);  ///< Name of a driver operation.
+
+private:
+    void _count(byte address, byte written, byte read, bool ok, unsigned long start);
+    void _add(RADIO_BUS_COUNTERS* c, byte written, byte read, bool ok, unsigned long duration);
+    void _print(const char* label, RADIO_BUS_COUNTERS* c);
+
+    RadioInterface* _pRadio;
+    RADIO_BUS_STATISTICS _stats;
+};